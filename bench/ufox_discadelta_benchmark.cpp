@@ -0,0 +1,225 @@
+// Headless Discadelta batch benchmark: fills DiscadeltaBatch instances with random problems,
+// solves each with the vector kernel of the build and with the scalar reference, and reports
+// the throughput of both. The two results must be bit-identical, the exit code fails otherwise.
+// Results are written as JSON.
+//
+//   UFoxDiscadeltaBenchmark [--iterations N] [--warmup N] [--filter NAME] [--out FILE]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+import ufox_lib;
+import ufox_geometry;
+
+namespace {
+    using namespace ufox;
+    using namespace ufox::geometry;
+
+    enum class ProblemMode { eCompress, eExpand, eMixed };
+
+    struct BenchScenario {
+        std::string_view    name{};
+        uint32_t            problemCount{0};
+        uint32_t            segmentCount{0};
+        ProblemMode         mode{ProblemMode::eMixed};
+        bool                degenerate{false};  // zero and negative inputs on a part of the segments
+    };
+
+    constexpr BenchScenario SCENARIOS[] = {
+        {"p64k_s5_mixed",               65536, 5,  ProblemMode::eMixed,    false},
+        {"p64k_s5_compress",            65536, 5,  ProblemMode::eCompress, false},
+        {"p64k_s5_expand",              65536, 5,  ProblemMode::eExpand,   false},
+        {"p16k_s32_mixed_degenerate",   16384, 32, ProblemMode::eMixed,    true},
+        {"p4k_s64_mixed_degenerate",    4096,  64, ProblemMode::eMixed,    true},
+        {"p1003_s7_mixed_degenerate",   1003,  7,  ProblemMode::eMixed,    true},
+    };
+
+    constexpr std::string_view ToString(const ProblemMode mode) noexcept {
+        switch (mode) {
+            case ProblemMode::eCompress: return "compress";
+            case ProblemMode::eExpand:   return "expand";
+            default:                     return "mixed";
+        }
+    }
+
+    struct BenchOptions {
+        uint32_t            iterations{50};
+        uint32_t            warmup{5};
+        std::string         filter{};
+        std::string         outPath{};
+    };
+
+    float MakeValue(std::mt19937& rng, const bool degenerate, const float low, const float high) {
+        if (degenerate) {
+            switch (std::uniform_int_distribution(0, 7)(rng)) {
+                case 0:  return 0.0f;
+                case 1:  return -std::uniform_real_distribution(low, high)(rng);
+                default: break;
+            }
+        }
+        return std::uniform_real_distribution(low, high)(rng);
+    }
+
+    void FillBatch(DiscadeltaBatch& batch, const BenchScenario& scenario) {
+        std::mt19937 rng{0xD15Cu + scenario.segmentCount};
+        batch.resize(scenario.problemCount, scenario.segmentCount);
+
+        for (size_t q = 0; q < batch.problemCount; ++q) {
+            float accumulateBase = 0.0f;
+
+            for (size_t r = 0; r < batch.segmentCount; ++r) {
+                const size_t i = batch.at(r, q);
+                batch.bases[i] = MakeValue(rng, scenario.degenerate, 10.0f, 200.0f);
+                batch.compressRatios[i] = MakeValue(rng, scenario.degenerate, 0.0f, 1.0f);
+                batch.expandRatios[i] = MakeValue(rng, scenario.degenerate, 0.0f, 2.0f);
+                batch.mins[i] = MakeValue(rng, scenario.degenerate, 0.0f, 40.0f);
+                batch.maxs[i] = MakeValue(rng, scenario.degenerate, 100.0f, 400.0f);
+                accumulateBase += std::max(0.0f, batch.bases[i]);
+            }
+
+            const bool compress = scenario.mode == ProblemMode::eCompress
+                || (scenario.mode == ProblemMode::eMixed && std::uniform_int_distribution(0, 1)(rng) == 0);
+            batch.inputDistances[q] = compress
+                ? accumulateBase * std::uniform_real_distribution(0.1f, 0.95f)(rng)
+                : accumulateBase * std::uniform_real_distribution(1.05f, 3.0f)(rng);
+        }
+    }
+
+    struct SolveSamples {
+        std::vector<uint64_t>   nanoseconds{};
+    };
+
+    template<typename Pass>
+    void TimePass(SolveSamples& samples, const bool record, Pass pass) {
+        const auto start = std::chrono::steady_clock::now();
+        pass();
+        const auto end = std::chrono::steady_clock::now();
+        if (!record) return;
+
+        samples.nanoseconds.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+    }
+
+    std::string FormatSolve(const std::string_view name, SolveSamples& samples, const uint32_t problemCount) {
+        std::vector<uint64_t>& ns = samples.nanoseconds;
+        std::ranges::sort(ns);
+
+        const auto percentile = [&ns](const double p) {
+            const auto rank = static_cast<size_t>(p * static_cast<double>(ns.size() - 1) + 0.5);
+            return ns[std::min(rank, ns.size() - 1)];
+        };
+
+        const uint64_t p50 = percentile(0.50);
+
+        return std::format(
+            R"(        "{}": {{"p50_ns": {}, "p99_ns": {}, "min_ns": {}, "problems_per_ms": {:.1f}}})",
+            name, p50, percentile(0.99), ns.front(),
+            static_cast<double>(problemCount) * 1.0e6 / static_cast<double>(std::max<uint64_t>(1, p50)));
+    }
+
+    // Counts the results whose bits differ, -0.0f against 0.0f and NaN payloads included.
+    size_t CountMismatches(const std::vector<float>& a, const std::vector<float>& b) {
+        size_t mismatches = 0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            mismatches += std::memcmp(&a[i], &b[i], sizeof(float)) != 0 ? 1 : 0;
+        }
+        return mismatches;
+    }
+
+    std::string RunScenario(const BenchScenario& scenario, const BenchOptions& options, bool& identical) {
+        DiscadeltaBatch vector{};
+        DiscadeltaBatch scalar{};
+        FillBatch(vector, scenario);
+        FillBatch(scalar, scenario);
+
+        SolveSamples vectorSamples{};
+        SolveSamples scalarSamples{};
+        vectorSamples.nanoseconds.reserve(options.iterations);
+        scalarSamples.nanoseconds.reserve(options.iterations);
+
+        for (uint32_t pass = 0; pass < options.warmup + options.iterations; ++pass) {
+            const bool record = pass >= options.warmup;
+            TimePass(vectorSamples, record, [&vector] { SolveDiscadeltaBatch(vector); });
+            TimePass(scalarSamples, record, [&scalar] { SolveDiscadeltaBatch(scalar, true); });
+        }
+
+        const size_t mismatches = CountMismatches(vector.distances, scalar.distances);
+        identical = mismatches == 0;
+
+        const double speedup = static_cast<double>(std::ranges::min(scalarSamples.nanoseconds))
+            / static_cast<double>(std::max<uint64_t>(1, std::ranges::min(vectorSamples.nanoseconds)));
+
+        return std::format(
+            "    {{\n"
+            R"(      "name": "{}", "problems": {}, "segments": {}, "mode": "{}", "degenerate": {},)" "\n"
+            R"(      "mismatches": {}, "bit_identical": {}, "min_speedup": {:.2f},)" "\n"
+            "      \"solves\": {{\n{},\n{}\n      }}\n"
+            "    }}",
+            scenario.name, scenario.problemCount, scenario.segmentCount, ToString(scenario.mode),
+            scenario.degenerate ? "true" : "false", mismatches, identical ? "true" : "false", speedup,
+            FormatSolve(DISCADELTA_BATCH_KERNEL, vectorSamples, scenario.problemCount),
+            FormatSolve("scalar_reference", scalarSamples, scenario.problemCount));
+    }
+
+    bool ParseOptions(const int argc, char** argv, BenchOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (arg == "--iterations" && hasValue) options.iterations = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (arg == "--warmup" && hasValue) options.warmup = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+            else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+            else if (arg == "--out" && hasValue) options.outPath = argv[++i];
+            else {
+                std::cerr << "usage: " << argv[0] << " [--iterations N] [--warmup N] [--filter NAME] [--out FILE]" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(const int argc, char** argv) {
+    BenchOptions options{};
+    if (!ParseOptions(argc, argv, options)) return EXIT_FAILURE;
+
+    std::string json = std::format("{{\n  \"benchmark\": \"ufox_discadelta\",\n  \"kernel\": \"{}\",\n  \"lanes\": {},\n  \"iterations\": {},\n  \"warmup\": {},\n  \"scenarios\": [\n",
+        DISCADELTA_BATCH_KERNEL, DISCADELTA_BATCH_LANES, options.iterations, options.warmup);
+
+    bool allIdentical = true;
+
+    bool first = true;
+    for (const BenchScenario& scenario : SCENARIOS) {
+        if (!options.filter.empty() && scenario.name.find(options.filter) == std::string_view::npos) continue;
+
+        bool identical = true;
+        if (!first) json += ",\n";
+        json += RunScenario(scenario, options, identical);
+        allIdentical = allIdentical && identical;
+        first = false;
+    }
+
+    json += "\n  ]\n}\n";
+
+    if (options.outPath.empty()) {
+        std::cout << json;
+        return allIdentical ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::ofstream out(options.outPath);
+    if (!out) {
+        std::cerr << "cannot write " << options.outPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    out << json;
+    return allIdentical ? EXIT_SUCCESS : EXIT_FAILURE;
+}
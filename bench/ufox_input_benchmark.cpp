@@ -0,0 +1,326 @@
+// Headless input replay benchmark: feeds a recorded or generated input trace through the
+// InputResource event queue, the callback pools, ViewportPollEvent, ResizingViewport and the GUI
+// rect batch of a synthetic Viewpanel tree, without a window or GPU. The input clock only moves
+// with the trace, so every replay runs the same. An event's latency is the trace time it waited
+// for its frame plus the measured time the frame took to process. Results are written as JSON.
+//
+//   UFoxInputBenchmark [--trace FILE] [--record FILE] [--frames N] [--panels N] [--seed N] [--out FILE]
+//
+// Without --trace a trace is generated from --seed, --record writes it for later replays. Record
+// a live session with UFOX_RECORD_INPUT=<file> set on the engine.
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+import ufox_lib;
+import ufox_input;
+import ufox_geometry;
+import ufox_gui_batch;
+
+namespace {
+    using namespace ufox;
+    using namespace ufox::geometry;
+
+    constexpr auto FRAME_INTERVAL = std::chrono::microseconds{16667};
+    constexpr uint32_t MOTION_EVENTS_PER_FRAME = 16;    // a 1000 Hz mouse at 60 Hz
+    constexpr uint32_t CLICK_INTERVAL_FRAMES = 45;
+    constexpr uint32_t RESIZE_INTERVAL_FRAMES = 120;
+    constexpr uint32_t RESIZE_STEPS = 12;               // frames of one resize drag
+    constexpr int RESIZE_STEP_PIXELS = 8;
+    constexpr size_t LATENCY_BUCKET_COUNT = 40;         // log2 nanosecond buckets
+
+    struct BenchOptions {
+        std::string     tracePath{};
+        std::string     recordPath{};
+        uint32_t        frames{3600};
+        uint32_t        panelCount{512};
+        uint64_t        seed{1};
+        std::string     outPath{};
+    };
+
+    struct LatencyHistogram {
+        std::vector<uint64_t>                       nanoseconds{};
+        std::array<uint64_t, LATENCY_BUCKET_COUNT>  buckets{};
+
+        void add(const uint64_t ns) {
+            nanoseconds.push_back(ns);
+            ++buckets[std::min<size_t>(std::bit_width(ns), LATENCY_BUCKET_COUNT - 1)];
+        }
+    };
+
+    struct ReplayResult {
+        LatencyHistogram    motion{};
+        LatencyHistogram    button{};
+        LatencyHistogram    wheel{};
+        LatencyHistogram    resize{};
+        LatencyHistogram    frame{};            // processing time of every frame
+        uint64_t            frames{0};
+        uint64_t            droppedEvents{0};
+        uint64_t            signature{0};       // folds the hovered panel, cursor and rects of every frame
+    };
+
+    // Viewpanels alternate rows and columns, every one flexes to fill its parent.
+    struct ReplayScene {
+        explicit ReplayScene(const uint32_t panelCount) {
+            storage.reserve(panelCount);
+            storage.push_back(std::make_unique<Viewpanel>(PanelAlignment::eRow, PickingMode::eIgnore));
+            std::vector<uint32_t> depths{0};
+
+            for (uint32_t i = 1; i < panelCount; ++i) {
+                const uint32_t parent = (i - 1) / 4;
+                depths.push_back(depths[parent] + 1);
+                storage.push_back(std::make_unique<Viewpanel>(depths.back() % 2 == 0 ? PanelAlignment::eRow : PanelAlignment::eColumn));
+                storage.back()->resizerValue = 0.5f;
+                storage[parent]->add(storage.back().get());
+            }
+
+            viewport.panel = storage.front().get();
+            input.clock = input::MakeManualInputClock(now);
+            BindEvents(viewport, input, cursor);
+        }
+
+        ~ReplayScene() { UnbindEvents(viewport, input); }
+
+        ReplayScene(const ReplayScene&) = delete;
+        ReplayScene& operator=(const ReplayScene&) = delete;
+
+        std::chrono::steady_clock::time_point       now{};
+        std::vector<std::unique_ptr<Viewpanel>>     storage{};
+        input::InputResource                        input{};
+        input::StandardCursorResource               cursor{};
+        Viewport                                    viewport{};
+        gui::RectBatch                              batch{};
+    };
+
+    uint64_t NowNanoseconds() noexcept {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    constexpr uint64_t MixSignature(const uint64_t seed, const uint64_t value) noexcept {
+        return (seed ^ value) * 0x100000001B3ull;
+    }
+
+    // Records through the same producer calls as the engine, under a manual clock.
+    input::InputTrace GenerateTrace(const BenchOptions& options) {
+        std::mt19937_64 rng(options.seed);
+        std::chrono::steady_clock::time_point now{};
+
+        input::InputResource recorder{};
+        input::InputTrace trace{};
+        recorder.clock = input::MakeManualInputClock(now);
+        recorder.recording = &trace;
+
+        int width = 1280, height = 720;
+        input::RecordResize(recorder, width, height);
+
+        float x = static_cast<float>(width) * 0.5f, y = static_cast<float>(height) * 0.5f;
+        std::normal_distribution<float> step(0.0f, 6.0f);
+        std::uniform_int_distribution<int> wheel(0, 40);
+
+        for (uint32_t frame = 0; frame < options.frames; ++frame) {
+            const auto frameStart = now;
+            for (uint32_t i = 0; i < MOTION_EVENTS_PER_FRAME; ++i) {
+                now = frameStart + FRAME_INTERVAL * i / MOTION_EVENTS_PER_FRAME;
+                x = std::clamp(x + step(rng), 0.0f, static_cast<float>(width - 1));
+                y = std::clamp(y + step(rng), 0.0f, static_cast<float>(height - 1));
+                input::PushMouseMotion(recorder, x, y);
+            }
+
+            if (frame % CLICK_INTERVAL_FRAMES == 0) input::CatchMouseButton(recorder, input::MouseButton::eLeft, input::ActionPhase::eStart, 1, 0);
+            if (frame % CLICK_INTERVAL_FRAMES == 6) input::CatchMouseButton(recorder, input::MouseButton::eLeft, input::ActionPhase::eEnd, 0, 0);
+            if (wheel(rng) == 0) input::PushMouseWheel(recorder, 0, 1);
+
+            const uint32_t resizeStep = frame % RESIZE_INTERVAL_FRAMES;
+            if (frame > 0 && resizeStep < RESIZE_STEPS) {
+                width += (frame / RESIZE_INTERVAL_FRAMES) % 2 == 0 ? RESIZE_STEP_PIXELS : -RESIZE_STEP_PIXELS;
+                input::RecordResize(recorder, width, height);
+            }
+
+            now = frameStart + FRAME_INTERVAL;
+            input::RefreshResources(recorder);
+            input::ProcessInputEvents(recorder);
+        }
+        return trace;
+    }
+
+    uint64_t GetSceneSignature(const ReplayScene& scene, const uint64_t seed) noexcept {
+        const ViewpanelLayoutTree& tree = scene.viewport.layoutTree;
+        uint64_t signature = MixSignature(seed, static_cast<uint64_t>(scene.cursor.currentCursor));
+        for (uint32_t i = 0; i < tree.size(); ++i) {
+            if (tree.panels[i] == scene.viewport.hoveredPanel) signature = MixSignature(signature, i);
+        }
+        for (uint32_t i = 0; i < scene.batch.count; ++i) {
+            const glm::vec4& rect = scene.batch.instances[i].rect;
+            signature = MixSignature(signature, static_cast<uint64_t>(rect.x) << 48 ^ static_cast<uint64_t>(rect.y) << 32 ^ static_cast<uint64_t>(rect.z) << 16 ^ static_cast<uint64_t>(rect.w));
+        }
+        return signature;
+    }
+
+    ReplayResult Replay(const input::InputTrace& trace, const BenchOptions& options) {
+        ReplayScene scene(options.panelCount);
+        ReplayResult result{};
+
+        struct PendingEvent {
+            input::InputTraceEventType              type{};
+            std::chrono::steady_clock::time_point   time{};
+        };
+        std::vector<PendingEvent> pending{};
+
+        for (const input::InputTraceEvent& event : trace.events) {
+            scene.now += std::chrono::microseconds{event.deltaMicroseconds};
+
+            switch (event.type) {
+                case input::InputTraceEventType::eMouseMotion: {
+                    input::PushMouseMotion(scene.input, static_cast<float>(event.x), static_cast<float>(event.y));
+                    break;
+                }
+                case input::InputTraceEventType::eMouseWheel: {
+                    input::PushMouseWheel(scene.input, static_cast<float>(event.x), static_cast<float>(event.y));
+                    break;
+                }
+                case input::InputTraceEventType::eMouseButton: {
+                    input::CatchMouseButton(scene.input, static_cast<input::MouseButton>(event.button), static_cast<input::ActionPhase>(event.phase), event.value1, event.value2);
+                    break;
+                }
+                case input::InputTraceEventType::eResize: {
+                    // laid out synchronously in the platform callback, nothing waits for a frame
+                    const uint64_t start = NowNanoseconds();
+                    ResizingViewport(scene.viewport, event.x, event.y);
+                    result.resize.add(NowNanoseconds() - start);
+                    continue;
+                }
+                case input::InputTraceEventType::eFrame: {
+                    const uint64_t start = NowNanoseconds();
+                    input::RefreshResources(scene.input);
+                    input::ProcessInputEvents(scene.input);
+                    gui::BuildRectBatch(scene.batch, scene.viewport.layoutTree, {});
+                    const uint64_t processing = NowNanoseconds() - start;
+
+                    result.frame.add(processing);
+                    for (const PendingEvent& waiting : pending) {
+                        const auto waited = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(scene.now - waiting.time).count());
+                        LatencyHistogram& histogram = waiting.type == input::InputTraceEventType::eMouseMotion ? result.motion
+                                                    : waiting.type == input::InputTraceEventType::eMouseButton ? result.button
+                                                    : result.wheel;
+                        histogram.add(waited + processing);
+                    }
+                    pending.clear();
+
+                    result.signature = GetSceneSignature(scene, result.signature);
+                    ++result.frames;
+                    continue;
+                }
+            }
+            pending.push_back({event.type, scene.now});
+        }
+
+        result.droppedEvents = scene.input.events.droppedCount();
+        return result;
+    }
+
+    std::string FormatHistogram(const std::string_view name, LatencyHistogram& histogram) {
+        if (histogram.nanoseconds.empty()) return std::format(R"("{}": {{"count": 0}})", name);
+
+        std::vector<uint64_t>& ns = histogram.nanoseconds;
+        std::ranges::sort(ns);
+        const auto percentile = [&ns](const double p) {
+            const auto rank = static_cast<size_t>(p * static_cast<double>(ns.size() - 1) + 0.5);
+            return ns[std::min(rank, ns.size() - 1)];
+        };
+
+        std::string buckets{};
+        for (size_t i = 0; i < LATENCY_BUCKET_COUNT; ++i) {
+            if (histogram.buckets[i] == 0) continue;
+            if (!buckets.empty()) buckets += ", ";
+            buckets += std::format(R"({{"below_ns": {}, "count": {}}})", uint64_t{1} << i, histogram.buckets[i]);
+        }
+
+        return std::format(R"("{}": {{"count": {}, "p50_ns": {}, "p90_ns": {}, "p99_ns": {}, "max_ns": {}, "buckets": [{}]}})",
+            name, ns.size(), percentile(0.50), percentile(0.90), percentile(0.99), ns.back(), buckets);
+    }
+
+    bool IsSameTrace(const input::InputTrace& a, const input::InputTrace& b) {
+        return a.events.size() == b.events.size()
+            && std::memcmp(a.events.data(), b.events.data(), a.events.size() * sizeof(input::InputTraceEvent)) == 0;
+    }
+
+    bool ParseOptions(const int argc, char** argv, BenchOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (arg == "--trace" && hasValue) options.tracePath = argv[++i];
+            else if (arg == "--record" && hasValue) options.recordPath = argv[++i];
+            else if (arg == "--frames" && hasValue) options.frames = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (arg == "--panels" && hasValue) options.panelCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (arg == "--seed" && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+            else if (arg == "--out" && hasValue) options.outPath = argv[++i];
+            else {
+                std::cerr << "usage: " << argv[0] << " [--trace FILE] [--record FILE] [--frames N] [--panels N] [--seed N] [--out FILE]" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(const int argc, char** argv) {
+    BenchOptions options{};
+    if (!ParseOptions(argc, argv, options)) return EXIT_FAILURE;
+
+    std::optional<input::InputTrace> trace = options.tracePath.empty() ? std::optional(GenerateTrace(options)) : input::LoadInputTrace(options.tracePath);
+    if (!trace) return EXIT_FAILURE;
+
+    // a written trace has to load back identical
+    bool roundTrip = true;
+    if (!options.recordPath.empty()) {
+        if (!input::SaveInputTrace(*trace, options.recordPath)) return EXIT_FAILURE;
+        const std::optional<input::InputTrace> loaded = input::LoadInputTrace(options.recordPath);
+        roundTrip = loaded && IsSameTrace(*trace, *loaded);
+    }
+
+    ReplayResult result = Replay(*trace, options);
+    const ReplayResult repeat = Replay(*trace, options);
+    const bool deterministic = result.signature == repeat.signature && result.frames == repeat.frames;
+
+    const std::string json = std::format(
+        "{{\n"
+        R"(  "benchmark": "ufox_input", "source": "{}", "events": {}, "trace_bytes": {}, "panels": {},)" "\n"
+        R"(  "frames": {}, "dropped_events": {}, "deterministic": {}, "round_trip": {},)" "\n"
+        "  {},\n  {},\n  {},\n  {},\n  {}\n"
+        "}}\n",
+        options.tracePath.empty() ? "generated" : options.tracePath, trace->events.size(),
+        sizeof(input::InputTraceHeader) + trace->events.size() * sizeof(input::InputTraceEvent), options.panelCount,
+        result.frames, result.droppedEvents, deterministic ? "true" : "false", roundTrip ? "true" : "false",
+        FormatHistogram("motion", result.motion), FormatHistogram("button", result.button), FormatHistogram("wheel", result.wheel),
+        FormatHistogram("resize", result.resize), FormatHistogram("frame", result.frame));
+
+    if (options.outPath.empty()) {
+        std::cout << json;
+        return deterministic && roundTrip ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::ofstream out(options.outPath);
+    if (!out) {
+        std::cerr << "cannot write " << options.outPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    out << json;
+    return deterministic && roundTrip ? EXIT_SUCCESS : EXIT_FAILURE;
+}
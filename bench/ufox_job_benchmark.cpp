@@ -0,0 +1,293 @@
+// Headless job system benchmark: builds synthetic task graphs, executes each on pools of a
+// growing worker count and reports how the execute time scales. Every execute is validated:
+// each task ran exactly once, after all of its predecessors, and main thread tasks ran on the
+// executing thread. Results are written as JSON.
+//
+//   UFoxJobBenchmark [--iterations N] [--warmup N] [--workers N] [--filter NAME] [--out FILE]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+import ufox_job_system;
+
+namespace {
+    using namespace ufox::jobs;
+
+    enum class GraphShape {
+        eFanOut,        // root, independent leaves, join
+        eLayered,       // layers where every task depends on two random tasks of the layer above
+        eFrame,         // the engine frame: main thread input and present around pooled work
+    };
+
+    struct BenchScenario {
+        std::string_view    name{};
+        GraphShape          shape{GraphShape::eFanOut};
+        uint32_t            width{0};           // leaves, tasks per layer or layout jobs per frame
+        uint32_t            depth{0};           // layers of eLayered
+        uint32_t            work{0};            // spin iterations per task
+    };
+
+    constexpr BenchScenario SCENARIOS[] = {
+        {"fan_out_4k_small",    GraphShape::eFanOut,  4096, 0,  500},
+        {"fan_out_256_large",   GraphShape::eFanOut,  256,  0,  50000},
+        {"layered_64x32",       GraphShape::eLayered, 64,   32, 5000},
+        {"frame_64_layout",     GraphShape::eFrame,   64,   0,  10000},
+    };
+
+    struct BenchOptions {
+        uint32_t        iterations{50};
+        uint32_t        warmup{5};
+        uint32_t        maxWorkers{static_cast<uint32_t>(std::max(1u, std::thread::hardware_concurrency()))};
+        std::string     filter{};
+        std::string     outPath{};
+    };
+
+    std::atomic<uint64_t> spinSink{0};
+
+    void Spin(const uint32_t iterations) noexcept {
+        uint64_t x = 0x9E3779B97F4A7C15ull + iterations;
+        for (uint32_t i = 0; i < iterations; ++i) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+        }
+        spinSink.fetch_add(x & 1, std::memory_order_relaxed);
+    }
+
+    // Start and end tickets of every task in one execute, predecessors must end before their
+    // successors start.
+    struct ExecutionLog {
+        explicit ExecutionLog(const size_t taskCount) : starts(taskCount), ends(taskCount), runs(taskCount), threads(taskCount) {}
+
+        void reset() {
+            ticket.store(0, std::memory_order_relaxed);
+            for (std::atomic<uint32_t>& runCount : runs) runCount.store(0, std::memory_order_relaxed);
+        }
+
+        std::atomic<uint64_t>               ticket{0};
+        std::vector<uint64_t>               starts;
+        std::vector<uint64_t>               ends;
+        std::vector<std::atomic<uint32_t>>  runs;
+        std::vector<std::thread::id>        threads;
+    };
+
+    struct BenchGraph {
+        TaskGraph                               graph{};
+        std::vector<std::pair<TaskId, TaskId>>  edges{};
+        std::vector<TaskAffinity>               affinities{};
+    };
+
+    TaskId AddLoggedTask(BenchGraph& bench, ExecutionLog& log, const uint32_t work, const TaskAffinity affinity = TaskAffinity::eAny) {
+        const auto id = static_cast<TaskId>(bench.affinities.size());
+        bench.affinities.push_back(affinity);
+        bench.graph.add([&log, id, work] {
+            log.starts[id] = log.ticket.fetch_add(1, std::memory_order_relaxed);
+            log.threads[id] = std::this_thread::get_id();
+            Spin(work);
+            log.runs[id].fetch_add(1, std::memory_order_relaxed);
+            log.ends[id] = log.ticket.fetch_add(1, std::memory_order_relaxed);
+        }, affinity);
+        return id;
+    }
+
+    void AddEdge(BenchGraph& bench, const TaskId before, const TaskId after) {
+        bench.graph.precede(before, after);
+        bench.edges.emplace_back(before, after);
+    }
+
+    size_t GetTaskCount(const BenchScenario& scenario) {
+        switch (scenario.shape) {
+            case GraphShape::eFanOut:  return scenario.width + 2;
+            case GraphShape::eLayered: return static_cast<size_t>(scenario.width) * scenario.depth;
+            default:                   return scenario.width + 6;
+        }
+    }
+
+    void BuildGraph(BenchGraph& bench, ExecutionLog& log, const BenchScenario& scenario) {
+        switch (scenario.shape) {
+            case GraphShape::eFanOut: {
+                const TaskId root = AddLoggedTask(bench, log, scenario.work);
+                const TaskId join = AddLoggedTask(bench, log, scenario.work);
+                for (uint32_t i = 0; i < scenario.width; ++i) {
+                    const TaskId leaf = AddLoggedTask(bench, log, scenario.work);
+                    AddEdge(bench, root, leaf);
+                    AddEdge(bench, leaf, join);
+                }
+                break;
+            }
+            case GraphShape::eLayered: {
+                std::mt19937 rng(scenario.width * 31 + scenario.depth);
+                std::uniform_int_distribution<uint32_t> pick(0, scenario.width - 1);
+                for (uint32_t layer = 0; layer < scenario.depth; ++layer) {
+                    for (uint32_t i = 0; i < scenario.width; ++i) {
+                        const TaskId task = AddLoggedTask(bench, log, scenario.work);
+                        if (layer == 0) continue;
+
+                        const TaskId above = task - i - scenario.width;
+                        const uint32_t first = pick(rng);
+                        uint32_t second = pick(rng);
+                        if (second == first) second = (first + 1) % scenario.width;
+                        AddEdge(bench, above + first, task);
+                        AddEdge(bench, above + second, task);
+                    }
+                }
+                break;
+            }
+            case GraphShape::eFrame: {
+                // input -> layout subtrees -> hit grid and rect batch -> present, the fence and
+                // the asset poll run alongside
+                const TaskId input = AddLoggedTask(bench, log, scenario.work, TaskAffinity::eMainThread);
+                const TaskId fence = AddLoggedTask(bench, log, scenario.work * 4);
+                const TaskId assets = AddLoggedTask(bench, log, scenario.work / 10);
+                const TaskId hitGrid = AddLoggedTask(bench, log, scenario.work * 2);
+                const TaskId batch = AddLoggedTask(bench, log, scenario.work * 2);
+                const TaskId present = AddLoggedTask(bench, log, scenario.work, TaskAffinity::eMainThread);
+                for (uint32_t i = 0; i < scenario.width; ++i) {
+                    const TaskId layout = AddLoggedTask(bench, log, scenario.work);
+                    AddEdge(bench, input, layout);
+                    AddEdge(bench, layout, hitGrid);
+                    AddEdge(bench, layout, batch);
+                }
+                AddEdge(bench, hitGrid, present);
+                AddEdge(bench, batch, present);
+                AddEdge(bench, fence, present);
+                AddEdge(bench, assets, present);
+                break;
+            }
+        }
+    }
+
+    bool ValidateExecution(const BenchGraph& bench, const ExecutionLog& log, const std::thread::id mainThread) {
+        for (size_t i = 0; i < bench.affinities.size(); ++i) {
+            if (log.runs[i].load(std::memory_order_relaxed) != 1) return false;
+            if (bench.affinities[i] == TaskAffinity::eMainThread && log.threads[i] != mainThread) return false;
+        }
+        return std::ranges::all_of(bench.edges, [&log](const auto& edge) { return log.ends[edge.first] < log.starts[edge.second]; });
+    }
+
+    struct RunResult {
+        uint32_t    workers{0};
+        double      p50Ms{0.0};
+        double      meanMs{0.0};
+        bool        valid{true};
+    };
+
+    RunResult RunWorkers(const BenchScenario& scenario, const BenchOptions& options, const uint32_t workers) {
+        ThreadPool pool(workers);
+        BenchGraph bench{};
+        ExecutionLog log(GetTaskCount(scenario));
+        BuildGraph(bench, log, scenario);
+
+        RunResult result{workers};
+        std::vector<double> samples{};
+        samples.reserve(options.iterations);
+
+        for (uint32_t i = 0; i < options.warmup + options.iterations; ++i) {
+            log.reset();
+            const auto start = std::chrono::steady_clock::now();
+            bench.graph.execute(pool);
+            const auto end = std::chrono::steady_clock::now();
+
+            result.valid = result.valid && ValidateExecution(bench, log, std::this_thread::get_id());
+            if (i >= options.warmup) samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        std::ranges::sort(samples);
+        double total = 0.0;
+        for (const double sample : samples) total += sample;
+        result.p50Ms = samples[samples.size() / 2];
+        result.meanMs = total / static_cast<double>(samples.size());
+        return result;
+    }
+
+    std::string RunScenario(const BenchScenario& scenario, const BenchOptions& options, bool& valid) {
+        std::vector<RunResult> results{};
+        for (uint32_t workers = 1; workers <= options.maxWorkers; workers *= 2) {
+            results.push_back(RunWorkers(scenario, options, workers));
+            if (workers < options.maxWorkers && workers * 2 > options.maxWorkers) results.push_back(RunWorkers(scenario, options, options.maxWorkers));
+        }
+
+        valid = std::ranges::all_of(results, &RunResult::valid);
+
+        std::string runs{};
+        for (const RunResult& result : results) {
+            if (!runs.empty()) runs += ",\n";
+            const double speedup = results.front().p50Ms / result.p50Ms;
+            runs += std::format(R"(        {{"workers": {}, "p50_ms": {:.3f}, "mean_ms": {:.3f}, "speedup": {:.2f}, "efficiency": {:.2f}, "valid": {}}})",
+                result.workers, result.p50Ms, result.meanMs, speedup, speedup / result.workers, result.valid ? "true" : "false");
+        }
+
+        return std::format(
+            "    {{\n"
+            R"(      "name": "{}", "tasks": {}, "work": {},)" "\n"
+            R"(      "runs": [)" "\n{}\n"
+            "      ]\n"
+            "    }}",
+            scenario.name, GetTaskCount(scenario), scenario.work, runs);
+    }
+
+    bool ParseOptions(const int argc, char** argv, BenchOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (arg == "--iterations" && hasValue) options.iterations = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (arg == "--warmup" && hasValue) options.warmup = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+            else if (arg == "--workers" && hasValue) options.maxWorkers = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+            else if (arg == "--out" && hasValue) options.outPath = argv[++i];
+            else {
+                std::cerr << "usage: " << argv[0] << " [--iterations N] [--warmup N] [--workers N] [--filter NAME] [--out FILE]" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(const int argc, char** argv) {
+    BenchOptions options{};
+    if (!ParseOptions(argc, argv, options)) return EXIT_FAILURE;
+
+    std::string json = std::format("{{\n  \"benchmark\": \"ufox_jobs\",\n  \"iterations\": {},\n  \"max_workers\": {},\n  \"scenarios\": [\n",
+        options.iterations, options.maxWorkers);
+
+    bool first = true;
+    bool allValid = true;
+    for (const BenchScenario& scenario : SCENARIOS) {
+        if (!options.filter.empty() && scenario.name.find(options.filter) == std::string_view::npos) continue;
+
+        bool valid = true;
+        if (!first) json += ",\n";
+        json += RunScenario(scenario, options, valid);
+        allValid = allValid && valid;
+        first = false;
+    }
+
+    json += "\n  ]\n}\n";
+
+    if (options.outPath.empty()) {
+        std::cout << json;
+        return allValid ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::ofstream out(options.outPath);
+    if (!out) {
+        std::cerr << "cannot write " << options.outPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    out << json;
+    return allValid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
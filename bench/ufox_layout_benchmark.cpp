@@ -0,0 +1,381 @@
+// Headless layout benchmark: builds synthetic Viewpanel trees and times the measure, arrange
+// and Discadelta context passes and a drag-resize sequence without a window or GPU, followed by
+// the GUI rect batch of every resize step. The arrange pass is repeated on a job pool and its
+// rects must match the serial sweep exactly, the exit code fails otherwise. Results are written
+// as JSON.
+//
+//   UFoxLayoutBenchmark [--iterations N] [--warmup N] [--filter NAME] [--out FILE]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+import ufox_lib;
+import ufox_geometry;
+import ufox_gui_batch;
+
+namespace {
+    std::atomic<uint64_t> heapAllocations{0};
+}
+
+// Every heap allocation of the process is counted, the passes are expected to make none.
+void* operator new(const std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+    using namespace ufox;
+    using namespace ufox::geometry;
+
+    enum class TreeShape { eDeepChain, eWideRow, eBalanced };
+    enum class LengthMix { ePixel, eMixed };
+    enum class FlexMode { eCompress, eExpand };
+
+    struct BenchScenario {
+        std::string_view    name{};
+        TreeShape           shape{TreeShape::eBalanced};
+        uint32_t            panelCount{0};
+        uint32_t            branching{0};       // children per panel for eBalanced
+        LengthMix           lengths{LengthMix::ePixel};
+        bool                clamped{false};     // min/max on a part of the panels
+        FlexMode            mode{FlexMode::eExpand};
+    };
+
+    constexpr BenchScenario SCENARIOS[] = {
+        {"deep_chain_1k_mixed_clamped_expand",  TreeShape::eDeepChain, 1000,   0, LengthMix::eMixed, true,  FlexMode::eExpand},
+        {"deep_chain_1k_pixel_compress",        TreeShape::eDeepChain, 1000,   0, LengthMix::ePixel, false, FlexMode::eCompress},
+        {"wide_row_1k_pixel_compress",          TreeShape::eWideRow,   1000,   0, LengthMix::ePixel, false, FlexMode::eCompress},
+        {"wide_row_1k_pixel_expand",            TreeShape::eWideRow,   1000,   0, LengthMix::ePixel, false, FlexMode::eExpand},
+        {"wide_row_10k_mixed_clamped_compress", TreeShape::eWideRow,   10000,  0, LengthMix::eMixed, true,  FlexMode::eCompress},
+        {"balanced_b8_10k_mixed_clamped_expand",   TreeShape::eBalanced, 10000, 8, LengthMix::eMixed, true, FlexMode::eExpand},
+        {"balanced_b8_10k_mixed_clamped_compress", TreeShape::eBalanced, 10000, 8, LengthMix::eMixed, true, FlexMode::eCompress},
+        {"balanced_b4_100k_mixed_expand",       TreeShape::eBalanced,  100000, 4, LengthMix::eMixed, false, FlexMode::eExpand},
+    };
+
+    constexpr uint32_t RESIZE_SWEEP_STEPS = 32;    // events per drag direction
+    constexpr int RESIZE_STEP_PIXELS = 3;
+
+    constexpr std::string_view ToString(const TreeShape shape) noexcept {
+        switch (shape) {
+            case TreeShape::eDeepChain: return "deep_chain";
+            case TreeShape::eWideRow:   return "wide_row";
+            default:                    return "balanced";
+        }
+    }
+
+    constexpr std::string_view ToString(const LengthMix lengths) noexcept {
+        return lengths == LengthMix::ePixel ? "pixel" : "mixed";
+    }
+
+    constexpr std::string_view ToString(const FlexMode mode) noexcept {
+        return mode == FlexMode::eCompress ? "compress" : "expand";
+    }
+
+    struct BenchOptions {
+        uint32_t            iterations{200};
+        uint32_t            warmup{10};
+        std::string         filter{};
+        std::string         outPath{};
+    };
+
+    struct BenchTree {
+        std::vector<std::unique_ptr<Viewpanel>>     storage{};
+        ViewpanelLayoutTree                         tree{};
+        uint32_t                                    parentCount{0};
+        int                                         width{0};
+        int                                         height{0};
+
+        [[nodiscard]] Viewpanel& root() const noexcept { return *storage.front(); }
+    };
+
+    struct PassSamples {
+        std::vector<uint64_t>   nanoseconds{};
+        uint64_t                heapAllocations{0};
+        uint64_t                scratchSpills{0};
+    };
+
+    Length MakeLength(std::mt19937& rng, const BenchScenario& scenario) {
+        const float pixels = scenario.mode == FlexMode::eCompress
+            ? static_cast<float>(std::uniform_int_distribution(40, 200)(rng))
+            : static_cast<float>(std::uniform_int_distribution(4, 24)(rng));
+        if (scenario.lengths == LengthMix::ePixel) return Length::Pixels(pixels);
+
+        switch (std::uniform_int_distribution(0, 2)(rng)) {
+            case 0:  return Length::Pixels(pixels);
+            case 1:  return Length::Percent(static_cast<float>(std::uniform_int_distribution(5, 40)(rng)));
+            default: return Length::Auto();
+        }
+    }
+
+    void ConfigurePanel(Viewpanel& panel, std::mt19937& rng, const BenchScenario& scenario, const uint32_t depth) {
+        panel.alignment = depth % 2 == 0 ? PanelAlignment::eRow : PanelAlignment::eColumn;
+        panel.width = MakeLength(rng, scenario);
+        panel.height = MakeLength(rng, scenario);
+        panel.flexShrink = std::uniform_real_distribution(0.25f, 1.0f)(rng);
+        panel.flexGlow = std::uniform_real_distribution(0.0f, 2.0f)(rng);
+
+        if (scenario.clamped && std::uniform_int_distribution(0, 3)(rng) == 0) {
+            panel.minWidth = Length::Pixels(static_cast<float>(std::uniform_int_distribution(2, 30)(rng)));
+            panel.minHeight = Length::Pixels(static_cast<float>(std::uniform_int_distribution(2, 30)(rng)));
+            panel.maxWidth = Length::Pixels(static_cast<float>(std::uniform_int_distribution(60, 400)(rng)));
+            panel.maxHeight = Length::Pixels(static_cast<float>(std::uniform_int_distribution(60, 400)(rng)));
+        }
+    }
+
+    void BuildBenchTree(BenchTree& bench, const BenchScenario& scenario) {
+        std::mt19937 rng{0xF0C5u};
+
+        bench.storage.reserve(scenario.panelCount);
+        bench.storage.push_back(std::make_unique<Viewpanel>(scenario.shape == TreeShape::eWideRow ? PanelAlignment::eRow : PanelAlignment::eColumn));
+
+        std::vector<uint32_t> depths{0};
+        depths.reserve(scenario.panelCount);
+
+        for (uint32_t i = 1; i < scenario.panelCount; ++i) {
+            const uint32_t parent = scenario.shape == TreeShape::eDeepChain ? i - 1
+                                  : scenario.shape == TreeShape::eWideRow ? 0
+                                  : (i - 1) / scenario.branching;
+
+            bench.storage.push_back(std::make_unique<Viewpanel>());
+            Viewpanel& panel = *bench.storage.back();
+            depths.push_back(depths[parent] + 1);
+
+            ConfigurePanel(panel, rng, scenario, depths.back());
+            bench.storage[parent]->add(&panel);
+        }
+
+        bench.parentCount = 0;
+        for (const auto& panel : bench.storage) {
+            if (!panel->isChildrenEmpty()) ++bench.parentCount;
+        }
+
+        // first pass measures the tree, the viewport is then sized below or above the root base
+        ViewpanelLayoutTree& tree = bench.tree;
+        SyncViewpanelLayoutTree(tree, bench.root());
+        AccumulateRectLayoutStepBaseLength(tree);
+
+        const RectLayout& layout = tree.layouts.front();
+        const bool compress = scenario.mode == FlexMode::eCompress;
+        bench.width = std::max(64, compress ? layout.baseWidth / 2 : layout.baseWidth * 2);
+        bench.height = std::max(64, compress ? layout.baseHeight / 2 : layout.baseHeight * 2);
+
+        MakeRectLayout(tree, 0, 0, bench.width, bench.height);
+    }
+
+    // Dirties every panel through its handle, leaves first so each walk up stops at the parent.
+    void DirtyBenchTree(BenchTree& bench) {
+        for (auto it = bench.tree.panels.rbegin(); it != bench.tree.panels.rend(); ++it) {
+            (*it)->markDirty(LayoutDirtyFlags::eAll);
+        }
+        SyncViewpanelLayoutTree(bench.tree, bench.root());
+    }
+
+    template<typename Pass>
+    void TimePass(PassSamples& samples, const bool record, Pass pass) {
+        const uint64_t allocationsBefore = heapAllocations.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+
+        pass();
+
+        const auto end = std::chrono::steady_clock::now();
+        const uint64_t allocationsAfter = heapAllocations.load(std::memory_order_relaxed);
+        if (!record) return;
+
+        samples.nanoseconds.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        samples.heapAllocations += allocationsAfter - allocationsBefore;
+    }
+
+    std::string FormatPass(const std::string_view name, PassSamples& samples, const uint32_t panelCount) {
+        std::vector<uint64_t>& ns = samples.nanoseconds;
+        std::ranges::sort(ns);
+
+        const auto percentile = [&ns](const double p) {
+            const auto rank = static_cast<size_t>(p * static_cast<double>(ns.size() - 1) + 0.5);
+            return ns[std::min(rank, ns.size() - 1)];
+        };
+
+        uint64_t total = 0;
+        for (const uint64_t sample : ns) total += sample;
+
+        const auto passes = static_cast<double>(ns.size());
+        const uint64_t p50 = percentile(0.50);
+
+        return std::format(
+            R"(        "{}": {{"p50_ns": {}, "p99_ns": {}, "min_ns": {}, "mean_ns": {:.1f}, "ns_per_panel": {:.3f}, "allocs_per_pass": {:.2f}, "scratch_spills_per_pass": {:.2f}}})",
+            name, p50, percentile(0.99), ns.front(), static_cast<double>(total) / passes,
+            static_cast<double>(p50) / static_cast<double>(std::max(1u, panelCount)),
+            static_cast<double>(samples.heapAllocations) / passes,
+            static_cast<double>(samples.scratchSpills) / passes);
+    }
+
+    std::string RunScenario(const BenchScenario& scenario, const BenchOptions& options, jobs::ThreadPool& pool, bool& parallelExact) {
+        BenchTree bench{};
+        BuildBenchTree(bench, scenario);
+        ViewpanelLayoutTree& tree = bench.tree;
+
+        PassSamples measure{};
+        PassSamples arrange{};
+        PassSamples context{};
+        measure.nanoseconds.reserve(options.iterations);
+        arrange.nanoseconds.reserve(options.iterations);
+        context.nanoseconds.reserve(options.iterations);
+
+        volatile size_t sink = 0;
+
+        for (uint32_t pass = 0; pass < options.warmup + options.iterations; ++pass) {
+            const bool record = pass >= options.warmup;
+
+            DirtyBenchTree(bench);
+
+            TimePass(measure, record, [&tree] { AccumulateRectLayoutStepBaseLength(tree); });
+
+            TimePass(arrange, record, [&tree, &bench] { MakeRectLayout(tree, 0, 0, bench.width, bench.height); });
+            if (record) arrange.scratchSpills += tree.scratch.lastPassHeapAllocations();
+
+            TimePass(context, record, [&tree, &sink] {
+                for (uint32_t i = 0; i < tree.size(); ++i) {
+                    if (tree.childCounts[i] == 0) continue;
+                    const DiscadeltaContext ctx = MakeDiscadeltaContext(tree, i, tree.scratch.resource());
+                    sink = sink + ctx.size();
+                }
+                tree.scratch.reset();
+            });
+            if (record) context.scratchSpills += tree.scratch.lastPassHeapAllocations();
+        }
+
+        // the same tree arranged with the pool, the sweep result must not depend on the schedule
+        BenchTree parallel{};
+        BuildBenchTree(parallel, scenario);
+        parallel.tree.pool = &pool;
+
+        PassSamples parallelArrange{};
+        parallelArrange.nanoseconds.reserve(options.iterations);
+
+        for (uint32_t pass = 0; pass < options.warmup + options.iterations; ++pass) {
+            const bool record = pass >= options.warmup;
+
+            DirtyBenchTree(parallel);
+            AccumulateRectLayoutStepBaseLength(parallel.tree);
+            TimePass(parallelArrange, record, [&parallel] { MakeRectLayout(parallel.tree, 0, 0, parallel.width, parallel.height); });
+        }
+        parallelExact = parallel.tree.rects == tree.rects;
+
+        // live drag-resize: one Sync + measure + arrange per event on a clean tree, the width
+        // sweeps back and forth so the layout caches see both new and revisited extents
+        PassSamples resize{};
+        PassSamples batch{};
+        resize.nanoseconds.reserve(options.iterations);
+        batch.nanoseconds.reserve(options.iterations);
+
+        gui::RectBatch rectBatch{};
+        gui::ResizeRectBatchFrames(rectBatch, 2);
+        uint64_t changedInstances = 0;
+
+        for (uint32_t pass = 0; pass < options.warmup + options.iterations; ++pass) {
+            const bool record = pass >= options.warmup;
+            const uint32_t phase = pass % (2 * RESIZE_SWEEP_STEPS);
+            const int step = static_cast<int>(phase < RESIZE_SWEEP_STEPS ? phase : 2 * RESIZE_SWEEP_STEPS - phase);
+            const int width = bench.width + step * RESIZE_STEP_PIXELS;
+
+            TimePass(resize, record, [&tree, &bench, width] {
+                SyncViewpanelLayoutTree(tree, bench.root());
+                AccumulateRectLayoutStepBaseLength(tree);
+                MakeRectLayout(tree, 0, 0, width, bench.height);
+            });
+            if (record) resize.scratchSpills += tree.scratch.lastPassHeapAllocations();
+
+            TimePass(batch, record, [&tree, &rectBatch, pass] {
+                gui::BuildRectBatch(rectBatch, tree, {});
+                (void)gui::TakeRectBatchUpload(rectBatch, pass % 2);
+            });
+            if (record) changedInstances += rectBatch.changed;
+        }
+
+        return std::format(
+            "    {{\n"
+            R"(      "name": "{}", "shape": "{}", "panels": {}, "parents": {}, "lengths": "{}", "clamped": {}, "mode": "{}", "viewport": [{}, {}],)" "\n"
+            R"(      "batch_instances": {}, "batch_changed_per_pass": {:.1f}, "workers": {}, "parallel_matches_serial": {},)" "\n"
+            "      \"passes\": {{\n{},\n{},\n{},\n{},\n{},\n{}\n      }}\n"
+            "    }}",
+            scenario.name, ToString(scenario.shape), tree.size(), bench.parentCount, ToString(scenario.lengths),
+            scenario.clamped ? "true" : "false", ToString(scenario.mode), bench.width, bench.height,
+            rectBatch.count, static_cast<double>(changedInstances) / static_cast<double>(options.iterations),
+            pool.workerCount(), parallelExact ? "true" : "false",
+            FormatPass("measure", measure, tree.size()),
+            FormatPass("arrange", arrange, tree.size()),
+            FormatPass("parallel_arrange", parallelArrange, tree.size()),
+            FormatPass("context", context, bench.parentCount),
+            FormatPass("resize", resize, tree.size()),
+            FormatPass("batch", batch, tree.size()));
+    }
+
+    bool ParseOptions(const int argc, char** argv, BenchOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (arg == "--iterations" && hasValue) options.iterations = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (arg == "--warmup" && hasValue) options.warmup = static_cast<uint32_t>(std::max(0, std::atoi(argv[++i])));
+            else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+            else if (arg == "--out" && hasValue) options.outPath = argv[++i];
+            else {
+                std::cerr << "usage: " << argv[0] << " [--iterations N] [--warmup N] [--filter NAME] [--out FILE]" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(const int argc, char** argv) {
+    BenchOptions options{};
+    if (!ParseOptions(argc, argv, options)) return EXIT_FAILURE;
+
+    std::string json = std::format("{{\n  \"benchmark\": \"ufox_layout\",\n  \"iterations\": {},\n  \"warmup\": {},\n  \"scenarios\": [\n",
+        options.iterations, options.warmup);
+
+    jobs::ThreadPool pool{};
+    bool parallelExact = true;
+
+    bool first = true;
+    for (const BenchScenario& scenario : SCENARIOS) {
+        if (!options.filter.empty() && scenario.name.find(options.filter) == std::string_view::npos) continue;
+
+        bool exact = true;
+        if (!first) json += ",\n";
+        json += RunScenario(scenario, options, pool, exact);
+        parallelExact = parallelExact && exact;
+        first = false;
+    }
+
+    json += "\n  ]\n}\n";
+
+    if (options.outPath.empty()) {
+        std::cout << json;
+        return parallelExact ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::ofstream out(options.outPath);
+    if (!out) {
+        std::cerr << "cannot write " << options.outPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    out << json;
+    return parallelExact ? EXIT_SUCCESS : EXIT_FAILURE;
+}
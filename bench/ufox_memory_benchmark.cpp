@@ -0,0 +1,268 @@
+// Headless GPU memory benchmark: drives the DeviceAllocator against a fake backend that only
+// counts device allocations, so the sub-allocation logic is timed and validated without a GPU.
+// Every scenario fills a live set and then churns it, the baseline is one device allocation per
+// resource as MakeBuffer did before. Results are written as JSON.
+//
+//   UFoxMemoryBenchmark [--iterations N] [--seed N] [--filter NAME] [--out FILE]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+import ufox_memory_allocator;
+
+namespace {
+    using namespace ufox::gpu::memory;
+
+    constexpr vk::MemoryPropertyFlags DEVICE_LOCAL = vk::MemoryPropertyFlagBits::eDeviceLocal;
+    constexpr vk::MemoryPropertyFlags HOST_COHERENT = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+
+    struct BenchScenario {
+        std::string_view        name{};
+        ResourceKind            kind{ResourceKind::eBuffer};
+        vk::MemoryPropertyFlags properties{};
+        uint32_t                liveCount{0};       // resources alive once filled
+        vk::DeviceSize          minSize{0};
+        vk::DeviceSize          maxSize{0};         // sizes are log-uniform between the two
+        vk::DeviceSize          alignment{0};
+    };
+
+    constexpr BenchScenario SCENARIOS[] = {
+        {"uniform_buffers_4k_256b",     ResourceKind::eBuffer, HOST_COHERENT, 4096, 256,        256,        256},
+        {"staging_buffers_1k_mixed",    ResourceKind::eBuffer, HOST_COHERENT, 1024, 1 << 10,    1 << 20,    16},
+        {"vertex_buffers_8k_mixed",     ResourceKind::eBuffer, DEVICE_LOCAL,  8192, 64,         256 << 10,  256},
+        {"textures_2k_mixed",           ResourceKind::eImage,  DEVICE_LOCAL,  2048, 16 << 10,   64 << 20,   4096},
+    };
+
+    struct BenchOptions {
+        uint32_t        iterations{100000};     // free + allocate pairs after the fill
+        uint64_t        seed{1};
+        std::string     filter{};
+        std::string     outPath{};
+    };
+
+    uint64_t HandleValue(const vk::DeviceMemory memory) noexcept {
+        const VkDeviceMemory raw = memory;
+        uint64_t value = 0;
+        std::memcpy(&value, &raw, sizeof(raw));
+        return value;
+    }
+
+    // Hands out made-up handles, host-visible blocks are backed by malloc so mapped pointers can
+    // be written to.
+    class FakeMemoryBackend final : public MemoryBackend {
+    public:
+        std::optional<MemoryBlockHandle> allocateBlock(uint32_t, const vk::DeviceSize size, const bool map) override {
+            const uint64_t id = ++nextHandle;
+            VkDeviceMemory raw{};
+            std::memcpy(&raw, &id, sizeof(raw));
+
+            MemoryBlockHandle block{vk::DeviceMemory(raw), nullptr};
+            if (map && (block.mapped = std::malloc(size)) == nullptr) return std::nullopt;
+
+            ++allocationCalls;
+            peakLive = std::max(peakLive, ++live);
+            return block;
+        }
+
+        void freeBlock(const MemoryBlockHandle& block) override {
+            std::free(block.mapped);
+            ++freeCalls;
+            --live;
+        }
+
+        uint64_t    allocationCalls{0};
+        uint64_t    freeCalls{0};
+        uint64_t    live{0};
+        uint64_t    peakLive{0};
+
+    private:
+        uint64_t    nextHandle{0};
+    };
+
+    vk::PhysicalDeviceMemoryProperties MakeMemoryProperties() {
+        vk::PhysicalDeviceMemoryProperties properties{};
+        properties.memoryHeapCount = 2;
+        properties.memoryHeaps[0] = vk::MemoryHeap{8ull << 30, vk::MemoryHeapFlagBits::eDeviceLocal};
+        properties.memoryHeaps[1] = vk::MemoryHeap{16ull << 30, {}};
+        properties.memoryTypeCount = 2;
+        properties.memoryTypes[0] = vk::MemoryType{DEVICE_LOCAL, 0};
+        properties.memoryTypes[1] = vk::MemoryType{HOST_COHERENT, 1};
+        return properties;
+    }
+
+    struct Timings {
+        std::vector<uint64_t>   allocate{};
+        std::vector<uint64_t>   free{};
+    };
+
+    template<typename Fn>
+    void TimeCall(std::vector<uint64_t>& samples, Fn&& fn) {
+        const auto start = std::chrono::steady_clock::now();
+        fn();
+        const auto end = std::chrono::steady_clock::now();
+        samples.push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+    }
+
+    std::string FormatTimings(const std::string_view name, std::vector<uint64_t>& ns) {
+        std::ranges::sort(ns);
+        const auto percentile = [&ns](const double p) {
+            const auto rank = static_cast<size_t>(p * static_cast<double>(ns.size() - 1) + 0.5);
+            return ns[std::min(rank, ns.size() - 1)];
+        };
+
+        uint64_t total = 0;
+        for (const uint64_t sample : ns) total += sample;
+
+        return std::format(R"("{}": {{"p50_ns": {}, "p99_ns": {}, "mean_ns": {:.1f}}})",
+            name, percentile(0.50), percentile(0.99), static_cast<double>(total) / static_cast<double>(ns.size()));
+    }
+
+    // No two live allocations of one device memory object may share a byte.
+    bool ValidateNoOverlap(const std::vector<MemoryAllocation>& live) {
+        struct Range { uint64_t memory; vk::DeviceSize offset; vk::DeviceSize size; };
+        std::vector<Range> ranges{};
+        ranges.reserve(live.size());
+        for (const MemoryAllocation& allocation : live) {
+            if (allocation) ranges.push_back({HandleValue(allocation.memory()), allocation.offset(), allocation.size()});
+        }
+        std::ranges::sort(ranges, [](const Range& a, const Range& b) { return a.memory != b.memory ? a.memory < b.memory : a.offset < b.offset; });
+
+        for (size_t i = 1; i < ranges.size(); ++i) {
+            if (ranges[i].memory == ranges[i - 1].memory && ranges[i - 1].offset + ranges[i - 1].size > ranges[i].offset) return false;
+        }
+        return true;
+    }
+
+    std::string RunScenario(const BenchScenario& scenario, const BenchOptions& options, bool& valid) {
+        auto backendOwner = std::make_unique<FakeMemoryBackend>();
+        const FakeMemoryBackend& backend = *backendOwner;
+        DeviceAllocator allocator(std::move(backendOwner), MakeMemoryProperties());
+
+        std::mt19937_64 rng(options.seed);
+        std::uniform_real_distribution<double> logSize(std::log2(static_cast<double>(scenario.minSize)), std::log2(static_cast<double>(scenario.maxSize)));
+        const auto nextRequirements = [&] {
+            const auto size = static_cast<vk::DeviceSize>(std::exp2(logSize(rng)));
+            return vk::MemoryRequirements{AlignUp(std::max(size, scenario.minSize), scenario.alignment), scenario.alignment, ~0u};
+        };
+
+        Timings timings{};
+        timings.allocate.reserve(scenario.liveCount + options.iterations);
+        timings.free.reserve(options.iterations);
+
+        std::vector<MemoryAllocation> live(scenario.liveCount);
+        uint64_t failures = 0;
+        bool mappedValid = true;
+
+        const auto allocateInto = [&](MemoryAllocation& slot) {
+            const vk::MemoryRequirements requirements = nextRequirements();
+            TimeCall(timings.allocate, [&] { slot = allocator.allocate(requirements, scenario.properties, scenario.kind); });
+            if (!slot) {
+                ++failures;
+                return;
+            }
+            if (scenario.properties & vk::MemoryPropertyFlagBits::eHostVisible) {
+                mappedValid = mappedValid && slot.mapped() != nullptr && slot.offset() % scenario.alignment == 0;
+                if (slot.mapped()) std::memset(slot.mapped(), 0xA5, 16);
+            }
+        };
+
+        for (MemoryAllocation& slot : live) allocateInto(slot);
+        const MemoryStats filled = allocator.stats();
+
+        std::uniform_int_distribution<size_t> pick(0, live.size() - 1);
+        for (uint32_t i = 0; i < options.iterations; ++i) {
+            MemoryAllocation& slot = live[pick(rng)];
+            TimeCall(timings.free, [&slot] { slot.reset(); });
+            allocateInto(slot);
+        }
+
+        const MemoryStats churned = allocator.stats();
+        const bool disjoint = ValidateNoOverlap(live);
+        const uint64_t baselineCalls = scenario.liveCount + options.iterations;
+        valid = disjoint && mappedValid;
+
+        return std::format(
+            "    {{\n"
+            R"(      "name": "{}", "kind": "{}", "live": {}, "size_range": [{}, {}], "alignment": {},)" "\n"
+            R"(      {}, {},)" "\n"
+            R"(      "device_allocations": {}, "baseline_device_allocations": {}, "peak_device_objects": {}, "baseline_peak_device_objects": {},)" "\n"
+            R"(      "filled": {{"blocks": {}, "dedicated": {}, "used_bytes": {}, "block_bytes": {}, "fragmentation": {:.3f}}},)" "\n"
+            R"(      "churned": {{"blocks": {}, "dedicated": {}, "used_bytes": {}, "block_bytes": {}, "free_regions": {}, "largest_free_region": {}, "fragmentation": {:.3f}}},)" "\n"
+            R"(      "failures": {}, "disjoint": {}, "mapped_valid": {})" "\n"
+            "    }}",
+            scenario.name, scenario.kind == ResourceKind::eBuffer ? "buffer" : "image", scenario.liveCount,
+            scenario.minSize, scenario.maxSize, scenario.alignment,
+            FormatTimings("allocate", timings.allocate), FormatTimings("free", timings.free),
+            backend.allocationCalls, baselineCalls, backend.peakLive, scenario.liveCount,
+            filled.blockCount, filled.dedicatedCount, filled.usedBytes + filled.dedicatedBytes, filled.blockBytes, filled.fragmentation(),
+            churned.blockCount, churned.dedicatedCount, churned.usedBytes + churned.dedicatedBytes, churned.blockBytes,
+            churned.freeRegionCount, churned.largestFreeRegion, churned.fragmentation(),
+            failures, disjoint ? "true" : "false", mappedValid ? "true" : "false");
+    }
+
+    bool ParseOptions(const int argc, char** argv, BenchOptions& options) {
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+
+            if (arg == "--iterations" && hasValue) options.iterations = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (arg == "--seed" && hasValue) options.seed = std::strtoull(argv[++i], nullptr, 10);
+            else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+            else if (arg == "--out" && hasValue) options.outPath = argv[++i];
+            else {
+                std::cerr << "usage: " << argv[0] << " [--iterations N] [--seed N] [--filter NAME] [--out FILE]" << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(const int argc, char** argv) {
+    BenchOptions options{};
+    if (!ParseOptions(argc, argv, options)) return EXIT_FAILURE;
+
+    std::string json = std::format("{{\n  \"benchmark\": \"ufox_memory\",\n  \"iterations\": {},\n  \"seed\": {},\n  \"scenarios\": [\n",
+        options.iterations, options.seed);
+
+    bool first = true;
+    bool allValid = true;
+    for (const BenchScenario& scenario : SCENARIOS) {
+        if (!options.filter.empty() && scenario.name.find(options.filter) == std::string_view::npos) continue;
+
+        bool valid = true;
+        if (!first) json += ",\n";
+        json += RunScenario(scenario, options, valid);
+        allValid = allValid && valid;
+        first = false;
+    }
+
+    json += "\n  ]\n}\n";
+
+    if (options.outPath.empty()) {
+        std::cout << json;
+        return allValid ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::ofstream out(options.outPath);
+    if (!out) {
+        std::cerr << "cannot write " << options.outPath << std::endl;
+        return EXIT_FAILURE;
+    }
+    out << json;
+    return allValid ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -232,6 +232,8 @@
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <numeric>
+#include <algorithm>
 #include <vector>
 #include <thread>
 #include <chrono>
@@ -302,8 +304,10 @@ constexpr auto MakeDiscadeltaContext = [](const std::vector<DiscadeltaSegmentCon
 
     DiscadeltaPreComputeMetrics preComputeMetrics(segmentCount, validatedInputDistance);
 
-    float compressPriorityLowestValue = std::numeric_limits<float>::max();
-    float expandPriorityLowestValue{0.0f};
+    std::vector<float> compressPriorityValues;
+    std::vector<float> expandPriorityValues;
+    compressPriorityValues.reserve(segmentCount);
+    expandPriorityValues.reserve(segmentCount);
 
     for (size_t i = 0; i < segmentCount; ++i) {
         const auto& [name, rawBase, rawCompressRatio, rawExpandRatio, rawMin, rawMax, rawOrder] = configs[i];
@@ -345,27 +349,24 @@ constexpr auto MakeDiscadeltaContext = [](const std::vector<DiscadeltaSegmentCon
 
         // --- COMPRESS PRIORITY ---
         const float greaterMin = std::max(compressSolidify, minVal);
-        const float compressPriorityValue = std::max(0.0f, baseVal - greaterMin);
-
-        if (compressPriorityValue <= compressPriorityLowestValue) {
-            preComputeMetrics.compressPriorityIndies.insert(preComputeMetrics.compressPriorityIndies.begin(), i);
-            compressPriorityLowestValue = compressPriorityValue;
-        }
-        else {
-            preComputeMetrics.compressPriorityIndies.push_back(i);
-        }
+        compressPriorityValues.push_back(compressCapacity <= 0.0f ? std::numeric_limits<float>::max()
+            : std::max(0.0f, baseVal - greaterMin) / compressCapacity);
 
         // --- EXPAND PRIORITY ---
-        const float expandPriorityValue = std::max(0.0f, maxVal - baseVal);
-        if (expandPriorityValue >= expandPriorityLowestValue) {
-            preComputeMetrics.expandPriorityIndies.push_back(i);
-            expandPriorityLowestValue = expandPriorityValue;
-        }
-        else {
-            preComputeMetrics.expandPriorityIndies.insert(preComputeMetrics.expandPriorityIndies.begin(), i);
-        }
+        expandPriorityValues.push_back(expandRatio <= 0.0f ? std::numeric_limits<float>::max()
+            : std::max(0.0f, maxVal - baseVal) / expandRatio);
     }
 
+    // Segments clamped soonest (lowest tolerance / growth room per ratio) go first
+    const auto sortPriority = [](std::vector<size_t>& indices, const std::vector<float>& values) {
+        indices.resize(values.size());
+        std::iota(indices.begin(), indices.end(), 0);
+        std::ranges::stable_sort(indices, [&values](const size_t a, const size_t b) { return values[a] < values[b]; });
+    };
+
+    sortPriority(preComputeMetrics.compressPriorityIndies, compressPriorityValues);
+    sortPriority(preComputeMetrics.expandPriorityIndies, expandPriorityValues);
+
     const bool processingCompression = validatedInputDistance < preComputeMetrics.accumulateBaseDistance;
 
     return { std::move(segments), std::move(preComputeMetrics), processingCompression };
@@ -2,7 +2,12 @@
 // Created by Puwiwad on 05.10.2025.
 //
 module;
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <span>
+#include <string>
+#include <vector>
 #include <vulkan/vulkan_raii.hpp>
 #include <fstream>
 #include <glm/glm.hpp>
@@ -19,6 +24,7 @@ import ufox_input;
 import ufox_geometry;
 import ufox_render;
 import ufox_gui;
+import ufox_gui_batch;
 import ufox_resource_manager;
 
 
@@ -49,6 +55,15 @@ export namespace ufox {
         UFoxEngine() = default;
 
         ~UFoxEngine() {
+            // The background import still uses the resource manager
+            try {
+                if (jobPool) jobPool->wait(assetImport);
+            } catch (const std::exception& e) {
+                debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Texture import failed: {}", e.what());
+            }
+
+            if (inputTrace) input::SaveInputTrace(*inputTrace, inputTracePath);
+
             // Wait for all GPU operations to complete before destroying resources
             if (gpu.device) {
                 gpu.device->waitIdle();
@@ -66,8 +81,28 @@ export namespace ufox {
         }
 
         void Init() {
+            // UFOX_PROFILE_FRAMES=<n> writes a Chrome trace of the first n frames, profiled builds only
+            if (const char* frames = std::getenv("UFOX_PROFILE_FRAMES")) {
+                profiler::BeginCapture(static_cast<uint32_t>(std::max(1, std::atoi(frames))), "ufox_trace.json");
+            }
+
             InitializeGPU();
+
+            // UFOX_RECORD_INPUT=<file> records the input events for a headless replay on exit
+            if (const char* path = std::getenv("UFOX_RECORD_INPUT")) {
+                inputTrace.emplace();
+                inputTracePath = path;
+                inputResource->recording = &*inputTrace;
+
+                // the replay lays the viewport out at the size the recording started with
+                int width = 0, height = 0;
+                windowResource->getExtent(width, height);
+                input::RecordResize(*inputResource, width, height);
+            }
+
             viewport.emplace(*windowResource);
+            // large panel trees fan their arrange sweep out to the pool
+            viewport->layoutTree.pool = &*jobPool;
             viewpanel1.emplace(geometry::PanelAlignment::eRow,geometry::PickingMode::eIgnore);
             viewpanel1->name = "root";
             viewpanel2.emplace();
@@ -156,6 +191,7 @@ export namespace ufox {
             geometry::ResizingViewport(*viewport, width, height);
             geometry::BindEvents(*viewport,*inputResource, *standardCursorResource);
 
+            buildFrameGraph();
         }
 
         void Run() {
@@ -163,28 +199,66 @@ export namespace ufox {
             bool running = true;
             SDL_Event event;
             while (running) {
+                // nothing changed last frame, sleep until the next event instead of spinning
+                if (idleFrame) SDL_WaitEventTimeout(nullptr, IDLE_WAIT_TIMEOUT_MS);
                 sdlPollEvents(event, running);
-                beginUpdate();
-                update();
-                lateUpdate();
-                render();
+                runFrame();
             }
 #else
             while (!glfwWindowShouldClose(windowResource->getHandle())) {
-                glfwPollEvents();
-                beginUpdate();
-                update();
-                lateUpdate();
-                render();
+                if (idleFrame) glfwWaitEventsTimeout(IDLE_WAIT_TIMEOUT_MS / 1000.0);
+                else glfwPollEvents();
+                runFrame();
             }
 #endif
         }
 
     private:
+        // One frame as a task graph. Input, the asset poll and present run on the main thread:
+        // input and present make window system calls, and the asset poll and present submit to
+        // the graphics queue, so all queue access stays on one thread. The fence wait and the
+        // rect batch build run on the pool. The batch follows input and touches host memory only.
+        // Present waits for the batch, the fence and the asset poll, then grows, uploads and
+        // draws the instance buffer. The fence belongs to the frame slot MAX_FRAMES_IN_FLIGHT
+        // back, so input and the batch overlap the frames still in flight.
+        void buildFrameGraph() {
+            frameGraph.clear();
+            const jobs::TaskId input = frameGraph.add([this] {
+                {
+                    profiler::ScopedZone zone{"UFoxEngine::beginUpdate"};
+                    beginUpdate();
+                }
+                {
+                    profiler::ScopedZone zone{"UFoxEngine::update"};
+                    update();
+                }
+                {
+                    profiler::ScopedZone zone{"UFoxEngine::lateUpdate"};
+                    lateUpdate();
+                }
+            }, jobs::TaskAffinity::eMainThread);
+            const jobs::TaskId fence = frameGraph.add([this] { waitFrameFence(); });
+            const jobs::TaskId assets = frameGraph.add([this] { pollAssetImport(); }, jobs::TaskAffinity::eMainThread);
+            const jobs::TaskId batch = frameGraph.add([this] { buildFrame(); });
+            const jobs::TaskId present = frameGraph.add([this] {
+                profiler::ScopedZone zone{"UFoxEngine::render"};
+                render();
+            }, jobs::TaskAffinity::eMainThread);
+
+            frameGraph.precede(input, batch);
+            frameGraph.precede(batch, present);
+            frameGraph.precede(fence, present);
+            frameGraph.precede(assets, present);
+        }
+
+        void runFrame() {
+            frameGraph.execute(*jobPool);
+            profiler::EndFrame();
+        }
+
         void beginUpdate() {
             input::RefreshResources(*inputResource);
-            input::UpdateGlobalMousePosition(*windowResource, *inputResource);
-            input::UpdateMouseButtonAction(*inputResource);
+            input::ProcessInputEvents(*inputResource);
         }
 
         void update() {
@@ -197,7 +271,15 @@ export namespace ufox {
         }
 
         void render() {
-            drawFrame();
+            presentFrame();
+        }
+
+        // Uploads the textures once the background import and preprocess finished.
+        void pollAssetImport() {
+            if (assetsReady || !assetImport.isDone()) return;
+            assetsReady = true;
+            const size_t uploaded = resourceManager->UploadTextures();
+            debug::log<debug::LogLevel::eInfo, debug::LogCategory::eResource>("Textures imported and preprocessed, {} uploaded", uploaded);
         }
 
 
@@ -210,8 +292,11 @@ export namespace ufox {
             glfwSetWindowUserPointer(windowResource->getHandle(), this);
             glfwSetFramebufferSizeCallback(windowResource->getHandle(), framebufferResizeCallback);
             glfwSetWindowIconifyCallback(windowResource->getHandle(), windowIconifyCallback);
+            glfwSetWindowRefreshCallback(windowResource->getHandle(), windowRefreshCallback);
             glfwSetWindowPosCallback(windowResource->getHandle(), windowMoveCallback);
             glfwSetMouseButtonCallback(windowResource->getHandle(), mouse_button_callback);
+            glfwSetCursorPosCallback(windowResource->getHandle(), cursorPosCallback);
+            glfwSetScrollCallback(windowResource->getHandle(), scrollCallback);
 
 #endif
         }
@@ -227,13 +312,17 @@ export namespace ufox {
 
             gpu.queueFamilyIndices.emplace(getQueueFamilyIndices());
             gpu.device.emplace(gpu::vulkan::MakeDevice(gpu, gpuCreateInfo));
+            gpu.allocator = std::make_unique<gpu::memory::DeviceAllocator>(
+                std::make_unique<gpu::memory::VulkanMemoryBackend>(*gpu.device), gpu.physicalDevice->getMemoryProperties());
             gpu.commandPool.emplace(gpu::vulkan::MakeCommandPool(gpu));
 
             gpu.graphicsQueue.emplace(gpu::vulkan::MakeGraphicsQueue(gpu));
             gpu.presentQueue.emplace(gpu::vulkan::MakePresentQueue(gpu));
 
-            windowResource->swapchainResource.emplace(gpu::vulkan::MakeSwapchainResource(gpu, *windowResource, vk::ImageUsageFlagBits::eColorAttachment));
+            windowResource->swapchainResource.emplace(gpu::vulkan::MakeSwapchainResource(gpu, *windowResource, SWAPCHAIN_USAGE));
             frameResource.emplace(gpu::vulkan::MakeFrameResource(gpu, vk::FenceCreateFlagBits::eSignaled));
+            remakeCanvas();
+            invalidateFrame();
 
 
 
@@ -241,17 +330,21 @@ export namespace ufox {
             standardCursorResource.emplace(input::CreateStandardMouseCursor());
 
             std::vector<char> shaderCode = ReadFile("res/shaders/test.slang.spv");
-            guiResource.emplace(gui::MakeGuiResource(gpu, *windowResource->swapchainResource, shaderCode));
+            std::vector<char> rectShaderCode = ReadFile("res/shaders/gui_rect.slang.spv");
+            guiResource.emplace(gui::MakeGuiResource(gpu, *windowResource->swapchainResource, shaderCode, rectShaderCode,
+                gpu::vulkan::FrameResource::MAX_FRAMES_IN_FLIGHT));
 
             resourceManager.emplace(gpu);
             resourceManager->SetRootPath("res/"); // Sets rootPath to "res/textures/"
-            // Scan for PNG and JPEG files
-            std::vector<std::string> extensions = {"png", "jpg", "jpeg"};
-            auto imageFiles = resourceManager->ScanForImageFiles(extensions);
-            for (const auto& file : imageFiles) {
-                std::cout << "Found Image: " << file << std::endl; // e.g., "res/textures/image1.png", "res/textures/subfolder/image2.jpg"
-                TextureImage texture_image {file};
-            }
+            // Import PNG and JPEG files, unchanged ones are restored from the metadata store
+            const std::vector<std::string> extensions = {"png", "jpg", "jpeg"};
+            // then mip and cache them as KTX2, only new or edited sources are decoded. Both run
+            // in the background, the frame graph polls for completion
+            jobPool.emplace();
+            jobPool->submit([this, extensions] {
+                resourceManager->ImportTextures(extensions, *jobPool);
+                resourceManager->PreprocessTextures(*jobPool);
+            }, assetImport);
         }
 
         [[nodiscard]] gpu::vulkan::QueueFamilyIndices getQueueFamilyIndices() const {
@@ -295,7 +388,9 @@ export namespace ufox {
             gpu.device->waitIdle();
             windowResource->extent = vk::Extent2D{static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
             windowResource->swapchainResource->Clear();
-            gpu::vulkan::ReMakeSwapchainResource(*windowResource->swapchainResource, gpu, *windowResource, vk::ImageUsageFlagBits::eColorAttachment);
+            gpu::vulkan::ReMakeSwapchainResource(*windowResource->swapchainResource, gpu, *windowResource, SWAPCHAIN_USAGE);
+            remakeCanvas();
+            invalidateFrame();
         }
 
         void recreateSwapchain(int width, int height) {
@@ -307,32 +402,95 @@ export namespace ufox {
             gpu.device->waitIdle();
             windowResource->extent = vk::Extent2D{static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
             windowResource->swapchainResource->Clear();
-            gpu::vulkan::ReMakeSwapchainResource(*windowResource->swapchainResource, gpu, *windowResource, vk::ImageUsageFlagBits::eColorAttachment);
+            gpu::vulkan::ReMakeSwapchainResource(*windowResource->swapchainResource, gpu, *windowResource, SWAPCHAIN_USAGE);
+            remakeCanvas();
+            invalidateFrame();
+        }
+
+        // The canvas or what is on screen lost its content, the next frame repaints everything.
+        void invalidateFrame() {
+            gui::ResetDamageTracker(damageTracker, windowResource->swapchainResource->extent);
+        }
+
+        // The persistent color target frames are drawn into, one per swapchain and sized like it.
+        // What an acquired image holds is not guaranteed, a clipped swapchain leaves obscured
+        // pixels undefined and some presentation engines hand out images with stale content. So
+        // only the canvas is repainted partially and the acquired image gets the whole canvas
+        // copied into it. Without transfer usage on the surface there is no canvas and every
+        // frame repaints the acquired image.
+        void remakeCanvas() {
+            canvas.reset();
+            const gpu::vulkan::SwapchainResource& swapchain = *windowResource->swapchainResource;
+            if (!(swapchain.usage & vk::ImageUsageFlagBits::eTransferDst) || swapchain.extent.width == 0 || swapchain.extent.height == 0) return;
+
+            canvas.emplace(gpu, swapchain.extent.width, swapchain.extent.height, swapchain.colorFormat, vk::ImageTiling::eOptimal,
+                vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eDeviceLocal);
+            canvas->format = swapchain.colorFormat;
+            canvas->extent = swapchain.extent;
+            gpu::vulkan::CreateImageView(gpu, *canvas);
         }
 
         void drawFrame() {
+            waitFrameFence();
+            buildFrame();
+            presentFrame();
+        }
+
+        void waitFrameFence() const {
+            profiler::ScopedZone zone{"drawFrame::waitForFences"};
             while ( vk::Result::eTimeout == gpu.device->waitForFences( *frameResource->getCurrentDrawFence(), vk::True, UINT64_MAX ) )
                 ;
+        }
+
+        // CPU side of the frame: rebuilds the rect batch and its damage in host memory the GPU
+        // never reads. The instance buffer the GPU does read is grown and written by presentFrame.
+        void buildFrame() {
+            if (pauseRendering) return;
 
-            if (pauseRendering) {return;}
+            profiler::ScopedZone zone{"drawFrame::updateRectBatch"};
+            gui::UpdateRectBatch(*guiResource, viewport->layoutTree);
+            gui::AddFrameDamage(damageTracker, guiResource->rectBatch.damage);
+        }
+
+        // Waits for the fence and the built batch.
+        void presentFrame() {
+            if (pauseRendering) {
+                idleFrame = true;
+                return;
+            }
+
+            // the images on screen are still up to date, no acquire, record or present
+            idleFrame = !gui::HasFrameDamage(damageTracker);
+            if (idleFrame) return;
+
+            // grows the instance buffer on the submitting thread, its waitIdle cannot race a
+            // texture upload or a submit of this thread
+            gui::ReserveRectInstances(gpu, *guiResource, guiResource->rectBatch.count);
 
             auto [result, imageIndex] = windowResource->swapchainResource->swapChain->acquireNextImage(UINT64_MAX, frameResource->getCurrentPresentCompleteSemaphore(), nullptr);
             windowResource->swapchainResource->currentImageIndex = imageIndex;
             gpu.device->resetFences(*frameResource->getCurrentDrawFence());
             if (result == vk::Result::eErrorOutOfDateKHR) {
-                debug::log(debug::LogLevel::eInfo, "Recreating swapchain due to acquireNextImage failure");
+                debug::log<debug::LogLevel::eInfo, debug::LogCategory::eGpu>("Recreating swapchain due to acquireNextImage failure");
                 recreateSwapchain();
                 return;
             }
             if (result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR) {
                 throw std::runtime_error("Failed to acquire swapchain image");
             }
+            const bool fullRepaint = gui::TakeFrameDamage(damageTracker, repaintRegions) || repaintRegions.empty() || !canvas;
+            gui::UploadRectBatch(*guiResource, frameResource->currentFrameIndex);
+
             const vk::raii::CommandBuffer& cmb = frameResource->getCurrentCommandBuffer();
             cmb.reset();
-            recordCommandBuffer(cmb);
+            {
+                profiler::ScopedZone zone{"recordCommandBuffer"};
+                recordCommandBuffer(cmb, fullRepaint);
+            }
 
 
-            vk::PipelineStageFlags waitDestinationStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+            // the acquired image is first written by the canvas copy, or by the repaint without one
+            vk::PipelineStageFlags waitDestinationStageMask(canvas ? vk::PipelineStageFlagBits::eTransfer : vk::PipelineStageFlagBits::eColorAttachmentOutput);
             vk::SubmitInfo submitInfo{};
             submitInfo.setWaitSemaphoreCount(1)
                       .setPWaitSemaphores(&*frameResource->getCurrentPresentCompleteSemaphore())
@@ -362,11 +520,18 @@ export namespace ufox {
         }
 
 
-        void recordCommandBuffer(const vk::raii::CommandBuffer& cmb) const {
+        // Draws into the canvas, or into the acquired image without one. A full repaint discards
+        // the target and clears it. Otherwise the canvas still holds the last frame, only the
+        // damaged regions are cleared and drawn again. The canvas is then copied over the acquired
+        // image as a whole.
+        void recordCommandBuffer(const vk::raii::CommandBuffer& cmb, const bool fullRepaint) const {
             std::array<vk::ClearValue, 2> clearValues{};
             clearValues[0].color        = vk::ClearColorValue{0.2f, 0.2f, 0.2f,1.0f};
             clearValues[1].depthStencil = vk::ClearDepthStencilValue{0.0f, 0};
-            vk::Extent2D extent = windowResource->extent;
+            const gpu::vulkan::SwapchainResource& swapchain = *windowResource->swapchainResource;
+            const vk::Extent2D extent = swapchain.extent;
+            const vk::Image target = canvas ? **canvas->data : swapchain.getCurrentImage();
+            const vk::ImageView targetView = canvas ? **canvas->view : swapchain.getCurrentImageView();
             cmb.begin({});
             vk::ImageSubresourceRange range{};
             range.aspectMask     = vk::ImageAspectFlagBits::eColor;
@@ -374,24 +539,33 @@ export namespace ufox {
             range.levelCount     = VK_REMAINING_MIP_LEVELS;
             range.baseArrayLayer = 0;
             range.layerCount     = VK_REMAINING_ARRAY_LAYERS;
+
+            vk::Rect2D renderArea{};
+            renderArea.offset = vk::Offset2D{0, 0};
+            renderArea.extent = extent;
+
+            const std::span<const vk::Rect2D> scissors = fullRepaint ? std::span<const vk::Rect2D>(&renderArea, 1) : std::span<const vk::Rect2D>(repaintRegions);
+            if (!fullRepaint) {
+                renderArea = repaintRegions.front();
+                for (const vk::Rect2D& region : repaintRegions) renderArea = gui::UnionRect(renderArea, region);
+            }
+
+            // the canvas waits for the copy of the last frame, the acquired image for the acquire
             gpu::vulkan::TransitionImageLayout(
-                cmb, windowResource->swapchainResource->getCurrentImage(),
-                vk::PipelineStageFlagBits2::eTopOfPipe,
+                cmb, target,
+                canvas ? vk::PipelineStageFlagBits2::eTransfer : vk::PipelineStageFlagBits2::eColorAttachmentOutput,
                 vk::PipelineStageFlagBits2::eColorAttachmentOutput ,
                 {},
-                vk::AccessFlagBits2::eColorAttachmentWrite,
-                vk::ImageLayout::eUndefined,
+                fullRepaint ? vk::AccessFlagBits2::eColorAttachmentWrite : vk::AccessFlagBits2::eColorAttachmentRead | vk::AccessFlagBits2::eColorAttachmentWrite,
+                fullRepaint ? vk::ImageLayout::eUndefined : vk::ImageLayout::eTransferSrcOptimal,
                 vk::ImageLayout::eColorAttachmentOptimal,range
                 );
             vk::RenderingAttachmentInfo colorAttachment{};
-            colorAttachment.setImageView(windowResource->swapchainResource->getCurrentImageView())
+            colorAttachment.setImageView(targetView)
                            .setImageLayout(vk::ImageLayout::eColorAttachmentOptimal)
-                           .setLoadOp(vk::AttachmentLoadOp::eClear)
+                           .setLoadOp(fullRepaint ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eLoad)
                            .setStoreOp(vk::AttachmentStoreOp::eStore)
                            .setClearValue(clearValues[0]);
-            vk::Rect2D renderArea{};
-            renderArea.offset = vk::Offset2D{0, 0};
-            renderArea.extent = extent;
             vk::RenderingInfo renderingInfo{};
             renderingInfo.setRenderArea(renderArea)
                          .setLayerCount(1)
@@ -399,28 +573,41 @@ export namespace ufox {
                          .setPColorAttachments(&colorAttachment);
             cmb.beginRendering(renderingInfo);
 
+            if (!fullRepaint) {
+                std::array<vk::ClearRect, gui::DAMAGE_REGION_LIMIT> clearRects{};
+                for (size_t i = 0; i < repaintRegions.size(); ++i) clearRects[i] = vk::ClearRect{repaintRegions[i], 0, 1};
+                const vk::ClearAttachment clearAttachment{vk::ImageAspectFlagBits::eColor, 0, clearValues[0]};
+                cmb.clearAttachments(clearAttachment, vk::ArrayProxy<const vk::ClearRect>(static_cast<uint32_t>(repaintRegions.size()), clearRects.data()));
+            }
+
+            // every panel in one instanced draw per region, hover is baked into the instances
+            gui::RecordRectBatch(cmb, *guiResource, extent, frameResource->currentFrameIndex, scissors);
 
             cmb.endRendering();
 
-            vk::ClearColorValue c4 = viewport->hoveredPanel == &viewpanel4.value()? vk::ClearColorValue{0.8f, 0.8f, 0.8f, 1.0f}: viewpanel4->clearColor;
-            vk::ClearColorValue c2 = viewport->hoveredPanel == &viewpanel2.value()? vk::ClearColorValue{0.8f, 0.8f, 0.8f, 1.0f}: viewpanel2->clearColor;
-            vk::ClearColorValue c6 = viewport->hoveredPanel == &viewpanel6.value()? vk::ClearColorValue{0.8f, 0.8f, 0.8f, 1.0f}: viewpanel6->clearColor;
-            vk::ClearColorValue c7 = viewport->hoveredPanel == &viewpanel7.value()? vk::ClearColorValue{0.8f, 0.8f, 0.8f, 1.0f}: viewpanel7->clearColor;
-            vk::ClearColorValue c8 = viewport->hoveredPanel == &viewpanel8.value()? vk::ClearColorValue{0.8f, 0.8f, 0.8f, 1.0f}: viewpanel8->clearColor;
-            vk::ClearColorValue c9 = viewport->hoveredPanel == &viewpanel9.value()? vk::ClearColorValue{0.8f, 0.8f, 0.8f, 1.0f}: viewpanel9->clearColor;
-            vk::ClearColorValue c10 =viewport->hoveredPanel == &viewpanel10.value()? vk::ClearColorValue{0.8f, 0.8f, 0.8f, 1.0f}: viewpanel10->clearColor;
-            vk::ClearColorValue bbc = vk::ClearColorValue{0.8f,0.8f,0.8f,1.0f};
-            render::RenderArea(cmb, *windowResource, viewpanel2->rect, c2);
-            render::RenderArea(cmb, *windowResource, viewpanel4->rect, c4);
-            render::RenderArea(cmb, *windowResource, viewpanel6->rect, c6);
-            render::RenderArea(cmb, *windowResource, viewpanel7->rect, c7);
-            render::RenderArea(cmb, *windowResource, viewpanel8->rect, c8);
-            render::RenderArea(cmb, *windowResource, viewpanel9->rect, c9);
-            render::RenderArea(cmb, *windowResource, viewpanel10->rect, c10);
-
-
-            gpu::vulkan::TransitionImageLayout(cmb, windowResource->swapchainResource->getCurrentImage(),
-                vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::ePresentSrcKHR, range);
+            if (!canvas) {
+                gpu::vulkan::TransitionImageLayout(cmb, target, vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::ePresentSrcKHR, range);
+                cmb.end();
+                return;
+            }
+
+            gpu::vulkan::TransitionImageLayout(cmb, target,
+                vk::PipelineStageFlagBits2::eColorAttachmentOutput, vk::PipelineStageFlagBits2::eTransfer,
+                vk::AccessFlagBits2::eColorAttachmentWrite, vk::AccessFlagBits2::eTransferRead,
+                vk::ImageLayout::eColorAttachmentOptimal, vk::ImageLayout::eTransferSrcOptimal, range);
+            gpu::vulkan::TransitionImageLayout(cmb, swapchain.getCurrentImage(),
+                vk::PipelineStageFlagBits2::eTransfer, vk::PipelineStageFlagBits2::eTransfer,
+                {}, vk::AccessFlagBits2::eTransferWrite,
+                vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, range);
+
+            const vk::ImageSubresourceLayers layers{vk::ImageAspectFlagBits::eColor, 0, 0, 1};
+            const vk::ImageCopy region{layers, vk::Offset3D{0, 0, 0}, layers, vk::Offset3D{0, 0, 0}, vk::Extent3D{extent.width, extent.height, 1}};
+            cmb.copyImage(target, vk::ImageLayout::eTransferSrcOptimal, swapchain.getCurrentImage(), vk::ImageLayout::eTransferDstOptimal, region);
+
+            gpu::vulkan::TransitionImageLayout(cmb, swapchain.getCurrentImage(),
+                vk::PipelineStageFlagBits2::eTransfer, vk::PipelineStageFlagBits2::eBottomOfPipe,
+                vk::AccessFlagBits2::eTransferWrite, {},
+                vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::ePresentSrcKHR, range);
             cmb.end();
         }
 
@@ -432,6 +619,7 @@ export namespace ufox {
                 int width, height;
                 SDL_GetWindowSize(win, &width, &height);
                 app->framebufferResized = true;
+                input::RecordResize(*app->inputResource, width, height);
                 app->recreateSwapchain(width, height);
                 geometry::ResizingViewport(*app->viewport, width, height);
 
@@ -470,9 +658,22 @@ export namespace ufox {
                     case SDL_EVENT_WINDOW_RESTORED: {
                         if (pauseRendering)
                             pauseRendering = false;
+                        invalidateFrame();
 
                         break;
                     }
+                    case SDL_EVENT_WINDOW_EXPOSED: {
+                        invalidateFrame();
+                        break;
+                    }
+                    case SDL_EVENT_MOUSE_MOTION: {
+                        input::PushMouseMotion(*inputResource, event.motion.x, event.motion.y);
+                        break;
+                    }
+                    case SDL_EVENT_MOUSE_WHEEL: {
+                        input::PushMouseWheel(*inputResource, event.wheel.x, event.wheel.y);
+                        break;
+                    }
                     case SDL_EVENT_MOUSE_BUTTON_DOWN:{
                         input::MouseButton button = input::MouseButton::eNone;
                         input::ActionPhase phase = input::ActionPhase::eStart;
@@ -507,6 +708,7 @@ export namespace ufox {
         static void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
             auto app = static_cast<UFoxEngine*>(glfwGetWindowUserPointer(window));
             app->framebufferResized = true;
+            input::RecordResize(*app->inputResource, width, height);
             app->recreateSwapchain(width, height);
             geometry::ResizingViewport(*app->viewport, width, height);
             app->drawFrame();
@@ -515,6 +717,13 @@ export namespace ufox {
         static void windowIconifyCallback(GLFWwindow* window, int iconified) {
             auto app = static_cast<UFoxEngine*>(glfwGetWindowUserPointer(window));
             app->pauseRendering = iconified != GLFW_FALSE;
+            if (!app->pauseRendering) app->invalidateFrame();
+        }
+
+        // The window was exposed or damaged by the window system, what is on screen is gone.
+        static void windowRefreshCallback(GLFWwindow* window) {
+            auto app = static_cast<UFoxEngine*>(glfwGetWindowUserPointer(window));
+            if (!app->pauseRendering) app->invalidateFrame();
         }
 
         static void windowMoveCallback(GLFWwindow* window, int x, int y) {
@@ -542,6 +751,16 @@ export namespace ufox {
             input::CatchMouseButton(app->inputResource.value(), buttonType, phase, 1,0);
 
         }
+
+        static void cursorPosCallback(GLFWwindow* window, double x, double y) {
+            auto app = static_cast<UFoxEngine*>(glfwGetWindowUserPointer(window));
+            input::PushMouseMotion(app->inputResource.value(), static_cast<float>(x), static_cast<float>(y));
+        }
+
+        static void scrollCallback(GLFWwindow* window, double x, double y) {
+            auto app = static_cast<UFoxEngine*>(glfwGetWindowUserPointer(window));
+            input::PushMouseWheel(app->inputResource.value(), static_cast<float>(x), static_cast<float>(y));
+        }
 #endif
 
         gpu::vulkan::GraphicDeviceCreateInfo            gpuCreateInfo{};
@@ -549,8 +768,13 @@ export namespace ufox {
         std::optional<windowing::WindowResource>        windowResource{};
         std::optional<gpu::vulkan::FrameResource>       frameResource{};
         std::optional<input::InputResource>             inputResource{};
+        std::optional<input::InputTrace>                inputTrace{};
+        std::string                                     inputTracePath{};
         std::optional<input::StandardCursorResource>    standardCursorResource{};
         std::optional<gui::GUIResource>                 guiResource{};
+        std::optional<jobs::ThreadPool>                 jobPool{};
+        jobs::JobCounter                                assetImport{};
+        jobs::TaskGraph                                 frameGraph{};
         std::optional<ResourceManager>                  resourceManager{};
         std::optional<geometry::Viewport>               viewport{};
         std::optional<geometry::Viewpanel>              viewpanel1{};
@@ -565,7 +789,16 @@ export namespace ufox {
         std::optional<geometry::Viewpanel>              viewpanel10{};
 
 
+        static constexpr int32_t                        IDLE_WAIT_TIMEOUT_MS = 250;
+        // transfer destination for the canvas copy, dropped when the surface does not support it
+        static constexpr vk::ImageUsageFlags            SWAPCHAIN_USAGE = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst;
+        gui::DamageTracker                              damageTracker{};
+        std::vector<vk::Rect2D>                         repaintRegions{};   // of the frame being recorded
+        std::optional<gpu::vulkan::TextureImage>        canvas{};
+
         bool framebufferResized = false;
         bool pauseRendering = false;
+        bool idleFrame = false;                         // the last frame was skipped, nothing changed
+        bool assetsReady = false;
     };
 }
\ No newline at end of file
@@ -9,7 +9,15 @@ module;
 
 #include <chrono>
 #include <glm/glm.hpp>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
 #include <optional>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <numeric>
 #include <set>
 #include <vector>
 
@@ -121,20 +129,332 @@ export namespace ufox::geometry {
         return std::max(fixedBase, minVal);
     }
 
-    constexpr void ChooseRectLayoutGreaterMin(Viewpanel& panel) noexcept {
-        if (panel.isChildrenEmpty()) {
-            panel.layout.greaterMinWidth = panel.layout.minWidth;
-            panel.layout.greaterMinHeight = panel.layout.minHeight;
+    // Flag access of the arrange pass. Parallel subtrees propagate eMeasure up through shared
+    // ancestors, so the flags are updated atomically there.
+    inline LayoutDirtyFlags LoadLayoutFlags(ViewpanelLayoutTree& tree, const uint32_t index) noexcept {
+        return std::atomic_ref(tree.dirtyFlags[index]).load(std::memory_order_relaxed);
+    }
+
+    // Returns false when the panel already had every flag.
+    inline bool SetLayoutFlags(ViewpanelLayoutTree& tree, const uint32_t index, const LayoutDirtyFlags flags) noexcept {
+        std::atomic_ref ref(tree.dirtyFlags[index]);
+        LayoutDirtyFlags current = ref.load(std::memory_order_relaxed);
+        while (!HasAllFlags(current, flags)) {
+            if (ref.compare_exchange_weak(current, current | flags, std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+
+    inline void ClearLayoutFlags(ViewpanelLayoutTree& tree, const uint32_t index, const LayoutDirtyFlags flags) noexcept {
+        std::atomic_ref ref(tree.dirtyFlags[index]);
+        LayoutDirtyFlags current = ref.load(std::memory_order_relaxed);
+        while (HasAnyFlag(current, flags)) {
+            if (ref.compare_exchange_weak(current, current & ~flags, std::memory_order_relaxed)) return;
+        }
+    }
+
+    inline void MarkLayoutDirty(ViewpanelLayoutTree& tree, uint32_t index, const LayoutDirtyFlags flags) noexcept {
+        while (index != INVALID_LAYOUT_INDEX && SetLayoutFlags(tree, index, flags)) {
+            index = tree.parents[index];
+        }
+    }
+
+    constexpr bool IsLayoutExtentChanged(const int key, const uint32_t extent) noexcept {
+        return key != LAYOUT_EXTENT_UNUSED && key != static_cast<int>(extent);
+    }
+
+    // The extent is read back by the next measure pass: as alignment range of the children
+    // percent lengths and as parent reference of every child. Panels whose last measure did not
+    // read the changed extents keep their measure, so fixed-pixel subtrees stay clean on resize.
+    inline void MarkLayoutExtentDirty(ViewpanelLayoutTree& tree, const uint32_t index, const vk::Extent2D& extent) noexcept {
+        const LayoutMeasureKey& key = tree.measureKeys[index];
+        const bool rootChanged = !tree.hasParent(index) &&
+            (IsLayoutExtentChanged(key.parentWidth, extent.width) || IsLayoutExtentChanged(key.parentHeight, extent.height));
+
+        if (rootChanged || IsLayoutExtentChanged(key.alignRange, tree.isRow(index) ? extent.width : extent.height)) {
+            MarkLayoutDirty(tree, index, LayoutDirtyFlags::eMeasure);
+        }
+
+        for (uint32_t child = tree.firstChildren[index]; child != INVALID_LAYOUT_INDEX; child = tree.nextSiblings[child]) {
+            const LayoutMeasureKey& childKey = tree.measureKeys[child];
+            if (IsLayoutExtentChanged(childKey.parentWidth, extent.width) || IsLayoutExtentChanged(childKey.parentHeight, extent.height)) {
+                MarkLayoutDirty(tree, child, LayoutDirtyFlags::eMeasure);
+            }
+        }
+    }
+
+    // Returns false when the tree already holds the panel inputs, the stamps then stay and so do
+    // the arrange caches of the panel and its parent. The parent solve reads the inputs of its
+    // children, so a change bumps both stamps.
+    constexpr bool CopyViewpanelLayoutInputs(ViewpanelLayoutTree& tree, const uint32_t index, const Viewpanel& panel) noexcept {
+        const uint8_t row = panel.isRow() ? 1 : 0;
+        if (tree.rows[index] == row && tree.widths[index] == panel.width && tree.heights[index] == panel.height &&
+            tree.minWidths[index] == panel.minWidth && tree.minHeights[index] == panel.minHeight &&
+            tree.maxWidths[index] == panel.maxWidth && tree.maxHeights[index] == panel.maxHeight &&
+            tree.flexGlows[index] == panel.flexGlow && tree.flexShrinks[index] == panel.flexShrink &&
+            tree.placingOrders[index] == panel.placingOrder) {
+            return false;
+        }
+
+        tree.inputStamps[index] = ++tree.nextInputStamp;
+        if (tree.parents[index] != INVALID_LAYOUT_INDEX) tree.inputStamps[tree.parents[index]] = ++tree.nextInputStamp;
+        tree.rows[index]        = row;
+        tree.widths[index]      = panel.width;
+        tree.heights[index]     = panel.height;
+        tree.minWidths[index]   = panel.minWidth;
+        tree.minHeights[index]  = panel.minHeight;
+        tree.maxWidths[index]   = panel.maxWidth;
+        tree.maxHeights[index]  = panel.maxHeight;
+        tree.flexGlows[index]   = panel.flexGlow;
+        tree.flexShrinks[index] = panel.flexShrink;
+        tree.placingOrders[index] = panel.placingOrder;
+        return true;
+    }
+
+    // Appends the subtree of a panel to the arrays in pre-order, its root hangs from no parent.
+    inline void AppendViewpanelLayoutSubtree(ViewpanelLayoutTree& tree, Viewpanel& root) {
+        const uint32_t base = tree.size();
+        std::vector<uint32_t> lastChildren{};
+        std::vector<std::pair<Viewpanel*, uint32_t>> stack{{&root, INVALID_LAYOUT_INDEX}};
+
+        while (!stack.empty()) {
+            const auto [panel, parent] = stack.back();
+            stack.pop_back();
+
+            const uint32_t index = tree.size();
+            panel->layoutIndex = index;
+            panel->dirtyFlags  = LayoutDirtyFlags::eNone;
+
+            tree.panels.push_back(panel);
+            tree.parents.push_back(parent);
+            tree.firstChildren.push_back(INVALID_LAYOUT_INDEX);
+            tree.nextSiblings.push_back(INVALID_LAYOUT_INDEX);
+            tree.subtreeEnds.push_back(index + 1);
+            tree.childCounts.push_back(0);
+            tree.rows.push_back(0);
+            tree.widths.emplace_back();
+            tree.heights.emplace_back();
+            tree.minWidths.emplace_back();
+            tree.minHeights.emplace_back();
+            tree.maxWidths.emplace_back();
+            tree.maxHeights.emplace_back();
+            tree.flexGlows.push_back(0.0f);
+            tree.flexShrinks.push_back(0.0f);
+            tree.placingOrders.push_back(0);
+            tree.layouts.push_back(panel->layout);
+            tree.rects.push_back(panel->rect);
+            tree.dirtyFlags.push_back(LayoutDirtyFlags::eAll);
+            tree.inputStamps.push_back(0);
+            tree.measureKeys.emplace_back();
+            tree.arrangeVictims.push_back(0);
+            lastChildren.push_back(INVALID_LAYOUT_INDEX);
+
+            // a new slot always takes a fresh stamp, even when the panel holds the default inputs
+            if (!CopyViewpanelLayoutInputs(tree, index, *panel)) tree.inputStamps[index] = ++tree.nextInputStamp;
+
+            if (parent != INVALID_LAYOUT_INDEX) {
+                uint32_t& lastChild = lastChildren[parent - base];
+                if (lastChild == INVALID_LAYOUT_INDEX) tree.firstChildren[parent] = index;
+                else tree.nextSiblings[lastChild] = index;
+                lastChild = index;
+                tree.childCounts[parent]++;
+            }
+
+            for (auto it = panel->children.rbegin(); it != panel->children.rend(); ++it) {
+                if (*it) stack.emplace_back(*it, index);
+            }
+        }
+
+        // a subtree ends where the subtree of its last child ends
+        for (uint32_t i = tree.size(); i-- > base;) {
+            if (lastChildren[i - base] != INVALID_LAYOUT_INDEX) tree.subtreeEnds[i] = tree.subtreeEnds[lastChildren[i - base]];
+        }
+
+        auto slotCount = static_cast<uint32_t>(tree.arrangeSlots.size());
+        for (uint32_t i = base; i < tree.size(); ++i) {
+            tree.arrangeSlotStarts.push_back(slotCount);
+            slotCount += tree.childCounts[i] * ViewpanelLayoutTree::ARRANGE_CACHE_WAYS;
+        }
+        tree.arrangeKeys.resize(static_cast<size_t>(tree.size()) * ViewpanelLayoutTree::ARRANGE_CACHE_WAYS);
+        tree.arrangeSlots.resize(slotCount);
+    }
+
+    // Flattens the panel tree in pre-order. Only runs when the tree gets a new root, the steady
+    // state keeps every array and its capacity.
+    inline void BuildViewpanelLayoutTree(ViewpanelLayoutTree& tree, Viewpanel& root) {
+        tree.clear();
+        AppendViewpanelLayoutSubtree(tree, root);
+        tree.measureOrder.reserve(tree.size());
+    }
+
+    // Moves the entries appended from appendStart into the range [begin, end) they replace.
+    template<typename T>
+    void SpliceLayoutEntries(std::vector<T>& values, const size_t begin, const size_t end, const size_t appendStart) {
+        values.erase(values.begin() + static_cast<std::ptrdiff_t>(begin), values.begin() + static_cast<std::ptrdiff_t>(end));
+        std::rotate(values.begin() + static_cast<std::ptrdiff_t>(begin), values.begin() + static_cast<std::ptrdiff_t>(appendStart - (end - begin)), values.end());
+    }
+
+    // Re-flattens the subtree of a panel whose children changed in place of its old range. Only
+    // the parent chain and the entries behind the range shift, every other panel keeps its
+    // inputs, measure and arrange caches.
+    inline void SpliceViewpanelLayoutSubtree(ViewpanelLayoutTree& tree, const uint32_t index) {
+        constexpr uint32_t WAYS = ViewpanelLayoutTree::ARRANGE_CACHE_WAYS;
+        const uint32_t end = tree.subtreeEnds[index];
+        const uint32_t appendStart = tree.size();
+        const uint32_t slotBegin = tree.arrangeSlotStarts[index];
+        const auto slotAppendStart = static_cast<uint32_t>(tree.arrangeSlots.size());
+        const uint32_t slotEnd = end < appendStart ? tree.arrangeSlotStarts[end] : slotAppendStart;
+
+        AppendViewpanelLayoutSubtree(tree, *tree.panels[index]);
+
+        const uint32_t oldCount = end - index;
+        const uint32_t newCount = tree.size() - appendStart;
+        const auto newSlots = static_cast<uint32_t>(tree.arrangeSlots.size()) - slotAppendStart;
+        const auto shiftOld = [&](const uint32_t value) {
+            return value == INVALID_LAYOUT_INDEX || value < end ? value : value - oldCount + newCount;
+        };
+        const auto shiftNew = [&](const uint32_t value) {
+            return value == INVALID_LAYOUT_INDEX ? value : value - appendStart + index;
+        };
+
+        for (uint32_t i = tree.parents[index]; i != INVALID_LAYOUT_INDEX; i = tree.parents[i]) {
+            tree.nextSiblings[i] = shiftOld(tree.nextSiblings[i]);
+            tree.subtreeEnds[i] = shiftOld(tree.subtreeEnds[i]);
+        }
+        for (uint32_t i = end; i < appendStart; ++i) {
+            tree.parents[i] = shiftOld(tree.parents[i]);
+            tree.firstChildren[i] = shiftOld(tree.firstChildren[i]);
+            tree.nextSiblings[i] = shiftOld(tree.nextSiblings[i]);
+            tree.subtreeEnds[i] = shiftOld(tree.subtreeEnds[i]);
+            tree.arrangeSlotStarts[i] = tree.arrangeSlotStarts[i] - (slotEnd - slotBegin) + newSlots;
+        }
+        for (uint32_t i = appendStart; i < tree.size(); ++i) {
+            tree.parents[i] = shiftNew(tree.parents[i]);
+            tree.firstChildren[i] = shiftNew(tree.firstChildren[i]);
+            tree.nextSiblings[i] = shiftNew(tree.nextSiblings[i]);
+            tree.subtreeEnds[i] = shiftNew(tree.subtreeEnds[i]);
+            tree.arrangeSlotStarts[i] = tree.arrangeSlotStarts[i] - slotAppendStart + slotBegin;
+        }
+        tree.parents[appendStart] = tree.parents[index];
+        tree.nextSiblings[appendStart] = shiftOld(tree.nextSiblings[index]);
+
+        SpliceLayoutEntries(tree.panels, index, end, appendStart);
+        SpliceLayoutEntries(tree.parents, index, end, appendStart);
+        SpliceLayoutEntries(tree.firstChildren, index, end, appendStart);
+        SpliceLayoutEntries(tree.nextSiblings, index, end, appendStart);
+        SpliceLayoutEntries(tree.subtreeEnds, index, end, appendStart);
+        SpliceLayoutEntries(tree.childCounts, index, end, appendStart);
+        SpliceLayoutEntries(tree.rows, index, end, appendStart);
+        SpliceLayoutEntries(tree.widths, index, end, appendStart);
+        SpliceLayoutEntries(tree.heights, index, end, appendStart);
+        SpliceLayoutEntries(tree.minWidths, index, end, appendStart);
+        SpliceLayoutEntries(tree.minHeights, index, end, appendStart);
+        SpliceLayoutEntries(tree.maxWidths, index, end, appendStart);
+        SpliceLayoutEntries(tree.maxHeights, index, end, appendStart);
+        SpliceLayoutEntries(tree.flexGlows, index, end, appendStart);
+        SpliceLayoutEntries(tree.flexShrinks, index, end, appendStart);
+        SpliceLayoutEntries(tree.placingOrders, index, end, appendStart);
+        SpliceLayoutEntries(tree.layouts, index, end, appendStart);
+        SpliceLayoutEntries(tree.rects, index, end, appendStart);
+        SpliceLayoutEntries(tree.dirtyFlags, index, end, appendStart);
+        SpliceLayoutEntries(tree.inputStamps, index, end, appendStart);
+        SpliceLayoutEntries(tree.measureKeys, index, end, appendStart);
+        SpliceLayoutEntries(tree.arrangeVictims, index, end, appendStart);
+        SpliceLayoutEntries(tree.arrangeSlotStarts, index, end, appendStart);
+        SpliceLayoutEntries(tree.arrangeKeys, index * WAYS, end * WAYS, appendStart * WAYS);
+        SpliceLayoutEntries(tree.arrangeSlots, slotBegin, slotEnd, slotAppendStart);
+
+        for (uint32_t i = index; i < tree.size(); ++i) tree.panels[i]->layoutIndex = i;
+    }
+
+    // Splices every panel whose children changed. The walk follows the dirty paths only, a changed
+    // panel covers its whole subtree and entries of panels that moved elsewhere are skipped, their
+    // old parent drops them. Back to front keeps the indices of the pending splices valid.
+    inline void SpliceViewpanelLayoutStructure(ViewpanelLayoutTree& tree) {
+        std::vector<uint32_t> changed{};
+
+        for (uint32_t i = 0; i < tree.size();) {
+            const Viewpanel& panel = *tree.panels[i];
+            const bool moved = tree.hasParent(i) && panel.parent != tree.panels[tree.parents[i]];
+
+            if (moved || (tree.dirtyFlags[i] | panel.dirtyFlags) == LayoutDirtyFlags::eNone) {
+                i = tree.subtreeEnds[i];
+                continue;
+            }
+
+            if (HasAnyFlag(panel.dirtyFlags, LayoutDirtyFlags::eStructure)) {
+                changed.push_back(i);
+                i = tree.subtreeEnds[i];
+                continue;
+            }
+
+            ++i;
+        }
+
+        for (auto it = changed.rbegin(); it != changed.rend(); ++it) {
+            SpliceViewpanelLayoutSubtree(tree, *it);
+        }
+    }
+
+    // Explicit invalidation for changes the caches cannot see, e.g. an edit of the tree arrays that
+    // bypassed the panel handles. The next pass re-measures and re-solves every panel.
+    inline void InvalidateLayoutCache(ViewpanelLayoutTree& tree, const uint32_t index) noexcept {
+        const auto ways = tree.arrangeKeys.begin() + static_cast<std::ptrdiff_t>(index * ViewpanelLayoutTree::ARRANGE_CACHE_WAYS);
+        std::fill_n(ways, ViewpanelLayoutTree::ARRANGE_CACHE_WAYS, LayoutArrangeKey{});
+        MarkLayoutDirty(tree, index, LayoutDirtyFlags::eAll);
+    }
+
+    inline void InvalidateLayoutCache(ViewpanelLayoutTree& tree) noexcept {
+        std::ranges::fill(tree.arrangeKeys, LayoutArrangeKey{});
+        std::ranges::fill(tree.dirtyFlags, LayoutDirtyFlags::eAll);
+    }
+
+    // Pulls the pending handle edits into the tree and collects the panels to measure. Clean
+    // subtrees are skipped as a whole, a structural edit re-flattens the edited subtree only.
+    // Ancestors flagged by propagation only re-measure, the inputs are copied for the edited
+    // panels alone.
+    inline void SyncViewpanelLayoutTree(ViewpanelLayoutTree& tree, Viewpanel& root) {
+        if (tree.root() != &root) BuildViewpanelLayoutTree(tree, root);
+        else if (HasAnyFlag(root.dirtyFlags, LayoutDirtyFlags::eAll)) SpliceViewpanelLayoutStructure(tree);
+
+        tree.measureOrder.clear();
+
+        for (uint32_t i = 0; i < tree.size();) {
+            Viewpanel& panel = *tree.panels[i];
+            const LayoutDirtyFlags pending = panel.dirtyFlags;
+            const LayoutDirtyFlags flags = tree.dirtyFlags[i] | pending;
+
+            if (flags == LayoutDirtyFlags::eNone) {
+                i = tree.subtreeEnds[i];
+                continue;
+            }
+
+            if (HasAnyFlag(pending, LayoutDirtyFlags::eInputs)) CopyViewpanelLayoutInputs(tree, i, panel);
+            panel.dirtyFlags = LayoutDirtyFlags::eNone;
+
+            tree.dirtyFlags[i] = flags & LayoutDirtyFlags::eAll;
+            if (HasAnyFlag(flags, LayoutDirtyFlags::eMeasure)) tree.measureOrder.push_back(i);
+            ++i;
+        }
+    }
+
+    // Aggregates the greater min of the direct children. The children must be measured already,
+    // AccumulateRectLayoutStepBaseLength guarantees it by measuring bottom-up.
+    constexpr void ChooseRectLayoutGreaterMin(ViewpanelLayoutTree& tree, const uint32_t index) noexcept {
+        RectLayout& layout = tree.layouts[index];
+
+        if (tree.childCounts[index] == 0) {
+            layout.greaterMinWidth = layout.minWidth;
+            layout.greaterMinHeight = layout.minHeight;
             return;
         }
 
-        const bool isRow = panel.isRow();
+        const bool isRow = tree.isRow(index);
         int accumulatedWidth = 0;
         int accumulatedHeight = 0;
 
-        for (const auto& child : panel.children) {
-            ChooseRectLayoutGreaterMin(*child);
-            const auto& childLayout = child->layout;
+        for (uint32_t child = tree.firstChildren[index]; child != INVALID_LAYOUT_INDEX; child = tree.nextSiblings[child]) {
+            const auto& childLayout = tree.layouts[child];
 
             if (isRow) {
                 accumulatedWidth += childLayout.greaterMinWidth;
@@ -145,237 +465,826 @@ export namespace ufox::geometry {
             }
         }
 
-        panel.layout.greaterMinWidth = std::max(accumulatedWidth, panel.layout.minWidth);
-        panel.layout.greaterMinHeight = std::max(accumulatedHeight, panel.layout.minHeight);
+        layout.greaterMinWidth = std::max(accumulatedWidth, layout.minWidth);
+        layout.greaterMinHeight = std::max(accumulatedHeight, layout.minHeight);
+    }
+
+    // Measures the panels collected by SyncViewpanelLayoutTree. Walking the pre-order backwards
+    // visits children before parents, clean children contribute their cached child base.
+    constexpr void AccumulateRectLayoutStepBaseLength(ViewpanelLayoutTree& tree) noexcept {
+        profiler::ScopedZone zone{"AccumulateRectLayoutStepBaseLength"};
+        profiler::AddCounter(profiler::Counter::ePanelsMeasured, tree.measureOrder.size());
+
+        for (auto it = tree.measureOrder.rbegin(); it != tree.measureOrder.rend(); ++it) {
+            const uint32_t i = *it;
+            const uint32_t parent = tree.parents[i];
+            const vk::Extent2D& parentExtent = tree.hasParent(i) ? tree.rects[parent].extent : tree.rects[i].extent;
+            const int pW = static_cast<int>(parentExtent.width);
+            const int pH = static_cast<int>(parentExtent.height);
+            const int alignRange = static_cast<int>(tree.isRow(i) ? tree.rects[i].extent.width : tree.rects[i].extent.height);
+
+            RectLayout& layout = tree.layouts[i];
+            const RectLayout previousLayout = layout;
+
+            int baseWidthLength = 0;
+            int baseHeightLength = 0;
+            bool readsAlignRange = false;
+
+            for (uint32_t child = tree.firstChildren[i]; child != INVALID_LAYOUT_INDEX; child = tree.nextSiblings[child]) {
+                baseWidthLength += CalculateSegmentLength(tree.widths[child], tree.layouts[child].childBaseWidth, alignRange);
+                baseHeightLength += CalculateSegmentLength(tree.heights[child], tree.layouts[child].childBaseHeight, alignRange);
+                readsAlignRange |= tree.widths[child].isPercent() || tree.heights[child].isPercent();
+            }
+
+            layout.childBaseWidth = baseWidthLength;
+            layout.childBaseHeight = baseHeightLength;
+            layout.baseWidth = ReadLengthValue(tree.widths[i], pW, baseWidthLength);
+            layout.baseHeight = ReadLengthValue(tree.heights[i], pH, baseHeightLength);
+
+            const float invFlexShrink = mathf::InvertRatio(tree.flexShrinks[i]);
+
+            layout.minWidth = CalculateConstrainedSize(layout.baseWidth, tree.minWidths[i], pW, invFlexShrink);
+            layout.minHeight = CalculateConstrainedSize(layout.baseHeight, tree.minHeights[i], pH, invFlexShrink);
+
+            ChooseRectLayoutGreaterMin(tree, i);
+            tree.measureKeys[i] = LayoutMeasureKey{
+                tree.widths[i].isPercent() || tree.minWidths[i].isPercent() ? pW : LAYOUT_EXTENT_UNUSED,
+                tree.heights[i].isPercent() || tree.minHeights[i].isPercent() ? pH : LAYOUT_EXTENT_UNUSED,
+                readsAlignRange ? alignRange : LAYOUT_EXTENT_UNUSED};
+            tree.dirtyFlags[i] = tree.dirtyFlags[i] & ~LayoutDirtyFlags::eMeasure;
+            tree.panels[i]->layout = layout;
 
+            // the parent distributes its length from our measure, it has to re-place its children
+            if (tree.hasParent(i) && layout != previousLayout) {
+                MarkLayoutDirty(tree, parent, LayoutDirtyFlags::eArrange);
+            }
+        }
+
+        tree.measureOrder.clear();
     }
 
-    constexpr std::pair<int, int> AccumulateRectLayoutStepBaseLength(Viewpanel& panel) noexcept {
-        const int pW = static_cast<int>(panel.hasParent() ? panel.parent->rect.extent.width : panel.rect.extent.width);
-        const int pH = static_cast<int>(panel.hasParent() ? panel.parent->rect.extent.height : panel.rect.extent.height);
-        const int alignRange = GetPanelAlignLength(panel);
+    // Priority order of a solve: ascending key, ties keep child order so the result is deterministic.
+    inline void SortDiscadeltaPriority(DiscadeltaContext& ctx) {
+        ctx.priorityIndices.resize(ctx.size());
+        std::iota(ctx.priorityIndices.begin(), ctx.priorityIndices.end(), 0u);
+        std::ranges::sort(ctx.priorityIndices, [&keys = ctx.priorityKeys](const uint32_t a, const uint32_t b) {
+            return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+        });
+    }
 
-        int baseWidthLength = 0;
-        int baseHeightLength = 0;
+    constexpr DiscadeltaContext MakeDiscadeltaContext(const ViewpanelLayoutTree& tree, const uint32_t index, std::pmr::memory_resource* resource) {
+        const size_t childCount = tree.childCounts[index];
+        const bool isRow = tree.isRow(index);
+        const vk::Rect2D& rect = tree.rects[index];
+        const int relativeLength = static_cast<int>(isRow ? rect.extent.width : rect.extent.height);
+        DiscadeltaContext ctx(relativeLength, isRow ? rect.offset.x : rect.offset.y, childCount, resource);
+
+        for (uint32_t child = tree.firstChildren[index]; child != INVALID_LAYOUT_INDEX; child = tree.nextSiblings[child]) {
+            const RectLayout& childLayout = tree.layouts[child];
+            const Length& maxLength = isRow? tree.maxWidths[child]: tree.maxHeights[child];
+            const int baseLength = isRow? childLayout.baseWidth: childLayout.baseHeight;
+            const int alignMin = isRow? childLayout.greaterMinWidth: childLayout.greaterMinHeight;
+            const int greaterMax = std::max(alignMin, baseLength);
 
-        for (const auto& child : panel.children) {
-            if (!child) continue;
-            const auto [childW, childH] = AccumulateRectLayoutStepBaseLength(*child);
+            const int alignMax = ReadLengthValue(maxLength, relativeLength, greaterMax);
+            const int finalBaseLength = mathf::Clamp(baseLength, alignMin, alignMax);
+            const int solidify = std::min(finalBaseLength, mathf::MulToInt(finalBaseLength, mathf::InvertRatio(tree.flexShrinks[child])));
+            const int glowMax = maxLength.hasUnit() ? ReadLengthValue(maxLength, relativeLength, 0) : std::numeric_limits<int>::max();
+
+            ctx.baseLengths.push_back(finalBaseLength);
+            ctx.glowLengths.push_back(0);
+            ctx.offsets.push_back(0);
+            ctx.solidifies.push_back(solidify);
+            ctx.capacities.push_back(finalBaseLength - solidify);
+            ctx.mins.push_back(alignMin);
+            ctx.glowRooms.push_back(maxLength.hasUnit() ? std::max(0, glowMax - finalBaseLength) : glowMax);
+            ctx.glowRatios.push_back(std::max(0.0f, tree.flexGlows[child]));
+            ctx.placingOrders.push_back(tree.placingOrders[child]);
+
+            ctx.accumulateBaseLength += finalBaseLength;
+            ctx.accumulateSolidify += solidify;
+            ctx.accumulateCapacity += finalBaseLength - solidify;
+            ctx.accumulateGlowRatio += ctx.glowRatios.back();
+            ctx.hasPlacingOrder |= tree.placingOrders[child] != 0;
+        }
 
-            baseWidthLength += CalculateSegmentLength(child->width, childW, alignRange);
-            baseHeightLength += CalculateSegmentLength(child->height, childH, alignRange);
+        return ctx;
+    }
+
+    // Single pass compression. Children are visited by ascending tolerance (base - min) / capacity,
+    // the ones clamped at their min first, so what they could not give up is taken from the
+    // remaining ones. The last compressible child receives the exact remainder.
+    inline void DiscadeltaCompressing(DiscadeltaContext& ctx) {
+        const size_t count = ctx.size();
+        ctx.priorityKeys.resize(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            const int greaterMin = std::max(ctx.solidifies[i], ctx.mins[i]);
+            ctx.priorityKeys[i] = ctx.capacities[i] <= 0 ? std::numeric_limits<float>::max()
+                : mathf::Divide(std::max(0, ctx.baseLengths[i] - greaterMin), ctx.capacities[i]);
         }
 
-        panel.layout.baseWidth = ReadLengthValue(panel.width, pW, baseWidthLength);
-        panel.layout.baseHeight = ReadLengthValue(panel.height, pH, baseHeightLength);
+        SortDiscadeltaPriority(ctx);
+
+        int remainLength = std::max(0, ctx.inputLength);
+        int remainSolidify = ctx.accumulateSolidify;
+        int remainCapacity = ctx.accumulateCapacity;
 
-        const float invFlexShrink = mathf::InvertRatio(panel.flexShrink);
+        for (const uint32_t i : ctx.priorityIndices) {
+            const int capacity = ctx.capacities[i];
+            const int shareable = remainLength - remainSolidify;
+            const int share = shareable <= 0 || capacity <= 0 || remainCapacity <= 0 ? 0
+                : static_cast<int>(static_cast<int64_t>(shareable) * capacity / remainCapacity);
 
-        panel.layout.minWidth = CalculateConstrainedSize(panel.layout.baseWidth, panel.minWidth, pW, invFlexShrink);
-        panel.layout.minHeight = CalculateConstrainedSize(panel.layout.baseHeight , panel.minHeight, pH, invFlexShrink);
+            const int length = std::max(ctx.solidifies[i] + share, ctx.mins[i]);
+            ctx.baseLengths[i] = length;
 
-        ChooseRectLayoutGreaterMin(panel);
-        return {baseWidthLength, baseHeightLength};
+            remainLength -= length;
+            remainSolidify -= ctx.solidifies[i];
+            remainCapacity -= capacity;
+        }
     }
 
-    constexpr void ComputeDiscadeltaBase(DiscadeltaBaseFiller& filler, const size_t& currentStep) noexcept {
-        const int& reduceDistance = filler.reduceDistances[currentStep];
-        const int& min = filler.mins[currentStep];
-        const float& stepRatio = filler.stepRatios[currentStep];
-        int& remainLength = filler.remainLength;
-        float& remainStepRatio = filler.accumulateStepRatio;
-        int& accumulateOffset = filler.accumulateOffset;
-        int& baseLength = *filler.lengths[currentStep];
-        const int endLength = remainLength - accumulateOffset;
-        const int flexLength = (remainLength <= 0? 0 + reduceDistance :mathf::MulToInt(mathf::Divide(endLength, remainStepRatio), stepRatio)) + reduceDistance;
+    // Single pass expansion. Children are visited by ascending room / flexGlow, the ones clamped
+    // at their max first, so their overflow flows to the remaining ones. The last growing child
+    // receives the exact remainder.
+    inline void DiscadeltaExpanding(DiscadeltaContext& ctx) {
+        int remainGlow = ctx.inputLength - ctx.accumulateBaseLength;
+        if (remainGlow <= 0) return;
+
+        const size_t count = ctx.size();
+        ctx.priorityKeys.resize(count);
+        size_t remainGrowers = 0;
+
+        for (size_t i = 0; i < count; ++i) {
+            const float ratio = ctx.glowRatios[i];
+            ctx.priorityKeys[i] = ratio <= 0.0f ? std::numeric_limits<float>::max() : static_cast<float>(ctx.glowRooms[i]) / ratio;
+            if (ratio > 0.0f) ++remainGrowers;
+        }
+
+        SortDiscadeltaPriority(ctx);
+
+        float remainRatio = ctx.accumulateGlowRatio;
 
-        baseLength = std::max(flexLength , min);
+        for (const uint32_t i : ctx.priorityIndices) {
+            const float ratio = ctx.glowRatios[i];
+            if (ratio <= 0.0f || remainGlow <= 0) break;
 
-        accumulateOffset -= reduceDistance;
-        remainLength -= baseLength;
-        remainStepRatio -= stepRatio;
+            const int flex = remainGrowers == 1 ? remainGlow
+                : mathf::Clamp(mathf::MulToInt(mathf::Divide(remainGlow, remainRatio), ratio), 0, remainGlow);
+            const int glow = std::min(flex, ctx.glowRooms[i]);
+            ctx.glowLengths[i] = glow;
+
+            remainGlow -= glow;
+            remainRatio -= ratio;
+            --remainGrowers;
+        }
     }
 
-    constexpr void RedistributeDiscadeltaRemainGlow(const DiscadeltaGlowFiller& filler) noexcept {
-        int   remainGlow     = filler.remainLength;
-        int   accumulated    = 0;
-        float remainRatio    = filler.accumulateStepRatio;
+    // Resolves child offsets. Without placingOrder overrides children are placed in child order,
+    // otherwise by a stable sort on the order.
+    inline void DiscadeltaPlacing(DiscadeltaContext& ctx) {
+        const size_t count = ctx.size();
+        int offset = ctx.accumulateOffset;
 
-        DiscadeltaGlowFiller nextFiller{};
+        if (!ctx.hasPlacingOrder) {
+            for (size_t i = 0; i < count; ++i) {
+                ctx.offsets[i] = offset;
+                offset += std::max(0, ctx.baseLengths[i] + ctx.glowLengths[i]);
+            }
+            return;
+        }
 
-        for (size_t i = 0; i < filler.lengths.size(); ++i) {
-            int&  length     = *filler.lengths[i];
-            const float ratio = filler.stepRatios[i];
-            const int   max   = filler.maxs[i];
+        ctx.priorityIndices.resize(count);
+        std::iota(ctx.priorityIndices.begin(), ctx.priorityIndices.end(), 0u);
+        std::ranges::stable_sort(ctx.priorityIndices, [&orders = ctx.placingOrders](const uint32_t a, const uint32_t b) {
+            return orders[a] < orders[b];
+        });
 
-            const int flex = remainGlow <= 0 ? 0
-                : mathf::MulToInt(mathf::Divide(remainGlow, remainRatio), ratio);
+        for (const uint32_t i : ctx.priorityIndices) {
+            ctx.offsets[i] = offset;
+            offset += std::max(0, ctx.baseLengths[i] + ctx.glowLengths[i]);
+        }
+    }
 
-            const int overflow = std::max(0, flex - max);
-            const int used     = flex - overflow;
-            length += used;
+    inline void SolveDiscadelta(DiscadeltaContext& ctx) {
+        if (ctx.inputLength < ctx.accumulateBaseLength) DiscadeltaCompressing(ctx);
+        else DiscadeltaExpanding(ctx);
 
-            if (overflow <= 0) {
-                nextFiller.accumulateStepRatio += ratio;
-                nextFiller.lengths.push_back(&length);
-                nextFiller.maxs.push_back(max);
-                nextFiller.stepRatios.push_back(ratio);
+        DiscadeltaPlacing(ctx);
+    }
+
+    constexpr float DiscadeltaScaler(const float& distance, const float& accumulateFactor, const float& factor) noexcept {
+        return distance <= 0.0f || accumulateFactor <= 0.0f || factor <= 0.0f ? 0.0f : distance / accumulateFactor * factor;
+    }
+
+    constexpr size_t DISCADELTA_BATCH_RANK_COUNTING_LIMIT = 32;
+
+    // Validates the problems [begin, begin + count) and permutes their segments into the priority
+    // order of their mode: compressing problems by ascending (base - min) / capacity, expanding
+    // ones by ascending room / expandRatio, ties keep segment order. Short segment lists are
+    // ranked by branchless counting across the tile instead of a per problem sort.
+    inline void PrepareDiscadeltaBatchTile(DiscadeltaBatch& batch, const size_t begin, const size_t count) {
+        const size_t segmentCount = batch.segmentCount;
+
+        std::fill_n(batch.accumulateBases.begin(), count, 0.0f);
+        std::fill_n(batch.accumulateSolidifies.begin(), count, 0.0f);
+        std::fill_n(batch.accumulateExpandRatios.begin(), count, 0.0f);
+
+        for (size_t r = 0; r < segmentCount; ++r) {
+            for (size_t q = 0; q < count; ++q) {
+                const size_t i = batch.at(r, begin + q);
+                const size_t t = DiscadeltaBatch::tileAt(r, q);
+                const float min = std::max(0.0f, batch.mins[i]);
+                const float max = std::max(min, batch.maxs[i]);
+                const float base = std::clamp(batch.bases[i], min, max);
+                const float capacity = base * std::max(0.0f, batch.compressRatios[i]);
+                const float solidify = std::max(0.0f, base - capacity);
+                const float expandRatio = std::max(0.0f, batch.expandRatios[i]);
+
+                batch.validatedBases[t] = base;
+                batch.validatedCapacities[t] = capacity;
+                batch.validatedSolidifies[t] = solidify;
+                batch.validatedMins[t] = min;
+                batch.validatedMaxDeltas[t] = std::max(0.0f, max - base);
+                batch.validatedExpandRatios[t] = expandRatio;
+
+                batch.accumulateBases[q] += base;
+                batch.accumulateSolidifies[q] += solidify;
+                batch.accumulateExpandRatios[q] += expandRatio;
             }
+        }
 
-            remainGlow   -= flex;
-            accumulated  += used;
-            remainRatio  -= ratio;
+        for (size_t q = 0; q < count; ++q) {
+            const float input = std::max(0.0f, batch.inputDistances[begin + q]);
+            batch.validatedInputs[q] = input;
+            batch.compressMasks[q] = input < batch.accumulateBases[q] ? ~0u : 0u;
         }
 
-        nextFiller.remainLength = std::max(0, filler.remainLength - accumulated);
+        for (size_t r = 0; r < segmentCount; ++r) {
+            for (size_t q = 0; q < count; ++q) {
+                const size_t t = DiscadeltaBatch::tileAt(r, q);
+                const float capacity = batch.validatedCapacities[t];
+                const float expandRatio = batch.validatedExpandRatios[t];
+                const float greaterMin = std::max(batch.validatedSolidifies[t], batch.validatedMins[t]);
+                const float compressKey = capacity <= 0.0f ? std::numeric_limits<float>::max() : std::max(0.0f, batch.validatedBases[t] - greaterMin) / capacity;
+                const float expandKey = expandRatio <= 0.0f ? std::numeric_limits<float>::max() : batch.validatedMaxDeltas[t] / expandRatio;
+                batch.priorityKeys[t] = batch.compressMasks[q] ? compressKey : expandKey;
+            }
+        }
+
+        if (segmentCount <= DISCADELTA_BATCH_RANK_COUNTING_LIMIT) {
+            for (size_t r = 0; r < segmentCount; ++r) {
+                const float* keys = &batch.priorityKeys[DiscadeltaBatch::tileAt(r, 0)];
+                uint32_t* ranks = &batch.priorityRanks[DiscadeltaBatch::tileAt(r, 0)];
+                std::fill_n(ranks, count, 0u);
+
+                for (size_t s = 0; s < segmentCount; ++s) {
+                    const float* other = &batch.priorityKeys[DiscadeltaBatch::tileAt(s, 0)];
+                    if (s < r) for (size_t q = 0; q < count; ++q) ranks[q] += other[q] <= keys[q] ? 1u : 0u;
+                    else if (s > r) for (size_t q = 0; q < count; ++q) ranks[q] += other[q] < keys[q] ? 1u : 0u;
+                }
+            }
+        } else {
+            auto& keys = batch.segmentKeys;
+            auto& order = batch.segmentOrder;
+
+            for (size_t q = 0; q < count; ++q) {
+                for (size_t r = 0; r < segmentCount; ++r) {
+                    keys[r] = batch.priorityKeys[DiscadeltaBatch::tileAt(r, q)];
+                    order[r] = static_cast<uint32_t>(r);
+                }
+
+                std::ranges::stable_sort(order, [&keys](const uint32_t a, const uint32_t b) { return keys[a] < keys[b]; });
 
-        if (nextFiller.remainLength > 0 && !nextFiller.lengths.empty()) {
-            RedistributeDiscadeltaRemainGlow(nextFiller);
+                for (size_t rank = 0; rank < segmentCount; ++rank) {
+                    batch.priorityRanks[DiscadeltaBatch::tileAt(order[rank], q)] = static_cast<uint32_t>(rank);
+                }
+            }
+        }
+
+        for (size_t r = 0; r < segmentCount; ++r) {
+            for (size_t q = 0; q < count; ++q) {
+                const size_t t = DiscadeltaBatch::tileAt(r, q);
+                const size_t j = DiscadeltaBatch::tileAt(batch.priorityRanks[t], q);
+                batch.priorityBases[j] = batch.validatedBases[t];
+                batch.priorityCapacities[j] = batch.validatedCapacities[t];
+                batch.prioritySolidifies[j] = batch.validatedSolidifies[t];
+                batch.priorityMins[j] = batch.validatedMins[t];
+                batch.priorityMaxDeltas[j] = batch.validatedMaxDeltas[t];
+                batch.priorityExpandRatios[j] = batch.validatedExpandRatios[t];
+            }
         }
     }
 
-    constexpr DiscadeltaContext MakeDiscadeltaContext(const Viewpanel& viewpanel) {
-        const size_t childCount = viewpanel.childCount();
-        DiscadeltaContext discadeltaCtx(GetPanelAlignOffset(viewpanel),childCount);
-        DiscadeltaBaseFiller baseFiller(childCount);
+    // Reference cascade over the tile problems [begin, end), one problem at a time. The vector
+    // kernels below evaluate the same operations in the same order per lane, so their results
+    // are bit-identical.
+    inline void SolveDiscadeltaBatchScalar(DiscadeltaBatch& batch, const size_t begin, const size_t end) noexcept {
+        for (size_t q = begin; q < end; ++q) {
+            if (batch.compressMasks[q]) {
+                float cascadeDistance = batch.validatedInputs[q];
+                float cascadeBase = batch.accumulateBases[q];
+                float cascadeSolidify = batch.accumulateSolidifies[q];
+
+                for (size_t r = 0; r < batch.segmentCount; ++r) {
+                    const size_t t = DiscadeltaBatch::tileAt(r, q);
+                    const float remainDistance = cascadeDistance - cascadeSolidify;
+                    const float remainCapacity = cascadeBase - cascadeSolidify;
+                    const float solidify = batch.prioritySolidifies[t];
+                    const float distance = DiscadeltaScaler(remainDistance, remainCapacity, batch.priorityCapacities[t]) + solidify;
+                    const float clamped = std::max(distance, batch.priorityMins[t]);
+
+                    batch.priorityDistances[t] = clamped;
+                    cascadeDistance -= clamped;
+                    cascadeSolidify -= solidify;
+                    cascadeBase -= batch.priorityBases[t];
+                }
+            } else {
+                float cascadeDelta = std::max(batch.validatedInputs[q] - batch.accumulateBases[q], 0.0f);
+                float cascadeRatio = batch.accumulateExpandRatios[q];
 
-        const int relativeLength = GetPanelAlignLength(viewpanel);
-        int absoluteBaseLength{0};
-        float remainSumsFlexGlow{0.0f};
+                for (size_t r = 0; r < batch.segmentCount; ++r) {
+                    const size_t t = DiscadeltaBatch::tileAt(r, q);
+                    const float ratio = batch.priorityExpandRatios[t];
+                    const float delta = std::min(DiscadeltaScaler(cascadeDelta, cascadeRatio, ratio), batch.priorityMaxDeltas[t]);
 
-        for (size_t i = 0; i < childCount; i++) {
-            const auto child = viewpanel.getChild(i);
-            if (child == nullptr)
-                continue;
+                    batch.priorityDistances[t] = batch.priorityBases[t] + delta;
+                    cascadeDelta -= delta;
+                    cascadeRatio -= ratio;
+                }
+            }
+        }
+    }
 
-            const int baseLength = viewpanel.isRow()? child->layout.baseWidth: child->layout.baseHeight;
-            const int alignMin = viewpanel.isRow()? child->layout.greaterMinWidth: child->layout.greaterMinHeight;
-            const int greaterMax = std::max(alignMin, baseLength);
+#if defined(__AVX2__)
+    inline constexpr auto DISCADELTA_BATCH_KERNEL = "avx2";
+    inline constexpr size_t DISCADELTA_BATCH_LANES = 8;
+
+    // Both cascades run on every lane, the problem mode selects the result. Selects mirror
+    // std::max(a, b) = a < b ? b : a and std::min(a, b) = b < a ? b : a.
+    inline size_t SolveDiscadeltaBatchVector(DiscadeltaBatch& batch, const size_t count) noexcept {
+        const size_t vectorEnd = count - count % DISCADELTA_BATCH_LANES;
+        const __m256 zero = _mm256_setzero_ps();
+
+        const auto scaler = [zero](const __m256 distance, const __m256 accumulate, const __m256 factor) {
+            const __m256 valid = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(distance, zero, _CMP_NLE_UQ),
+                _mm256_cmp_ps(accumulate, zero, _CMP_NLE_UQ)), _mm256_cmp_ps(factor, zero, _CMP_NLE_UQ));
+            return _mm256_and_ps(valid, _mm256_mul_ps(_mm256_div_ps(distance, accumulate), factor));
+        };
+
+        for (size_t q = 0; q < vectorEnd; q += DISCADELTA_BATCH_LANES) {
+            const __m256 compress = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(&batch.compressMasks[q])));
+            const __m256 input = _mm256_loadu_ps(&batch.validatedInputs[q]);
+            const __m256 accumulateBase = _mm256_loadu_ps(&batch.accumulateBases[q]);
+
+            __m256 cascadeDistance = input;
+            __m256 cascadeBase = accumulateBase;
+            __m256 cascadeSolidify = _mm256_loadu_ps(&batch.accumulateSolidifies[q]);
+            const __m256 expandDelta = _mm256_sub_ps(input, accumulateBase);
+            __m256 cascadeDelta = _mm256_blendv_ps(expandDelta, zero, _mm256_cmp_ps(expandDelta, zero, _CMP_LT_OQ));
+            __m256 cascadeRatio = _mm256_loadu_ps(&batch.accumulateExpandRatios[q]);
+
+            for (size_t r = 0; r < batch.segmentCount; ++r) {
+                const size_t t = DiscadeltaBatch::tileAt(r, q);
+                const __m256 base = _mm256_loadu_ps(&batch.priorityBases[t]);
+                const __m256 solidify = _mm256_loadu_ps(&batch.prioritySolidifies[t]);
+                const __m256 min = _mm256_loadu_ps(&batch.priorityMins[t]);
+                const __m256 maxDelta = _mm256_loadu_ps(&batch.priorityMaxDeltas[t]);
+                const __m256 ratio = _mm256_loadu_ps(&batch.priorityExpandRatios[t]);
+
+                const __m256 remainDistance = _mm256_sub_ps(cascadeDistance, cascadeSolidify);
+                const __m256 remainCapacity = _mm256_sub_ps(cascadeBase, cascadeSolidify);
+                const __m256 compressed = _mm256_add_ps(scaler(remainDistance, remainCapacity, _mm256_loadu_ps(&batch.priorityCapacities[t])), solidify);
+                const __m256 clamped = _mm256_blendv_ps(compressed, min, _mm256_cmp_ps(compressed, min, _CMP_LT_OQ));
+
+                const __m256 scaled = scaler(cascadeDelta, cascadeRatio, ratio);
+                const __m256 delta = _mm256_blendv_ps(scaled, maxDelta, _mm256_cmp_ps(maxDelta, scaled, _CMP_LT_OQ));
+
+                _mm256_storeu_ps(&batch.priorityDistances[t], _mm256_blendv_ps(_mm256_add_ps(base, delta), clamped, compress));
+
+                cascadeDistance = _mm256_sub_ps(cascadeDistance, clamped);
+                cascadeSolidify = _mm256_sub_ps(cascadeSolidify, solidify);
+                cascadeBase = _mm256_sub_ps(cascadeBase, base);
+                cascadeDelta = _mm256_sub_ps(cascadeDelta, delta);
+                cascadeRatio = _mm256_sub_ps(cascadeRatio, ratio);
+            }
+        }
 
-            const int alignMax = viewpanel.isRow()? ReadLengthValue(child->maxWidth, relativeLength, greaterMax): ReadLengthValue(child->maxHeight, relativeLength, greaterMax);
-            int finalBaseLength = mathf::Clamp(baseLength, alignMin, alignMax);
-            absoluteBaseLength += finalBaseLength;
+        return vectorEnd;
+    }
+#elif defined(__SSE2__) || defined(_M_X64)
+    inline constexpr auto DISCADELTA_BATCH_KERNEL = "sse2";
+    inline constexpr size_t DISCADELTA_BATCH_LANES = 4;
+
+    // Both cascades run on every lane, the problem mode selects the result. Selects mirror
+    // std::max(a, b) = a < b ? b : a and std::min(a, b) = b < a ? b : a.
+    inline size_t SolveDiscadeltaBatchVector(DiscadeltaBatch& batch, const size_t count) noexcept {
+        const size_t vectorEnd = count - count % DISCADELTA_BATCH_LANES;
+        const __m128 zero = _mm_setzero_ps();
+
+        const auto select = [](const __m128 mask, const __m128 a, const __m128 b) {
+            return _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, a));
+        };
+
+        const auto scaler = [zero](const __m128 distance, const __m128 accumulate, const __m128 factor) {
+            const __m128 valid = _mm_and_ps(_mm_and_ps(_mm_cmpnle_ps(distance, zero), _mm_cmpnle_ps(accumulate, zero)), _mm_cmpnle_ps(factor, zero));
+            return _mm_and_ps(valid, _mm_mul_ps(_mm_div_ps(distance, accumulate), factor));
+        };
+
+        for (size_t q = 0; q < vectorEnd; q += DISCADELTA_BATCH_LANES) {
+            const __m128 compress = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&batch.compressMasks[q])));
+            const __m128 input = _mm_loadu_ps(&batch.validatedInputs[q]);
+            const __m128 accumulateBase = _mm_loadu_ps(&batch.accumulateBases[q]);
+
+            __m128 cascadeDistance = input;
+            __m128 cascadeBase = accumulateBase;
+            __m128 cascadeSolidify = _mm_loadu_ps(&batch.accumulateSolidifies[q]);
+            const __m128 expandDelta = _mm_sub_ps(input, accumulateBase);
+            __m128 cascadeDelta = select(_mm_cmplt_ps(expandDelta, zero), expandDelta, zero);
+            __m128 cascadeRatio = _mm_loadu_ps(&batch.accumulateExpandRatios[q]);
+
+            for (size_t r = 0; r < batch.segmentCount; ++r) {
+                const size_t t = DiscadeltaBatch::tileAt(r, q);
+                const __m128 base = _mm_loadu_ps(&batch.priorityBases[t]);
+                const __m128 solidify = _mm_loadu_ps(&batch.prioritySolidifies[t]);
+                const __m128 min = _mm_loadu_ps(&batch.priorityMins[t]);
+                const __m128 maxDelta = _mm_loadu_ps(&batch.priorityMaxDeltas[t]);
+                const __m128 ratio = _mm_loadu_ps(&batch.priorityExpandRatios[t]);
+
+                const __m128 remainDistance = _mm_sub_ps(cascadeDistance, cascadeSolidify);
+                const __m128 remainCapacity = _mm_sub_ps(cascadeBase, cascadeSolidify);
+                const __m128 compressed = _mm_add_ps(scaler(remainDistance, remainCapacity, _mm_loadu_ps(&batch.priorityCapacities[t])), solidify);
+                const __m128 clamped = select(_mm_cmplt_ps(compressed, min), compressed, min);
+
+                const __m128 scaled = scaler(cascadeDelta, cascadeRatio, ratio);
+                const __m128 delta = select(_mm_cmplt_ps(maxDelta, scaled), scaled, maxDelta);
+
+                _mm_storeu_ps(&batch.priorityDistances[t], select(compress, _mm_add_ps(base, delta), clamped));
+
+                cascadeDistance = _mm_sub_ps(cascadeDistance, clamped);
+                cascadeSolidify = _mm_sub_ps(cascadeSolidify, solidify);
+                cascadeBase = _mm_sub_ps(cascadeBase, base);
+                cascadeDelta = _mm_sub_ps(cascadeDelta, delta);
+                cascadeRatio = _mm_sub_ps(cascadeRatio, ratio);
+            }
+        }
 
-            const int flexShrinkOffset = mathf::MulToInt(finalBaseLength, mathf::InvertRatio(child->flexShrink));
-            const int flexShrinkLength = mathf::MulToInt(finalBaseLength, child->flexShrink);
-            const float flexShrinkRatio = mathf::Divide(flexShrinkLength, 100.0f) ;
+        return vectorEnd;
+    }
+#else
+    inline constexpr auto DISCADELTA_BATCH_KERNEL = "scalar";
+    inline constexpr size_t DISCADELTA_BATCH_LANES = 1;
 
-            discadeltaCtx.baseLengths.push_back(finalBaseLength);
+    inline size_t SolveDiscadeltaBatchVector(DiscadeltaBatch&, const size_t) noexcept { return 0; }
+#endif
+
+    // Solves every problem of the batch into batch.distances, tile by tile so the scratch stays
+    // in cache. The vector kernel takes whole lane groups, the tail and non-x86 builds run the
+    // scalar reference; forceScalar runs the reference only.
+    inline void SolveDiscadeltaBatch(DiscadeltaBatch& batch, const bool forceScalar = false) {
+        for (size_t begin = 0; begin < batch.problemCount; begin += DiscadeltaBatch::TILE_SIZE) {
+            const size_t count = std::min(DiscadeltaBatch::TILE_SIZE, batch.problemCount - begin);
 
-            baseFiller.lengths.push_back(&discadeltaCtx.baseLengths[i]);
-            baseFiller.mins.push_back(alignMin);
-            baseFiller.reduceDistances.push_back(flexShrinkOffset);
-            baseFiller.stepRatios.push_back(flexShrinkRatio);
-            baseFiller.accumulateStepRatio += flexShrinkRatio;
-            baseFiller.accumulateOffset += flexShrinkOffset;
+            PrepareDiscadeltaBatchTile(batch, begin, count);
 
-            discadeltaCtx.glowLengths.push_back(0);
+            const size_t vectorEnd = forceScalar ? 0 : SolveDiscadeltaBatchVector(batch, count);
+            SolveDiscadeltaBatchScalar(batch, vectorEnd, count);
 
-            remainSumsFlexGlow += child->flexGlow;
+            for (size_t r = 0; r < batch.segmentCount; ++r) {
+                for (size_t q = 0; q < count; ++q) {
+                    const uint32_t rank = batch.priorityRanks[DiscadeltaBatch::tileAt(r, q)];
+                    batch.distances[batch.at(r, begin + q)] = batch.priorityDistances[DiscadeltaBatch::tileAt(rank, q)];
+                }
+            }
         }
+    }
 
-        if (relativeLength >= absoluteBaseLength) {
-            DiscadeltaGlowFiller filler{};
+    // Places a child and flags it for the sweep when it moved, resized or its parent changed.
+    // A resize flags the child for the next measure pass.
+    inline void SetLayoutTreeRect(ViewpanelLayoutTree& tree, const uint32_t index, const vk::Rect2D& rect) noexcept {
+        vk::Rect2D& current = tree.rects[index];
+        if (current == rect) return;
 
-            const int flexGlowLength = std::max(0, relativeLength - absoluteBaseLength);
-            int remainFlexGlowLength = flexGlowLength;
-            int accumulateFlexGlowLength{0};
+        if (current.extent != rect.extent) {
+            MarkLayoutExtentDirty(tree, index, rect.extent);
+        }
 
-            for (size_t i = 0; i < childCount; i++) {
-                const auto child = viewpanel.getChild(i);
-                if (child == nullptr)
-                    continue;
+        current = rect;
+        tree.panels[index]->rect = rect;
+        SetLayoutFlags(tree, index, LayoutDirtyFlags::eArrange);
+    }
 
-                const int& baseLength = discadeltaCtx.baseLengths[i];
-                const float& ratio = child->flexGlow;
-                const int flexLength = remainFlexGlowLength <= 0? 0 :mathf::MulToInt(mathf::Divide(remainFlexGlowLength, remainSumsFlexGlow), ratio);
-                const int fullLength = baseLength + flexLength;
-                const int max = (viewpanel.isRow()? ReadLengthValue(child->maxWidth, relativeLength, fullLength): ReadLengthValue(child->maxHeight, relativeLength, fullLength)) - baseLength;
-                const int offset = std::max(0,flexLength - max);
+    // A way matching length and stamp still has to match the measured child lengths along the
+    // axis, the only solve inputs that change without a stamp. They are kept next to the solved
+    // segments, so the compare is exact and runs only for the ways that passed the stamp.
+    inline bool IsLayoutArrangeWayValid(const ViewpanelLayoutTree& tree, const uint32_t index, const LayoutArrangeSlot* slots) noexcept {
+        const bool isRow = tree.isRow(index);
+        size_t step = 0;
+
+        for (uint32_t child = tree.firstChildren[index]; child != INVALID_LAYOUT_INDEX; child = tree.nextSiblings[child], ++step) {
+            const RectLayout& layout = tree.layouts[child];
+            if (slots[step].base != (isRow ? layout.baseWidth : layout.baseHeight) ||
+                slots[step].min != (isRow ? layout.greaterMinWidth : layout.greaterMinHeight)) {
+                return false;
+            }
+        }
 
-                const int finalLength = std::max(0, flexLength - offset);
-                discadeltaCtx.glowLengths[i] = finalLength;
+        return true;
+    }
 
-                //populate the container with the content that not yet reaches max capacity
-                if (offset <= 0) {
-                    filler.accumulateStepRatio += ratio;
-                    filler.lengths.emplace_back(&discadeltaCtx.glowLengths[i]);
-                    filler.maxs.emplace_back(max);
-                    filler.stepRatios.emplace_back(ratio);
-                }
+    // Solves the children segments of a panel or reuses one of its cached solves. Every panel only
+    // touches its own ways, so parallel sweeps never share an entry. Returns true on a cache hit.
+    inline bool SolveLayoutChildren(ViewpanelLayoutTree& tree, const uint32_t index, const int length, const int offset,
+        std::pmr::memory_resource* resource, LayoutArrangeSlot*& slots) {
+        constexpr uint32_t WAYS = ViewpanelLayoutTree::ARRANGE_CACHE_WAYS;
+        const LayoutArrangeKey key{length, tree.inputStamps[index]};
+        const size_t childCount = tree.childCounts[index];
+        const size_t keyStart = static_cast<size_t>(index) * WAYS;
+        LayoutArrangeSlot* const ways = &tree.arrangeSlots[tree.arrangeSlotStarts[index]];
+
+        uint32_t way = 0;
+        while (way < WAYS && (tree.arrangeKeys[keyStart + way] != key || !IsLayoutArrangeWayValid(tree, index, ways + way * childCount))) ++way;
+        const bool hit = way < WAYS;
+
+        if (!hit) way = tree.arrangeVictims[index];
+        tree.arrangeVictims[index] = static_cast<uint8_t>((way + 1) % WAYS);
+        slots = ways + way * childCount;
+        if (hit) return true;
+
+        DiscadeltaContext flexCtx = MakeDiscadeltaContext(tree, index, resource);
+        SolveDiscadelta(flexCtx);
+
+        const bool isRow = tree.isRow(index);
+        size_t step = 0;
+        for (uint32_t child = tree.firstChildren[index]; child != INVALID_LAYOUT_INDEX; child = tree.nextSiblings[child], ++step) {
+            const RectLayout& layout = tree.layouts[child];
+            slots[step] = LayoutArrangeSlot{flexCtx.offsets[step] - offset, std::max(0, flexCtx.baseLengths[step] + flexCtx.glowLengths[step]),
+                isRow ? layout.baseWidth : layout.baseHeight, isRow ? layout.greaterMinWidth : layout.greaterMinHeight};
+        }
+        tree.arrangeKeys[keyStart + way] = key;
+        return false;
+    }
 
-                remainFlexGlowLength -= flexLength; // consume calculated length
-                accumulateFlexGlowLength += finalLength; // accumulate clamped length
-                remainSumsFlexGlow -= ratio;
+    inline bool PlaceLayoutChildren(ViewpanelLayoutTree& tree, const uint32_t index, std::pmr::memory_resource* resource) {
+        const bool isRow = tree.isRow(index);
+        const vk::Rect2D rect = tree.rects[index];
+        const int axisLength = static_cast<int>(isRow ? rect.extent.width : rect.extent.height);
+        const int axisOffset = isRow ? rect.offset.x : rect.offset.y;
 
+        LayoutArrangeSlot* slots = nullptr;
+        const bool cached = SolveLayoutChildren(tree, index, axisLength, axisOffset, resource, slots);
+
+        size_t step = 0;
+        for (uint32_t child = tree.firstChildren[index]; child != INVALID_LAYOUT_INDEX; child = tree.nextSiblings[child], ++step) {
+            const int targetLength = slots[step].length;
+            const int targetOffset = axisOffset + slots[step].offset;
+
+            const int targetWidthLength = isRow? targetLength: static_cast<int>(rect.extent.width);
+            const int targetHeightLength = isRow? static_cast<int>(rect.extent.height): targetLength;
+
+            const int targetXOffset = isRow? targetOffset : rect.offset.x;
+            const int targetYOffset = isRow? rect.offset.y : targetOffset + rect.offset.y;
+
+            SetLayoutTreeRect(tree, child, vk::Rect2D{ vk::Offset2D{targetXOffset, targetYOffset},
+                vk::Extent2D{static_cast<uint32_t>(targetWidthLength), static_cast<uint32_t>(targetHeightLength)}});
+        }
+
+        return cached;
+    }
+
+    inline utilities::ScratchArena& GetLayoutScratch(ViewpanelLayoutTree& tree) noexcept {
+        const size_t worker = tree.pool ? tree.pool->currentWorkerIndex() : jobs::ThreadPool::EXTERNAL_THREAD;
+        return worker == jobs::ThreadPool::EXTERNAL_THREAD ? tree.scratch : *tree.workerScratch[worker];
+    }
+
+    inline void ArrangeLayoutChildrenParallel(ViewpanelLayoutTree& tree, uint32_t index);
+
+    // Forward sweep over the pre-order range [begin, end): a panel flagged eArrange re-places its
+    // children, which flags the ones that moved so the sweep visits them next. Clean subtrees are
+    // jumped over. Every panel only reads its parent rect, so sibling subtrees are independent.
+    inline void ArrangeLayoutRange(ViewpanelLayoutTree& tree, const uint32_t begin, const uint32_t end) {
+        utilities::ScratchArena& scratch = GetLayoutScratch(tree);
+        uint64_t arranged = 0;
+        uint64_t cacheHits = 0;
+
+        for (uint32_t i = begin; i < end;) {
+            if (!HasAnyFlag(LoadLayoutFlags(tree, i), LayoutDirtyFlags::eArrange)) {
+                i = tree.subtreeEnds[i];
+                continue;
             }
 
-            filler.remainLength = std::max(0, flexGlowLength - accumulateFlexGlowLength);
+            ClearLayoutFlags(tree, i, LayoutDirtyFlags::eArrange);
+            ++arranged;
 
-            if (filler.remainLength > 0 && !filler.lengths.empty()) {
-                RedistributeDiscadeltaRemainGlow(filler);
+            if (tree.childCounts[i] == 0) {
+                ++i;
+                continue;
+            }
+
+            if (PlaceLayoutChildren(tree, i, scratch.resource())) ++cacheHits;
+
+            if (tree.pool && tree.childCounts[i] > 1 && tree.subtreeEnds[i] - i >= tree.parallelThreshold) {
+                ArrangeLayoutChildrenParallel(tree, i);
+                i = tree.subtreeEnds[i];
+                continue;
+            }
+
+            ++i;
+        }
+
+        profiler::AddCounter(profiler::Counter::ePanelsArranged, arranged);
+        profiler::AddCounter(profiler::Counter::eArrangeCacheHits, cacheHits);
+    }
+
+    // Fans the child subtrees out to the pool, small ones stay on the calling thread. The result
+    // does not depend on the schedule, it is identical to the serial sweep.
+    inline void ArrangeLayoutChildrenParallel(ViewpanelLayoutTree& tree, const uint32_t index) {
+        jobs::JobCounter counter{};
+
+        for (uint32_t child = tree.firstChildren[index]; child != INVALID_LAYOUT_INDEX; child = tree.nextSiblings[child]) {
+            const uint32_t end = tree.subtreeEnds[child];
+            if (end - child >= tree.parallelGrain) {
+                tree.pool->submit([&tree, child, end] { ArrangeLayoutRange(tree, child, end); }, counter);
+            }
+        }
+
+        for (uint32_t child = tree.firstChildren[index]; child != INVALID_LAYOUT_INDEX; child = tree.nextSiblings[child]) {
+            const uint32_t end = tree.subtreeEnds[child];
+            if (end - child < tree.parallelGrain) {
+                ArrangeLayoutRange(tree, child, end);
             }
         }
-        else {
-            baseFiller.remainLength = std::max(0, relativeLength);
 
-            for (size_t i = 0; i < childCount; i++) {
-                ComputeDiscadeltaBase(baseFiller, i);
+        tree.pool->wait(counter);
+    }
+
+    // The Discadelta contexts live in the scratch arenas, released once the sweep is done.
+    inline void MakeRectLayout(ViewpanelLayoutTree& tree, const int& posX, const int& posY, const int& width, const int& height) {
+        if (tree.empty()) return;
+        profiler::ScopedZone zone{"MakeRectLayout"};
+
+        if (tree.pool) {
+            while (tree.workerScratch.size() < tree.pool->workerCount()) {
+                tree.workerScratch.push_back(std::make_unique<utilities::ScratchArena>());
             }
         }
 
-        return discadeltaCtx;
+        SetLayoutTreeRect(tree, 0, vk::Rect2D{ vk::Offset2D{posX, posY}, vk::Extent2D{static_cast<uint32_t>(width), static_cast<uint32_t>(height)}});
+        if (HasAnyFlag(LoadLayoutFlags(tree, 0), LayoutDirtyFlags::eArrange)) ++tree.arrangeVersion;
+        ArrangeLayoutRange(tree, 0, tree.size());
+
+        tree.scratch.reset();
+        for (const auto& scratch : tree.workerScratch) scratch->reset();
     }
 
-    constexpr void MakeRectLayout(Viewpanel& viewpanel, const int& posX, const int& posY, const int& width, const int& height) {
-        SetLocalPanelRect(viewpanel, posX, posY, width, height);
+    constexpr bool IsHitGridRectEmpty(const vk::Rect2D& rect) noexcept {
+        return rect.extent.width == 0 || rect.extent.height == 0;
+    }
 
-        if (viewpanel.isChildrenEmpty()) return;
+    // Inclusive cell range [c0, c1] x [r0, r1] a rect overlaps, false when it misses the grid.
+    constexpr bool GetHitGridCellRange(const ViewpanelHitGrid& grid, const vk::Rect2D& rect, uint32_t& c0, uint32_t& r0, uint32_t& c1, uint32_t& r1) noexcept {
+        if (IsHitGridRectEmpty(rect)) return false;
 
-        DiscadeltaContext flexCtx = MakeDiscadeltaContext(viewpanel);
+        const int32_t x0 = rect.offset.x - grid.bounds.offset.x;
+        const int32_t y0 = rect.offset.y - grid.bounds.offset.y;
+        const int32_t x1 = x0 + static_cast<int32_t>(rect.extent.width) - 1;
+        const int32_t y1 = y0 + static_cast<int32_t>(rect.extent.height) - 1;
+        const auto gridWidth = static_cast<int32_t>(grid.bounds.extent.width);
+        const auto gridHeight = static_cast<int32_t>(grid.bounds.extent.height);
 
-        const bool isRow = viewpanel.isRow();
+        if (x1 < 0 || y1 < 0 || x0 >= gridWidth || y0 >= gridHeight) return false;
+
+        c0 = static_cast<uint32_t>(std::max(x0, 0) / grid.cellSize);
+        r0 = static_cast<uint32_t>(std::max(y0, 0) / grid.cellSize);
+        c1 = static_cast<uint32_t>(std::min(x1, gridWidth - 1) / grid.cellSize);
+        r1 = static_cast<uint32_t>(std::min(y1, gridHeight - 1) / grid.cellSize);
+        return true;
+    }
+
+    // Counting pass then fill pass into a CSR cell list, items stay in ascending tree order.
+    template<typename GetRect>
+    void FillHitGridCells(const ViewpanelHitGrid& grid, const ViewpanelLayoutTree& tree, std::vector<uint32_t>& starts, std::vector<uint32_t>& cells, GetRect getRect) {
+        starts.assign(grid.cellCount() + 1, 0);
+
+        uint32_t c0, r0, c1, r1;
+        for (uint32_t i = 1; i < tree.size(); ++i) {
+            if (!GetHitGridCellRange(grid, getRect(i), c0, r0, c1, r1)) continue;
+            for (uint32_t r = r0; r <= r1; ++r) {
+                for (uint32_t c = c0; c <= c1; ++c) ++starts[r * grid.columns + c + 1];
+            }
+        }
 
-        for (size_t i = 0; i < viewpanel.childCount(); ++i) {
-            Viewpanel *child = viewpanel.getChild(i);
-            if (!child) continue;
+        for (uint32_t cell = 0; cell < grid.cellCount(); ++cell) starts[cell + 1] += starts[cell];
+        cells.resize(starts.back());
 
-            const int baseLength = flexCtx.baseLengths[i];
-            const int flexDelta = flexCtx.glowLengths[i];
+        std::vector<uint32_t> cursor(starts.begin(), starts.end() - 1);
+        for (uint32_t i = 1; i < tree.size(); ++i) {
+            if (!GetHitGridCellRange(grid, getRect(i), c0, r0, c1, r1)) continue;
+            for (uint32_t r = r0; r <= r1; ++r) {
+                for (uint32_t c = c0; c <= c1; ++c) cells[cursor[r * grid.columns + c]++] = i;
+            }
+        }
+    }
 
-            const int targetLength = std::max(0,baseLength + flexDelta );
+    // Rebuilds the grid over the root rect. The root itself is never picked, panels that are
+    // not picked by position are left out of the panel cells.
+    inline void BuildViewpanelHitGrid(ViewpanelHitGrid& grid, const ViewpanelLayoutTree& tree) {
+        profiler::ScopedZone zone{"BuildViewpanelHitGrid"};
+        grid.clear();
+        if (tree.empty()) return;
+
+        grid.bounds = tree.rects.front();
+        if (IsHitGridRectEmpty(grid.bounds)) return;
+
+        grid.cellSize = ViewpanelHitGrid::DEFAULT_CELL_SIZE;
+        const auto cellsAlong = [&grid](const uint32_t length) {
+            return (length + static_cast<uint32_t>(grid.cellSize) - 1) / static_cast<uint32_t>(grid.cellSize);
+        };
+        while (cellsAlong(grid.bounds.extent.width) * cellsAlong(grid.bounds.extent.height) > ViewpanelHitGrid::MAX_CELL_COUNT) {
+            grid.cellSize *= 2;
+        }
+        grid.columns = cellsAlong(grid.bounds.extent.width);
+        grid.rows = cellsAlong(grid.bounds.extent.height);
 
-            debug::log(debug::LogLevel::eInfo, "d{} {}", child->name, targetLength);
+        FillHitGridCells(grid, tree, grid.panelCellStarts, grid.panelCells, [&tree](const uint32_t i) {
+            return tree.panels[i]->pickingMode == PickingMode::ePosition ? tree.rects[i] : vk::Rect2D{};
+        });
+        FillHitGridCells(grid, tree, grid.resizerCellStarts, grid.resizerCells, [&tree](const uint32_t i) {
+            return tree.panels[i]->pickingMode == PickingMode::ePosition ? tree.panels[i]->resizerZone : vk::Rect2D{};
+        });
 
-            const int targetWidthLength = isRow? targetLength: width;
-            const int targetHeightLength = isRow? height: targetLength;
+        grid.arrangeVersion = tree.arrangeVersion;
+    }
 
-            const int targetXOffset = isRow? flexCtx.accumulateOffset : viewpanel.rect.offset.x;
-            const int targetYOffset = isRow? viewpanel.rect.offset.y : flexCtx.accumulateOffset;
+    inline void UpdateViewpanelHitGrid(ViewpanelHitGrid& grid, const ViewpanelLayoutTree& tree) {
+        if (grid.arrangeVersion != tree.arrangeVersion) BuildViewpanelHitGrid(grid, tree);
+    }
 
-            MakeRectLayout(*child, targetXOffset, targetYOffset, targetWidthLength,targetHeightLength);
+    constexpr uint32_t GetHitGridCell(const ViewpanelHitGrid& grid, const int32_t x, const int32_t y) noexcept {
+        const int32_t localX = x - grid.bounds.offset.x;
+        const int32_t localY = y - grid.bounds.offset.y;
+        if (grid.empty() || localX < 0 || localY < 0 ||
+            localX >= static_cast<int32_t>(grid.bounds.extent.width) || localY >= static_cast<int32_t>(grid.bounds.extent.height)) {
+            return INVALID_LAYOUT_INDEX;
+        }
+        return static_cast<uint32_t>(localY / grid.cellSize) * grid.columns + static_cast<uint32_t>(localX / grid.cellSize);
+    }
 
-            flexCtx.accumulateOffset += targetLength;
+    // Deepest pickable panel containing the point, INVALID_LAYOUT_INDEX when none does.
+    constexpr uint32_t PickViewpanel(const ViewpanelHitGrid& grid, const ViewpanelLayoutTree& tree, const int32_t x, const int32_t y) noexcept {
+        const uint32_t cell = GetHitGridCell(grid, x, y);
+        if (cell == INVALID_LAYOUT_INDEX) return INVALID_LAYOUT_INDEX;
+
+        for (uint32_t k = grid.panelCellStarts[cell + 1]; k > grid.panelCellStarts[cell]; --k) {
+            const uint32_t i = grid.panelCells[k - 1];
+            const vk::Rect2D& rect = tree.rects[i];
+            if (x >= rect.offset.x && y >= rect.offset.y &&
+                x <  rect.offset.x + static_cast<int32_t>(rect.extent.width) &&
+                y <  rect.offset.y + static_cast<int32_t>(rect.extent.height)) {
+                return i;
+            }
+        }
+        return INVALID_LAYOUT_INDEX;
+    }
 
-            //Legacy
-            //SetPanelResizerRect(*child,i < flexCtx.shareAmount, flexCtx.isRow, targetXOffset, targetYOffset, width, height);
+    // Last resizer zone in pre-order strictly containing the point, INVALID_LAYOUT_INDEX when none does.
+    constexpr uint32_t PickViewpanelResizer(const ViewpanelHitGrid& grid, const ViewpanelLayoutTree& tree, const int32_t x, const int32_t y) noexcept {
+        const uint32_t cell = GetHitGridCell(grid, x, y);
+        if (cell == INVALID_LAYOUT_INDEX) return INVALID_LAYOUT_INDEX;
+
+        for (uint32_t k = grid.resizerCellStarts[cell + 1]; k > grid.resizerCellStarts[cell]; --k) {
+            const uint32_t i = grid.resizerCells[k - 1];
+            const vk::Rect2D& zone = tree.panels[i]->resizerZone;
+            if (x > zone.offset.x && y > zone.offset.y &&
+                x < zone.offset.x + static_cast<int32_t>(zone.extent.width) &&
+                y < zone.offset.y + static_cast<int32_t>(zone.extent.height)) {
+                return i;
+            }
         }
+        return INVALID_LAYOUT_INDEX;
     }
 
     constexpr void ResizingViewport(Viewport& viewport, const int& width, const int& height) {
+        profiler::ScopedZone zone{"ResizingViewport"};
         viewport.extent.width  = static_cast<uint32_t>(width);
         viewport.extent.height = static_cast<uint32_t>(height);
 
         if (viewport.panel){
-            Viewpanel& panel = *viewport.panel;
-            AccumulateRectLayoutStepBaseLength(panel);
-            //InitRectLayoutContext(panel);
+            ViewpanelLayoutTree& tree = viewport.layoutTree;
+            SyncViewpanelLayoutTree(tree, *viewport.panel);
+            AccumulateRectLayoutStepBaseLength(tree);
+
+            const RectLayout& layout = tree.layouts.front();
+            if (viewport.window) {
 #ifdef USE_SDL
-            SDL_SetWindowMinimumSize(viewport.window.getHandle(),panel.layout.greaterMinWidth, panel.layout.greaterMinHeight);
+                SDL_SetWindowMinimumSize(viewport.window->getHandle(),layout.greaterMinWidth, layout.greaterMinHeight);
 #else
-            glfwSetWindowSizeLimits(viewport.window.getHandle(),panel.layout.greaterMinWidth, panel.layout.greaterMinHeight, GLFW_DONT_CARE, GLFW_DONT_CARE);
+                glfwSetWindowSizeLimits(viewport.window->getHandle(),layout.greaterMinWidth, layout.greaterMinHeight, GLFW_DONT_CARE, GLFW_DONT_CARE);
 #endif
-            MakeRectLayout(*viewport.panel, 0, 0, static_cast<int>(viewport.extent.width), static_cast<int>(viewport.extent.height));
+            }
+            MakeRectLayout(tree, 0, 0, static_cast<int>(viewport.extent.width), static_cast<int>(viewport.extent.height));
+            UpdateViewpanelHitGrid(viewport.hitGrid, tree);
         }
     }
 
@@ -538,10 +1447,18 @@ export namespace ufox::geometry {
     //     }
     // }
 
-    constexpr void ViewpanelPollEvent(Viewport& viewport, Viewpanel& viewpanel, input::InputResource& input, input::StandardCursorResource& cursor)
+    constexpr void SetViewportHoveredPanel(Viewport& viewport, Viewpanel* panel) noexcept {
+        if (viewport.hoveredPanel == panel) return;
+        if (viewport.hoveredPanel) viewport.hoveredPanel->hovered = false;
+        if (panel) panel->hovered = true;
+        viewport.hoveredPanel = panel;
+    }
+
+    constexpr void ViewportPollEvent(Viewport& viewport, input::InputResource& input, input::StandardCursorResource& cursor)
     {
         // auto start = std::chrono::high_resolution_clock::now();
-        if (!viewpanel.parent) return;
+        ViewpanelLayoutTree& tree = viewport.layoutTree;
+        if (tree.empty()) return;
 
         const auto mx = input.mousePosition.x;
         const auto my = input.mousePosition.y;
@@ -554,68 +1471,45 @@ export namespace ufox::geometry {
             ctx.currentValue = static_cast<int>(std::round(ctx.currentValue / RESIZER_SNAP_GRID) * RESIZER_SNAP_GRID);
 
             //TranslatePanelResizer(ctx);
-            MakeRectLayout(*viewport.panel, 0, 0, static_cast<int>(viewport.extent.width), static_cast<int>(viewport.extent.height));
+            MakeRectLayout(tree, 0, 0, static_cast<int>(viewport.extent.width), static_cast<int>(viewport.extent.height));
+            UpdateViewpanelHitGrid(viewport.hitGrid, tree);
 
             // auto end = std::chrono::high_resolution_clock::now();
             // float ms = std::chrono::duration<float, std::milli>(end - start).count();
             //
-            // debug::log(debug::LogLevel::eInfo, "UI Frame: {:.3f} ms", ms);
+            // debug::log<debug::LogLevel::eInfo, debug::LogCategory::eLayout>("UI Frame: {:.3f} ms", ms);
             return;
         }
 
-        const bool overSplitter =
-            mx > viewpanel.resizerZone.offset.x &&
-            my > viewpanel.resizerZone.offset.y &&
-            mx < viewpanel.resizerZone.offset.x + static_cast<int32_t>(viewpanel.resizerZone.extent.width) &&
-            my < viewpanel.resizerZone.offset.y + static_cast<int32_t>(viewpanel.resizerZone.extent.height);
+        UpdateViewpanelHitGrid(viewport.hitGrid, tree);
 
-        const bool isHovered =
-            mx >= viewpanel.rect.offset.x &&
-            my >= viewpanel.rect.offset.y &&
-            mx <  viewpanel.rect.offset.x + static_cast<int32_t>(viewpanel.rect.extent.width) &&
-            my <  viewpanel.rect.offset.y + static_cast<int32_t>(viewpanel.rect.extent.height);
+        const uint32_t splitter = PickViewpanelResizer(viewport.hitGrid, tree, mx, my);
+        Viewpanel* target = splitter == INVALID_LAYOUT_INDEX ? nullptr : tree.panels[splitter];
 
-        if (overSplitter)
-        {
-            if (viewport.resizerContext.targetPanel != &viewpanel) {
-                viewport.resizerContext.targetPanel = &viewpanel;
+        if (viewport.resizerContext.targetPanel != target) {
+            viewport.resizerContext.targetPanel = target;
+            const input::CursorType cursorType = !target ? input::CursorType::eDefault :
+                target->parent->isColumn() ? input::CursorType::eNSResize : input::CursorType::eEWResize;
+            if (!viewport.window) {
+                cursor.currentCursor = cursorType;
+            } else {
     #ifdef USE_SDL
-                input::SetStandardCursor(cursor, viewpanel.parent->isColumn() ?input::CursorType::eNSResize :input::CursorType::eEWResize);
+                input::SetStandardCursor(cursor, cursorType);
     #else
-                input::SetStandardCursor(cursor, viewpanel.parent->isColumn() ?input::CursorType::eNSResize :input::CursorType::eEWResize, viewport.window);
+                input::SetStandardCursor(cursor, cursorType, *viewport.window);
     #endif
-
             }
         }
-        else if (viewport.resizerContext.targetPanel == &viewpanel)
-        {
-    #ifdef USE_SDL
-            input::SetStandardCursor(cursor, input::CursorType::eDefault);
-    #else
-            input::SetStandardCursor(cursor, input::CursorType::eDefault, viewport.window);
-    #endif
-            viewport.resizerContext.targetPanel = nullptr;
-        }
 
-        if (isHovered) {
-            if (viewport.hoveredPanel != &viewpanel)
-                viewport.hoveredPanel = &viewpanel;
-        }
-        else if (viewport.hoveredPanel == &viewpanel) {
-            viewport.hoveredPanel = nullptr;
-        }
+        const uint32_t hovered = PickViewpanel(viewport.hitGrid, tree, mx, my);
+        SetViewportHoveredPanel(viewport, hovered == INVALID_LAYOUT_INDEX ? nullptr : tree.panels[hovered]);
     }
 
     constexpr void BindEvents(Viewport& viewport, input::InputResource& input, input::StandardCursorResource& cursor) {
         if (!viewport.panel) return;
 
         viewport.mouseMoveEventHandle.emplace(input.onMouseMoveCallbackPool.bind([&viewport, &cursor](input::InputResource& i) {
-            const auto allPanels = viewport.panel->getAllPanels();
-            for (const auto panel : allPanels) {
-                if (panel->pickingMode == PickingMode::ePosition) {
-                    ViewpanelPollEvent(viewport, *panel, i, cursor);
-                }
-            }
+            ViewportPollEvent(viewport, i, cursor);
         }));
 
         viewport.leftClickEventHandle.emplace(input.onLeftMouseButtonCallbackPool.bind([&viewport](const input::InputResource& inputResource){
@@ -646,7 +1540,7 @@ export namespace ufox::geometry {
         quadMesh.indices.assign(std::begin(QuadIndices), std::end(QuadIndices));
 
         gpu::vulkan::CreateAndCopyBuffer(gpu, QuadVertices, QUAD_VERTICES_BUFFER_SIZE, quadMesh.vertexBuffer);
-        gpu::vulkan::CreateAndCopyBuffer(gpu, QuadIndices, QUAD_INDICES_BUFFER_SIZE, quadMesh.indexBuffer);
+        gpu::vulkan::CreateAndCopyBuffer(gpu, QuadIndices, QUAD_INDICES_BUFFER_SIZE, quadMesh.indexBuffer, vk::BufferUsageFlagBits::eIndexBuffer);
 
         return quadMesh;
     }
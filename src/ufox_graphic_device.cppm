@@ -160,7 +160,7 @@ export namespace ufox::gpu::vulkan {
                 }
             }
             if (!found) {
-                debug::log(debug::LogLevel::eWarning, "Missing extension: {}", req);
+                debug::log<debug::LogLevel::eWarning, debug::LogCategory::eGpu>("Missing extension: {}", req);
                 return false;
             }
         }
@@ -356,7 +356,7 @@ export namespace ufox::gpu::vulkan {
     }
 
     vk::raii::Queue MakeGraphicsQueue(const vk::raii::Device& device, const QueueFamilyIndices& queueFamilyIndices) {
-        ufox::debug::log(debug::LogLevel::eInfo, "Retrieving graphics queue for queue family index: {}", queueFamilyIndices.graphicsFamily);
+        ufox::debug::log<debug::LogLevel::eInfo, debug::LogCategory::eGpu>("Retrieving graphics queue for queue family index: {}", queueFamilyIndices.graphicsFamily);
 
         return {device, queueFamilyIndices.graphicsFamily, 0};
     }
@@ -381,6 +381,7 @@ export namespace ufox::gpu::vulkan {
         vk::SurfaceFormatKHR surfaceFormat              = ChooseSwapSurfaceFormat(physicalDevice.getSurfaceFormatsKHR(*surface));
         resource.colorFormat                            = surfaceFormat.format;
         resource.extent                                 = ChooseSwapExtent(extent, surfaceCapabilities);
+        resource.usage                                  = usage & surfaceCapabilities.supportedUsageFlags;
         vk::PresentModeKHR presentMode                  = ChooseSwapPresentMode(physicalDevice.getSurfacePresentModesKHR(*surface));
         vk::SurfaceTransformFlagBitsKHR preTransform    = surfaceCapabilities.supportedTransforms & vk::SurfaceTransformFlagBitsKHR::eIdentity ? vk::SurfaceTransformFlagBitsKHR::eIdentity : surfaceCapabilities.currentTransform;
         vk::CompositeAlphaFlagBitsKHR compositeAlpha    = surfaceCapabilities.supportedCompositeAlpha & vk::CompositeAlphaFlagBitsKHR::ePreMultiplied  ? vk::CompositeAlphaFlagBitsKHR::ePreMultiplied
@@ -394,7 +395,7 @@ export namespace ufox::gpu::vulkan {
             .setImageColorSpace(surfaceFormat.colorSpace) // Use colorSpace from surfaceFormat
             .setImageExtent(resource.extent)
             .setImageArrayLayers(1)
-            .setImageUsage(usage)
+            .setImageUsage(resource.usage)
             .setPreTransform(preTransform)
             .setCompositeAlpha(compositeAlpha)
             .setPresentMode(presentMode)
@@ -717,14 +718,27 @@ export namespace ufox::gpu::vulkan {
 
         buffer.data.emplace(*gpu.device, bufferInfo);
 
-        vk::MemoryRequirements memoryRequirements = buffer.data->getMemoryRequirements();
-        vk::MemoryAllocateInfo memoryAllocateInfo( memoryRequirements.size, FindMemoryType( *gpu.physicalDevice->getMemoryProperties(),
-                                                   memoryRequirements.memoryTypeBits, properties ) );
-        buffer.memory.emplace(*gpu.device, memoryAllocateInfo);
-        buffer.data->bindMemory( *buffer.memory, 0 );
+        buffer.allocation = gpu.allocator->allocate(buffer.data->getMemoryRequirements(), properties, memory::ResourceKind::eBuffer);
+        if (!buffer.allocation) throw std::runtime_error("failed to allocate buffer memory!");
+
+        buffer.data->bindMemory( buffer.allocation.memory(), buffer.allocation.offset() );
         return buffer;
     }
 
+    FrameArena MakeFrameArena(const GPUResources& gpu, const vk::DeviceSize sizePerFrame, const uint32_t frameCount, const vk::BufferUsageFlags& usage) {
+        FrameArena arena{};
+        arena.ring = memory::FrameRingAllocator(sizePerFrame, frameCount);
+        arena.buffer = MakeBuffer(gpu, arena.ring.size(), usage, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        return arena;
+    }
+
+    // Valid until the same frame index comes around again, call ring.beginFrame after its fence.
+    std::optional<FrameSlice> AllocateFrameData(FrameArena& arena, const vk::DeviceSize size, const vk::DeviceSize alignment) {
+        const std::optional<vk::DeviceSize> offset = arena.ring.allocate(size, alignment);
+        if (!offset) return std::nullopt;
+        return FrameSlice{*arena.buffer.data, *offset, static_cast<std::byte*>(arena.buffer.allocation.mapped()) + *offset};
+    }
+
     void CopyBuffer(const vk::raii::Device& device, const vk::raii::CommandPool& commandPool,const vk::raii::Queue& graphicsQueue , const Buffer& srcBuffer, const Buffer& dstBuffer, const vk::DeviceSize& size) {
         vk::raii::CommandBuffer cmd = BeginSingleTimeCommands(device, commandPool);
 
@@ -852,14 +866,13 @@ export namespace ufox::gpu::vulkan {
 
 
     template<typename BufferData, size_t Size>
-    constexpr void CreateAndCopyBuffer(const GPUResources& gpu, const BufferData(&data)[Size], vk::DeviceSize bufferSize, std::optional<Buffer>& buffer) {
+    constexpr void CreateAndCopyBuffer(const GPUResources& gpu, const BufferData(&data)[Size], vk::DeviceSize bufferSize, std::optional<Buffer>& buffer,
+        const vk::BufferUsageFlags usage = vk::BufferUsageFlagBits::eVertexBuffer) {
         const Buffer stagingBuffer = MakeBuffer(gpu, bufferSize, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
 
-        const auto pData = static_cast<uint8_t*>(stagingBuffer.memory->mapMemory(0, bufferSize));
-        memcpy(pData, data, bufferSize);
-        stagingBuffer.memory->unmapMemory();
+        memcpy(stagingBuffer.allocation.mapped(), data, bufferSize);
 
-        buffer.emplace(MakeBuffer(gpu, bufferSize, vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal));
+        buffer.emplace(MakeBuffer(gpu, bufferSize, vk::BufferUsageFlagBits::eTransferDst | usage, vk::MemoryPropertyFlagBits::eDeviceLocal));
 
         CopyBuffer(gpu, stagingBuffer, *buffer, bufferSize);
     }
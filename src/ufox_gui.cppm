@@ -1,7 +1,13 @@
 module;
 
 #include <vulkan/vulkan_raii.hpp>
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <functional>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <glm/glm.hpp>
@@ -13,6 +19,7 @@ export module ufox_gui;
 import ufox_lib;
 import ufox_graphic_device;
 import ufox_geometry;
+import ufox_gui_batch;
 
 export namespace ufox::gui {
     constexpr void MakeDescriptorPool(const gpu::vulkan::GPUResources& gpu, const uint32_t& minImageCount, GUIResource& guiResource) {
@@ -42,18 +49,26 @@ export namespace ufox::gui {
         guiResource.pipelineLayout.emplace(*gpu.device, pipelineLayoutInfo);
     }
 
-    void MakePipeline(const gpu::vulkan::GPUResources& gpu, const gpu::vulkan::SwapchainResource& swapchain, const std::vector<char>& shaderCode, GUIResource& guiResource) {
+    constexpr void MakeRectPipelineLayout(const gpu::vulkan::GPUResources& gpu, GUIResource& guiResource) {
+        const vk::PushConstantRange pushConstantRange{vk::ShaderStageFlagBits::eVertex, 0, sizeof(RectPushConstants)};
+
+        vk::PipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo
+          .setPushConstantRangeCount(1)
+          .setPPushConstantRanges(&pushConstantRange);
+
+        guiResource.rectPipelineLayout.emplace(*gpu.device, pipelineLayoutInfo);
+    }
+
+    // Shared by the GUI pipelines, they only differ in shader, vertex input and layout.
+    vk::raii::Pipeline MakeGUIPipeline(const gpu::vulkan::GPUResources& gpu, const gpu::vulkan::SwapchainResource& swapchain, const std::vector<char>& shaderCode,
+        const vk::PipelineVertexInputStateCreateInfo& vertexInput, const vk::raii::PipelineLayout& layout, const vk::raii::PipelineCache& pipelineCache) {
         vk::raii::ShaderModule shaderModule = gpu::vulkan::CreateShaderModule(gpu ,shaderCode);
         std::array stages = {
             vk::PipelineShaderStageCreateInfo{ {}, vk::ShaderStageFlagBits::eVertex, *shaderModule, "vertMain" },
             vk::PipelineShaderStageCreateInfo{ {}, vk::ShaderStageFlagBits::eFragment, *shaderModule, "fragMain" }
         };
 
-        std::array bindingDescription{geometry::Vertex::getBindingDescription(0)};
-        auto attributeDescriptions = geometry::Vertex::getAttributeDescriptions(0);
-
-        vk::PipelineVertexInputStateCreateInfo vertexInput = gpu::vulkan::MakePipeVertexInputState(bindingDescription, attributeDescriptions);
-
         vk::PipelineInputAssemblyStateCreateInfo inputAssembly{};
         inputAssembly
             .setTopology(vk::PrimitiveTopology::eTriangleList)
@@ -124,22 +139,110 @@ export namespace ufox::gui {
             .setPColorBlendState(&blendState)
             .setPDynamicState(&dynamicState)
             .setPDepthStencilState(&depthStencil)
-            .setLayout(*guiResource.pipelineLayout.value())
+            .setLayout(*layout)
             .setRenderPass(nullptr)
             .setSubpass(0)
             .setPNext(&renderingInfo);
 
+        return vk::raii::Pipeline(*gpu.device, pipelineCache, pipelineInfo);
+    }
+
+    void MakePipeline(const gpu::vulkan::GPUResources& gpu, const gpu::vulkan::SwapchainResource& swapchain, const std::vector<char>& shaderCode, GUIResource& guiResource) {
+        std::array bindingDescription{geometry::Vertex::getBindingDescription(0)};
+        auto attributeDescriptions = geometry::Vertex::getAttributeDescriptions(0);
+
+        vk::PipelineVertexInputStateCreateInfo vertexInput = gpu::vulkan::MakePipeVertexInputState(bindingDescription, attributeDescriptions);
+
         guiResource.pipelineCache.emplace(*gpu.device, vk::PipelineCacheCreateInfo());
-        guiResource.pipeline.emplace(*gpu.device, *guiResource.pipelineCache, pipelineInfo);
+        guiResource.pipeline.emplace(MakeGUIPipeline(gpu, swapchain, shaderCode, vertexInput, *guiResource.pipelineLayout, *guiResource.pipelineCache));
     }
 
+    // Binding 0 is the quad mesh, binding 1 the RectInstance stream right after its attributes.
+    void MakeRectPipeline(const gpu::vulkan::GPUResources& gpu, const gpu::vulkan::SwapchainResource& swapchain, const std::vector<char>& shaderCode, GUIResource& guiResource) {
+        std::array bindingDescriptions{geometry::Vertex::getBindingDescription(0), RectInstance::getBindingDescription(1)};
+
+        const auto vertexAttributes = geometry::Vertex::getAttributeDescriptions(0);
+        const auto instanceAttributes = RectInstance::getAttributeDescriptions(1, static_cast<uint32_t>(vertexAttributes.size()));
+        std::vector<vk::VertexInputAttributeDescription> attributeDescriptions(vertexAttributes.begin(), vertexAttributes.end());
+        attributeDescriptions.insert(attributeDescriptions.end(), instanceAttributes.begin(), instanceAttributes.end());
+
+        vk::PipelineVertexInputStateCreateInfo vertexInput = gpu::vulkan::MakePipeVertexInputState(bindingDescriptions, attributeDescriptions);
+
+        guiResource.rectPipeline.emplace(MakeGUIPipeline(gpu, swapchain, shaderCode, vertexInput, *guiResource.rectPipelineLayout, *guiResource.pipelineCache));
+    }
+
+    // One host-visible buffer holding a copy of the instances per frame in flight. Growing it
+    // waits for the device, the old copies may still be read, so it is only called from the
+    // thread that submits to the graphics queue.
+    inline void ReserveRectInstances(const gpu::vulkan::GPUResources& gpu, GUIResource& guiResource, const uint32_t count) {
+        if (count <= guiResource.rectInstanceCapacity && guiResource.rectInstanceBuffer.data) return;
+
+        const uint32_t capacity = std::max({count, RECT_BATCH_INITIAL_CAPACITY, guiResource.rectInstanceCapacity * 2});
+        const auto frameCount = static_cast<uint32_t>(guiResource.rectBatch.pendingUploads.size());
+
+        if (guiResource.rectInstanceBuffer.data) gpu.device->waitIdle();
+        guiResource.rectInstanceBuffer = gpu::vulkan::MakeBuffer(gpu, static_cast<vk::DeviceSize>(capacity) * frameCount * sizeof(RectInstance),
+            vk::BufferUsageFlagBits::eVertexBuffer, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        guiResource.rectInstanceCapacity = capacity;
+        InvalidateRectBatch(guiResource.rectBatch);
+    }
+
+    [[nodiscard]] constexpr vk::DeviceSize GetRectInstanceOffset(const GUIResource& guiResource, const uint32_t frameIndex) noexcept {
+        return static_cast<vk::DeviceSize>(guiResource.rectInstanceCapacity) * frameIndex * sizeof(RectInstance);
+    }
+
+    // Rebuilds the batch from the laid-out tree, batch.damage holds what changed on screen.
+    // Host memory only, the instance buffer is grown by ReserveRectInstances before the upload.
+    inline uint32_t UpdateRectBatch(GUIResource& guiResource, const geometry::ViewpanelLayoutTree& tree) {
+        return BuildRectBatch(guiResource.rectBatch, tree, guiResource.styles);
+    }
+
+    // Copies only what the copy of frameIndex is missing, after the fence of the frame.
+    inline void UploadRectBatch(GUIResource& guiResource, const uint32_t frameIndex) {
+        const RectBatch& batch = guiResource.rectBatch;
+        const RectInstanceRange range = TakeRectBatchUpload(guiResource.rectBatch, frameIndex);
+        if (range.empty()) return;
+
+        auto* copy = static_cast<std::byte*>(guiResource.rectInstanceBuffer.allocation.mapped()) + GetRectInstanceOffset(guiResource, frameIndex);
+        std::memcpy(copy + range.begin * sizeof(RectInstance), batch.instances.data() + range.begin, (range.end - range.begin) * sizeof(RectInstance));
+    }
+
+    // The whole GUI in one instanced draw of the quad mesh per scissor, inside an active
+    // rendering scope.
+    inline void RecordRectBatch(const vk::raii::CommandBuffer& cmb, const GUIResource& guiResource, const vk::Extent2D& extent, const uint32_t frameIndex,
+        const std::span<const vk::Rect2D> scissors) {
+        const RectBatch& batch = guiResource.rectBatch;
+        if (batch.count == 0 || extent.width == 0 || extent.height == 0) return;
+
+        const geometry::MeshResource& mesh = *guiResource.meshResource;
+
+        cmb.bindPipeline(vk::PipelineBindPoint::eGraphics, *guiResource.rectPipeline);
+        cmb.setViewport(0, vk::Viewport{0.0f, 0.0f, static_cast<float>(extent.width), static_cast<float>(extent.height), 0.0f, 1.0f});
+        cmb.setCullMode(vk::CullModeFlagBits::eNone);
+        cmb.setFrontFace(vk::FrontFace::eClockwise);
+        cmb.setPrimitiveTopology(vk::PrimitiveTopology::eTriangleList);
+
+        const std::array buffers{*mesh.vertexBuffer->data, *guiResource.rectInstanceBuffer.data};
+        const std::array offsets{vk::DeviceSize{0}, GetRectInstanceOffset(guiResource, frameIndex)};
+        cmb.bindVertexBuffers(0, buffers, offsets);
+        cmb.bindIndexBuffer(*mesh.indexBuffer->data, 0, vk::IndexType::eUint16);
+
+        const RectPushConstants constants{{static_cast<float>(extent.width), static_cast<float>(extent.height)}};
+        cmb.pushConstants<RectPushConstants>(*guiResource.rectPipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, constants);
+
+        for (const vk::Rect2D& scissor : scissors) {
+            cmb.setScissor(0, scissor);
+            cmb.drawIndexed(static_cast<uint32_t>(QUAD_INDEX_COUNT), batch.count, 0, 0, 0);
+        }
+    }
+
+    // The uniform data of every swapchain image lives in one frame arena, a segment per image.
+    // Each UBO is the first allocation of its segment, so the descriptor offsets stay valid when
+    // beginFrame rewinds the segment of an image for more transient data.
     constexpr GUIElement MakeGUIElement(const gpu::vulkan::GPUResources& gpu, const GUIResource& guiResource, const uint32_t& minImageCount) {
         GUIElement guiElement{};
 
-        guiElement.uniformBuffers.clear();
         guiElement.uniformBuffersMapped.clear();
-
-        guiElement.uniformBuffers.reserve(minImageCount);
         guiElement.uniformBuffersMapped.reserve(minImageCount);
 
         guiElement.descriptorSets.clear();
@@ -153,15 +256,21 @@ export namespace ufox::gui {
 
         guiElement.descriptorSets = gpu.device->allocateDescriptorSets(allocInfo);
 
-        for (size_t i = 0; i < minImageCount; i++) {
-            guiElement.uniformBuffers.push_back(gpu::vulkan::MakeBuffer(gpu, gpu::vulkan::UBO_BUFFER_SIZE, vk::BufferUsageFlagBits::eUniformBuffer
-                                                        , vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent));
-            guiElement.uniformBuffersMapped.push_back( guiElement.uniformBuffers[i].memory->mapMemory(0, gpu::vulkan::UBO_BUFFER_SIZE));
+        const vk::DeviceSize alignment = gpu.physicalDevice->getProperties().limits.minUniformBufferOffsetAlignment;
+        guiElement.uniformArena = gpu::vulkan::MakeFrameArena(gpu, gpu::memory::AlignUp(gpu::vulkan::UBO_BUFFER_SIZE, alignment), minImageCount,
+            vk::BufferUsageFlagBits::eUniformBuffer);
+
+        for (uint32_t i = 0; i < minImageCount; i++) {
+            guiElement.uniformArena.ring.beginFrame(i);
+            const std::optional<gpu::vulkan::FrameSlice> slice = gpu::vulkan::AllocateFrameData(guiElement.uniformArena, gpu::vulkan::UBO_BUFFER_SIZE, alignment);
+            if (!slice) throw std::runtime_error("GUI uniform arena segment too small");
+
+            guiElement.uniformBuffersMapped.push_back(slice->mapped);
 
             vk::DescriptorBufferInfo bufferInfo{};
             bufferInfo
-                .setBuffer(*guiElement.uniformBuffers[i].data)
-                .setOffset(0)
+                .setBuffer(slice->buffer)
+                .setOffset(slice->offset)
                 .setRange(gpu::vulkan::UBO_BUFFER_SIZE);
 
             vk::WriteDescriptorSet write{};
@@ -178,12 +287,17 @@ export namespace ufox::gui {
         return guiElement;
     }
 
-    constexpr GUIResource MakeGuiResource(const gpu::vulkan::GPUResources& gpu, const gpu::vulkan::SwapchainResource& swapchain, const std::vector<char>& shaderCode) {
+    constexpr GUIResource MakeGuiResource(const gpu::vulkan::GPUResources& gpu, const gpu::vulkan::SwapchainResource& swapchain, const std::vector<char>& shaderCode,
+        const std::vector<char>& rectShaderCode, const uint32_t framesInFlight) {
         GUIResource guiResource{};
 
         MakeDescriptorSetLayout(gpu, guiResource);
         MakePipelineLayout(gpu, guiResource);
         MakePipeline(gpu, swapchain, shaderCode, guiResource);
+        MakeRectPipelineLayout(gpu, guiResource);
+        MakeRectPipeline(gpu, swapchain, rectShaderCode, guiResource);
+        ResizeRectBatchFrames(guiResource.rectBatch, framesInFlight);
+        ReserveRectInstances(gpu, guiResource, RECT_BATCH_INITIAL_CAPACITY);
         guiResource.meshResource.emplace(geometry::CreateDefaultQuadMesh(gpu));
         MakeDescriptorPool(gpu, swapchain.getImageCount(), guiResource);
         guiResource.elements.emplace(MakeGUIElement(gpu, guiResource, swapchain.getImageCount()));
@@ -0,0 +1,219 @@
+module;
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include <vulkan/vulkan_raii.hpp>
+
+export module ufox_gui_batch;
+
+import ufox_lib;
+
+export namespace ufox::gui {
+    constexpr vk::Rect2D ToRect2D(const glm::vec4& rect) noexcept {
+        return {{static_cast<int32_t>(rect.x), static_cast<int32_t>(rect.y)}, {static_cast<uint32_t>(rect.z), static_cast<uint32_t>(rect.w)}};
+    }
+
+    constexpr bool IsRectEmpty(const vk::Rect2D& rect) noexcept {
+        return rect.extent.width == 0 || rect.extent.height == 0;
+    }
+
+    constexpr int64_t GetRectArea(const vk::Rect2D& rect) noexcept {
+        return static_cast<int64_t>(rect.extent.width) * rect.extent.height;
+    }
+
+    constexpr bool IsRectOverlapping(const vk::Rect2D& a, const vk::Rect2D& b) noexcept {
+        return a.offset.x < b.offset.x + static_cast<int32_t>(b.extent.width) && b.offset.x < a.offset.x + static_cast<int32_t>(a.extent.width)
+            && a.offset.y < b.offset.y + static_cast<int32_t>(b.extent.height) && b.offset.y < a.offset.y + static_cast<int32_t>(a.extent.height);
+    }
+
+    constexpr vk::Rect2D UnionRect(const vk::Rect2D& a, const vk::Rect2D& b) noexcept {
+        const int32_t x0 = std::min(a.offset.x, b.offset.x);
+        const int32_t y0 = std::min(a.offset.y, b.offset.y);
+        const int32_t x1 = std::max(a.offset.x + static_cast<int32_t>(a.extent.width), b.offset.x + static_cast<int32_t>(b.extent.width));
+        const int32_t y1 = std::max(a.offset.y + static_cast<int32_t>(a.extent.height), b.offset.y + static_cast<int32_t>(b.extent.height));
+        return {{x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}};
+    }
+
+    constexpr vk::Rect2D ClipRect(const vk::Rect2D& rect, const vk::Extent2D& extent) noexcept {
+        const int32_t x0 = std::clamp(rect.offset.x, 0, static_cast<int32_t>(extent.width));
+        const int32_t y0 = std::clamp(rect.offset.y, 0, static_cast<int32_t>(extent.height));
+        const int32_t x1 = std::clamp(rect.offset.x + static_cast<int32_t>(rect.extent.width), x0, static_cast<int32_t>(extent.width));
+        const int32_t y1 = std::clamp(rect.offset.y + static_cast<int32_t>(rect.extent.height), y0, static_cast<int32_t>(extent.height));
+        return {{x0, y0}, {static_cast<uint32_t>(x1 - x0), static_cast<uint32_t>(y1 - y0)}};
+    }
+
+    inline void AddDamageRegion(std::vector<vk::Rect2D>& regions, vk::Rect2D rect);
+
+    // Replaces the two regions whose bounding box adds the least area with that box.
+    inline void MergeClosestDamageRegions(std::vector<vk::Rect2D>& regions) {
+        size_t first = 0, second = 1;
+        int64_t bestGrowth = std::numeric_limits<int64_t>::max();
+        for (size_t i = 0; i < regions.size(); ++i) {
+            for (size_t j = i + 1; j < regions.size(); ++j) {
+                const int64_t growth = GetRectArea(UnionRect(regions[i], regions[j])) - GetRectArea(regions[i]) - GetRectArea(regions[j]);
+                if (growth < bestGrowth) { bestGrowth = growth; first = i; second = j; }
+            }
+        }
+
+        const vk::Rect2D merged = UnionRect(regions[first], regions[second]);
+        regions[second] = regions.back();
+        regions.pop_back();
+        regions[first] = regions.back();
+        regions.pop_back();
+        AddDamageRegion(regions, merged);
+    }
+
+    // Keeps the regions disjoint: a rect swallows every region it overlaps into their bounding
+    // box, past DAMAGE_REGION_LIMIT the closest regions are merged.
+    inline void AddDamageRegion(std::vector<vk::Rect2D>& regions, vk::Rect2D rect) {
+        if (IsRectEmpty(rect)) return;
+
+        for (size_t i = 0; i < regions.size();) {
+            if (!IsRectOverlapping(regions[i], rect)) { ++i; continue; }
+            rect = UnionRect(regions[i], rect);
+            regions[i] = regions.back();
+            regions.pop_back();
+            i = 0;
+        }
+        regions.push_back(rect);
+
+        if (regions.size() > DAMAGE_REGION_LIMIT) MergeClosestDamageRegions(regions);
+    }
+
+    // Content of the canvas is undefined, the whole extent is damaged.
+    inline void ResetDamageTracker(DamageTracker& tracker, const vk::Extent2D& extent) {
+        tracker.extent = extent;
+        tracker.frame.assign(1, vk::Rect2D{{0, 0}, extent});
+        tracker.fullRepaint = true;
+    }
+
+    inline void AddFrameDamage(DamageTracker& tracker, const std::span<const vk::Rect2D> regions) {
+        for (const vk::Rect2D& rect : regions) AddDamageRegion(tracker.frame, ClipRect(rect, tracker.extent));
+    }
+
+    // An undamaged frame draws nothing new, presenting it can be skipped altogether.
+    [[nodiscard]] inline bool HasFrameDamage(const DamageTracker& tracker) noexcept {
+        return !tracker.frame.empty();
+    }
+
+    // Moves the damage the canvas is missing into regions. Returns true when the canvas has to be
+    // repainted as a whole instead.
+    inline bool TakeFrameDamage(DamageTracker& tracker, std::vector<vk::Rect2D>& regions) {
+        regions.clear();
+        std::swap(regions, tracker.frame);
+
+        const bool full = tracker.fullRepaint;
+        tracker.fullRepaint = false;
+        return full;
+    }
+
+    constexpr glm::vec4 ToColor(const vk::ClearColorValue& color) noexcept {
+        return {color.float32[0], color.float32[1], color.float32[2], color.float32[3]};
+    }
+
+    [[nodiscard]] constexpr const Style* FindStyle(const std::span<const StyleResource> styles, const utilities::NameHandle id) noexcept {
+        if (!id.valid()) return nullptr;
+        for (const StyleResource& style : styles) {
+            if (style.id == id) return &style.content;
+        }
+        return nullptr;
+    }
+
+    // Unstyled panels are flat rects in their clear colors.
+    constexpr RectInstance MakeRectInstance(const geometry::Viewpanel& panel, const vk::Rect2D& rect, const Style* style) noexcept {
+        RectInstance instance{};
+        instance.rect = {static_cast<float>(rect.offset.x), static_cast<float>(rect.offset.y),
+                         static_cast<float>(rect.extent.width), static_cast<float>(rect.extent.height)};
+
+        if (!style) {
+            instance.backgroundColor = ToColor(panel.hovered ? panel.clearColor2 : panel.clearColor);
+            return instance;
+        }
+
+        instance.backgroundColor = panel.hovered ? style->hoverBackgroundColor : style->backgroundColor;
+        instance.borderTopColor = style->borderTopColor;
+        instance.borderRightColor = style->borderRightColor;
+        instance.borderBottomColor = style->borderBottomColor;
+        instance.borderLeftColor = style->borderLeftColor;
+        instance.borderThickness = style->borderThickness;
+        instance.cornerRadius = style->cornerRadius;
+        return instance;
+    }
+
+    // Leaves and styled panels draw, unstyled containers are only covered by their children.
+    constexpr bool IsRectDrawn(const geometry::ViewpanelLayoutTree& tree, const uint32_t index) noexcept {
+        if (IsRectEmpty(tree.rects[index])) return false;
+        return tree.childCounts[index] == 0 || tree.panels[index]->styleId.valid();
+    }
+
+    inline void ResizeRectBatchFrames(RectBatch& batch, const uint32_t frameCount) {
+        batch.pendingUploads.assign(frameCount, RectInstanceRange{0, batch.count});
+    }
+
+    // Every GPU copy has to be rewritten, after the instance buffer was recreated.
+    inline void InvalidateRectBatch(RectBatch& batch) noexcept {
+        for (RectInstanceRange& pending : batch.pendingUploads) pending = RectInstanceRange{0, batch.count};
+    }
+
+    // Walks the laid-out tree once in pre-order, so parents are drawn below their children.
+    // Instances equal to last frame are left alone, only the changed span is queued for the
+    // copies of all frames in flight and the old and new rects of every change are damaged.
+    // Returns the number of rewritten instances.
+    inline uint32_t BuildRectBatch(RectBatch& batch, const geometry::ViewpanelLayoutTree& tree, const std::span<const StyleResource> styles) {
+        batch.damage.clear();
+        RectInstanceRange changedRange{};
+        uint32_t changed = 0;
+        uint32_t count = 0;
+
+        if (batch.instances.size() < tree.size()) batch.instances.resize(tree.size());
+
+        const Style* style = nullptr;
+        utilities::NameHandle styleId{};
+
+        for (uint32_t i = 0; i < tree.size(); ++i) {
+            if (!IsRectDrawn(tree, i)) continue;
+
+            const geometry::Viewpanel& panel = *tree.panels[i];
+            if (panel.styleId != styleId) {
+                styleId = panel.styleId;
+                style = FindStyle(styles, styleId);
+            }
+
+            const RectInstance instance = MakeRectInstance(panel, tree.rects[i], style);
+            RectInstance& slot = batch.instances[count];
+            const bool existed = count < batch.count;
+            if (!existed || std::memcmp(&slot, &instance, sizeof(RectInstance)) != 0) {
+                if (existed) AddDamageRegion(batch.damage, ToRect2D(slot.rect));
+                AddDamageRegion(batch.damage, tree.rects[i]);
+                slot = instance;
+                changedRange.merge({count, count + 1});
+                ++changed;
+            }
+            ++count;
+        }
+
+        for (uint32_t removed = count; removed < batch.count; ++removed) {
+            AddDamageRegion(batch.damage, ToRect2D(batch.instances[removed].rect));
+        }
+
+        batch.count = count;
+        batch.changed = changed;
+        for (RectInstanceRange& pending : batch.pendingUploads) {
+            pending.merge(changedRange);
+            pending.end = std::min(pending.end, count);
+        }
+        return changed;
+    }
+
+    // What the copy of frameIndex is missing, cleared once taken.
+    [[nodiscard]] inline RectInstanceRange TakeRectBatchUpload(RectBatch& batch, const uint32_t frameIndex) noexcept {
+        RectInstanceRange range{};
+        std::swap(range, batch.pendingUploads[frameIndex]);
+        return range;
+    }
+}
@@ -1,7 +1,13 @@
 module;
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <memory>
+#include <optional>
 #include <SDL3/SDL_mouse.h>
 #include <glm/glm.hpp>
 
@@ -13,77 +19,199 @@ module;
 
 export module ufox_input;
 
-import ufox_lib;  // For GenerateUniqueID
+import ufox_lib;
 
 export  namespace ufox::input {
+    constexpr char INPUT_TRACE_MAGIC[8] = {'U', 'F', 'O', 'X', 'I', 'N', 'P', 'T'};
+    constexpr uint32_t INPUT_TRACE_VERSION = 1;
+
+    struct InputTraceHeader {
+        char        magic[8]{};
+        uint32_t    version{0};
+        uint32_t    eventCount{0};
+    };
+
+    static_assert(sizeof(InputTraceHeader) == 16);
+
+    // Reads the time point it is bound to, the caller advances it.
+    inline InputClock MakeManualInputClock(const std::chrono::steady_clock::time_point& time) noexcept {
+        return InputClock{[](const void* context) { return *static_cast<const std::chrono::steady_clock::time_point*>(context); }, &time};
+    }
+
+    inline void RecordInputEvent(InputTrace& trace, InputTraceEvent event, const std::chrono::steady_clock::time_point timestamp) {
+        if (!trace.events.empty()) {
+            const auto delta = std::chrono::duration_cast<std::chrono::microseconds>(timestamp - trace.lastTime).count();
+            event.deltaMicroseconds = static_cast<uint32_t>(std::clamp<int64_t>(delta, 0, UINT32_MAX));
+        }
+        trace.lastTime = timestamp;
+        trace.events.push_back(event);
+    }
+
+    inline void RecordInputEvent(InputResource& res, const InputEvent& event) {
+        if (!res.recording) return;
+        RecordInputEvent(*res.recording, InputTraceEvent{0, event.position.x, event.position.y, event.value1, event.value2,
+            static_cast<InputTraceEventType>(event.type), static_cast<uint8_t>(event.button), static_cast<uint8_t>(event.phase)}, event.timestamp);
+    }
+
+    // Resizes skip the event queue, the platform callback lays the viewport out right away.
+    inline void RecordResize(InputResource& res, const int width, const int height) {
+        if (!res.recording) return;
+        RecordInputEvent(*res.recording, InputTraceEvent{0, width, height, 0.0f, 0.0f, InputTraceEventType::eResize}, res.clock.now());
+    }
+
+    inline bool SaveInputTrace(const InputTrace& trace, const std::filesystem::path& path) {
+        std::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            debug::log<debug::LogLevel::eError, debug::LogCategory::eInput>("Failed to write input trace {}", path.string());
+            return false;
+        }
+
+        InputTraceHeader header{};
+        std::memcpy(header.magic, INPUT_TRACE_MAGIC, sizeof(header.magic));
+        header.version = INPUT_TRACE_VERSION;
+        header.eventCount = static_cast<uint32_t>(trace.events.size());
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(trace.events.data()), static_cast<std::streamsize>(trace.events.size() * sizeof(InputTraceEvent)));
+        return static_cast<bool>(out);
+    }
+
+    inline std::optional<InputTrace> LoadInputTrace(const std::filesystem::path& path) {
+        std::ifstream in(path, std::ios::in | std::ios::binary);
+        InputTraceHeader header{};
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+            || std::memcmp(header.magic, INPUT_TRACE_MAGIC, sizeof(header.magic)) != 0 || header.version != INPUT_TRACE_VERSION) {
+            debug::log<debug::LogLevel::eError, debug::LogCategory::eInput>("Not an input trace: {}", path.string());
+            return std::nullopt;
+        }
+
+        InputTrace trace{};
+        trace.events.resize(header.eventCount);
+        if (!in.read(reinterpret_cast<char*>(trace.events.data()), static_cast<std::streamsize>(trace.events.size() * sizeof(InputTraceEvent)))) {
+            debug::log<debug::LogLevel::eError, debug::LogCategory::eInput>("Truncated input trace: {}", path.string());
+            return std::nullopt;
+        }
+        return trace;
+    }
+
     void RefreshResources(InputResource& res) {
         res.refresh();
     }
 
-    void UpdateGlobalMousePosition(const windowing::WindowResource& window, InputResource& res) {
-        switch (res.mouseMotionState) {
-            case MouseMotionState::Moving: {
-                res.onMouseMove();
-                res.mouseMotionState = MouseMotionState::Stopping;
-            }
-            case MouseMotionState::Stopping: {
-                res.onMouseStop();
-                res.mouseDelta = glm::ivec2{0,0};
-                res.mouseMotionState = MouseMotionState::Idle;
-            }
-            case MouseMotionState::Idle: {
-#ifdef USE_SDL
-                float x,y;
-                SDL_GetGlobalMouseState(&x,&y);
-                x = x - static_cast<float>(window.position.x);
-                y = y - static_cast<float>(window.position.y);
-#else
-                double x,y;
-                glfwGetCursorPos(window.getHandle(), &x, &y);
-#endif
-                glm::ivec2 pos = {static_cast<int>(x), static_cast<int>(y)};
-                res.updateMouseDelta(pos);
+    inline void PushInputEvent(InputResource& res, const InputEvent& event) {
+        res.events.push(event);
+        RecordInputEvent(res, event);
+    }
 
-                if (res.getMouseDeltaMagnitude() > 0.0f) {
-                    res.mousePosition = pos;
-                    res.mouseMotionState = MouseMotionState::Moving;
-                }
-            }
-            default: ;
-        }
+    // Producer side, called from the platform event callbacks.
+    void PushMouseMotion(InputResource& res, const float& x, const float& y) {
+        res.queuedMousePosition = glm::ivec2{static_cast<int>(x), static_cast<int>(y)};
+        PushInputEvent(res, InputEvent{res.clock.now(), InputEventType::eMouseMotion, MouseButton::eNone, ActionPhase::eSleep,
+            res.queuedMousePosition});
+    }
+
+    void PushMouseWheel(InputResource& res, const float& x, const float& y) {
+        PushInputEvent(res, InputEvent{res.clock.now(), InputEventType::eMouseWheel, MouseButton::eNone, ActionPhase::eSleep,
+            glm::ivec2{static_cast<int>(x), static_cast<int>(y)}});
+    }
+
+    // The edge is stamped with the last pushed motion, the motion still queued ahead of it
+    // has not reached mousePosition yet.
+    void CatchMouseButton(InputResource& res, MouseButton button, ActionPhase phase, const float& value1, const float& value2) {
+        PushInputEvent(res, InputEvent{res.clock.now(), InputEventType::eMouseButton, button, phase, res.queuedMousePosition, value1, value2});
+    }
+
+    constexpr uint8_t MouseButtonBit(const MouseButton button) noexcept {
+        return static_cast<uint8_t>(1u << static_cast<uint8_t>(button));
+    }
+
+    // Applies one edge and dispatches it right away, so a press and release drained in the same
+    // frame both reach the callbacks. Returns false for buttons without an action.
+    bool ApplyMouseButtonEvent(InputResource& res, const InputEvent& event) {
+        Action* action = event.button == MouseButton::eLeft ? &res.leftMouseButtonAction
+                       : event.button == MouseButton::eRight ? &res.rightMouseButtonAction
+                       : event.button == MouseButton::eMiddle ? &res.middleMouseButtonAction
+                       : nullptr;
+        if (!action) return false;
+
+        action->phase = event.phase;
+        action->value1 = event.value1;
+        action->value2 = event.value2;
+        action->startTime = event.timestamp;
+
+        if (event.button == MouseButton::eLeft) res.onLeftMouseButton();
+        else if (event.button == MouseButton::eRight) res.onRightMouseButton();
+        else res.onMiddleMouseButton();
+        return true;
     }
 
-    void UpdateMouseButtonAction(InputResource& res) {
-        if (res.leftMouseButtonAction.phase != ActionPhase::eSleep) {
+    // Per frame dispatch of the held buttons, the ones that already dispatched an edge this
+    // frame are skipped.
+    void UpdateMouseButtonAction(InputResource& res, const uint8_t dispatched = 0) {
+        if (res.leftMouseButtonAction.phase != ActionPhase::eSleep && !(dispatched & MouseButtonBit(MouseButton::eLeft))) {
             res.onLeftMouseButton();
         }
 
-        if (res.rightMouseButtonAction.phase != ActionPhase::eSleep) {
+        if (res.rightMouseButtonAction.phase != ActionPhase::eSleep && !(dispatched & MouseButtonBit(MouseButton::eRight))) {
             res.onRightMouseButton();
         }
 
-        if (res.middleMouseButtonAction.phase != ActionPhase::eSleep) {
+        if (res.middleMouseButtonAction.phase != ActionPhase::eSleep && !(dispatched & MouseButtonBit(MouseButton::eMiddle))) {
             res.onMiddleMouseButton();
         }
     }
 
-    void CatchMouseButton(InputResource& res, MouseButton button, ActionPhase phase, const float& value1, const float& value2) {
-        if (button == MouseButton::eLeft) {
-            res.leftMouseButtonAction.phase = phase;
-            res.leftMouseButtonAction.value1 = value1;
-            res.leftMouseButtonAction.value2 = value2;
-            res.leftMouseButtonAction.startTime = std::chrono::steady_clock::now();
-        }else if (button == MouseButton::eRight) {
-            res.rightMouseButtonAction.phase = phase;
-            res.rightMouseButtonAction.value1 = value1;
-            res.rightMouseButtonAction.value2 = value2;
-            res.rightMouseButtonAction.startTime = std::chrono::steady_clock::now();
-        }else if (button == MouseButton::eMiddle) {
-            res.middleMouseButtonAction.phase = phase;
-            res.middleMouseButtonAction.value1 = value1;
-            res.middleMouseButtonAction.value2 = value2;
-            res.middleMouseButtonAction.startTime = std::chrono::steady_clock::now();
+    // Drains the frame's events in order. Motion is coalesced to its last position, so a
+    // 1000 Hz mouse costs one move dispatch per frame; the first frame without motion
+    // dispatches the stop. Button edges are dispatched one by one in order, at the position they
+    // were pushed with, wheel steps are summed.
+    void ProcessInputEvents(InputResource& res) {
+        if (res.recording) RecordInputEvent(*res.recording, InputTraceEvent{}, res.clock.now());
+
+        const glm::ivec2 framePosition = res.mousePosition;
+        glm::ivec2 motionTarget = framePosition;
+        uint32_t motionCount = 0;
+        uint8_t dispatchedButtons = 0;
+
+        InputEvent event{};
+        while (res.events.pop(event)) {
+            switch (event.type) {
+                case InputEventType::eMouseMotion: {
+                    motionTarget = event.position;
+                    res.lastMotionTime = event.timestamp;
+                    ++motionCount;
+                    break;
+                }
+                case InputEventType::eMouseButton: {
+                    res.mousePosition = event.position;
+                    if (ApplyMouseButtonEvent(res, event)) dispatchedButtons |= MouseButtonBit(event.button);
+                    break;
+                }
+                case InputEventType::eMouseWheel: {
+                    res.mouseWheel += event.position;
+                    break;
+                }
+            }
         }
+
+        res.mouseDelta = motionTarget - framePosition;
+        res.coalescedMotionCount = motionCount;
+        res.mousePosition = motionTarget;
+
+        if (res.mouseDelta != glm::ivec2{0, 0}) {
+            res.mouseMotionState = MouseMotionState::Moving;
+            res.onMouseMove();
+        } else if (res.mouseMotionState == MouseMotionState::Moving) {
+            res.mouseMotionState = MouseMotionState::Stopping;
+            res.onMouseStop();
+            res.mouseMotionState = MouseMotionState::Idle;
+        }
+
+        if (res.mouseWheel != glm::ivec2{0, 0}) {
+            res.onMouseWheel();
+        }
+
+        UpdateMouseButtonAction(res, dispatchedButtons);
     }
 
 
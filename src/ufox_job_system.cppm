@@ -0,0 +1,465 @@
+module;
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+export module ufox_job_system;
+
+export namespace ufox::jobs {
+    using Job = std::function<void()>;
+
+    class JobCounter;
+
+    // One submitted job. It sits in two queues, a worker deque the pool takes it from and the
+    // queue of its counter a waiting thread takes it from. Whoever claims it first runs it, the
+    // other queue drops the claimed entry once it reaches it.
+    struct QueuedJob {
+        Job                 job{};
+        JobCounter*         counter{nullptr};
+        std::atomic<bool>   claimed{false};
+    };
+
+    // Counts the jobs of a group still in flight and queues the ones not started yet. Waiting on
+    // it runs the queued jobs of the group on the waiting thread, so nested fan-outs never block
+    // a worker, and sleeps once only running ones are left. The first exception a job of the
+    // group throws is kept and rethrown by the wait.
+    class JobCounter {
+    public:
+        JobCounter() = default;
+        ~JobCounter() = default;
+
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        void add(const uint32_t count = 1) noexcept { pending.fetch_add(count, std::memory_order_relaxed); }
+        void done() noexcept { pending.fetch_sub(1, std::memory_order_acq_rel); }
+        [[nodiscard]] bool isDone() const noexcept { return pending.load(std::memory_order_acquire) == 0; }
+
+        // Jobs of the group queued and not claimed by any thread yet.
+        [[nodiscard]] uint32_t queued() const noexcept { return unclaimed.load(std::memory_order_acquire); }
+
+        // Called before done() of the throwing job, so the exception is visible once isDone().
+        void fail(std::exception_ptr exception) noexcept {
+            if (!failed.exchange(true, std::memory_order_acq_rel)) error = std::move(exception);
+        }
+
+        // The kept exception, cleared so the counter can be reused.
+        [[nodiscard]] std::exception_ptr takeError() noexcept {
+            if (!failed.exchange(false, std::memory_order_acq_rel)) return nullptr;
+            return std::exchange(error, nullptr);
+        }
+
+    private:
+        friend class ThreadPool;
+
+        std::atomic<uint32_t>                       pending{0};
+        std::atomic<uint32_t>                       unclaimed{0};
+        std::atomic<bool>                           failed{false};
+        std::exception_ptr                          error{};
+        std::mutex                                  queueMutex{};
+        std::deque<std::shared_ptr<QueuedJob>>      queue{};
+    };
+
+    // Fixed pool of workers, each owning a mutex guarded deque: the owner pushes and pops at the
+    // back, idle workers steal from the front of the others. Jobs submitted from outside the
+    // pool go to a shared injection queue. Every job is queued on its counter as well, so a
+    // thread waiting on a group takes the jobs of that group in constant time instead of
+    // searching the deques. Idle workers sleep on a condition variable, waiting threads on a
+    // progress count bumped whenever a job is queued or finishes.
+    class ThreadPool {
+    public:
+        static constexpr size_t EXTERNAL_THREAD = static_cast<size_t>(-1);
+
+        explicit ThreadPool(const size_t workerCount = DefaultWorkerCount()) {
+            const size_t count = std::max<size_t>(1, workerCount);
+
+            queues.reserve(count + 1);
+            for (size_t i = 0; i < count + 1; ++i) {
+                queues.push_back(std::make_unique<WorkQueue>());
+            }
+
+            workers.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                workers.emplace_back([this, i] { workerLoop(i); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock(sleepMutex);
+                stopping = true;
+            }
+            wake.notify_all();
+
+            for (auto& worker : workers) {
+                if (worker.joinable()) worker.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        [[nodiscard]] static size_t DefaultWorkerCount() noexcept {
+            const unsigned int hardware = std::thread::hardware_concurrency();
+            return hardware > 1 ? hardware - 1 : 1;
+        }
+
+        [[nodiscard]] size_t workerCount() const noexcept { return workers.size(); }
+
+        // Index of the calling worker in [0, workerCount()), EXTERNAL_THREAD for other threads.
+        [[nodiscard]] size_t currentWorkerIndex() const noexcept {
+            return currentPool == this ? currentWorker : EXTERNAL_THREAD;
+        }
+
+        // The counter must stay alive until a wait on it returned, so submit either from the
+        // thread that waits or from a job of the same group.
+        void submit(Job job, JobCounter& counter) {
+            counter.add();
+            auto queued = std::make_shared<QueuedJob>();
+            queued->job = std::move(job);
+            queued->counter = &counter;
+            const size_t self = currentWorkerIndex();
+            WorkQueue& queue = *queues[self == EXTERNAL_THREAD ? workers.size() : self];
+
+            // counted before it can be claimed, so neither count goes below zero
+            counter.unclaimed.fetch_add(1, std::memory_order_relaxed);
+            queuedJobs.fetch_add(1, std::memory_order_release);
+            {
+                std::lock_guard lock(counter.queueMutex);
+                // the front entries the pool already ran are dropped here, the waiter pops the back
+                while (!counter.queue.empty() && counter.queue.front()->claimed.load(std::memory_order_relaxed)) counter.queue.pop_front();
+                counter.queue.push_back(queued);
+            }
+            {
+                std::lock_guard lock(queue.mutex);
+                queue.jobs.push_back(std::move(queued));
+            }
+            signalProgress();
+
+            {
+                // a worker between its wake predicate and the actual wait must not miss this
+                std::lock_guard lock(sleepMutex);
+            }
+            wake.notify_one();
+        }
+
+        // Runs the queued jobs of the counter on the calling thread until it drains, sleeping
+        // while only running ones are left. Jobs of other groups are left to the workers, a long
+        // unrelated job can not delay the waiting thread. Rethrows the first exception a job of
+        // the counter threw.
+        void wait(JobCounter& counter) {
+            while (true) {
+                const uint32_t observed = progress.load(std::memory_order_acquire);
+                if (counter.isDone()) break;
+                if (runGroup(counter)) continue;
+                progress.wait(observed, std::memory_order_acquire);
+            }
+            if (std::exception_ptr error = counter.takeError()) std::rethrow_exception(error);
+        }
+
+        // Runs one queued job of the counter on the calling thread, false when none is queued.
+        bool tryRun(JobCounter& counter) {
+            return runGroup(counter);
+        }
+
+    private:
+        struct WorkQueue {
+            std::mutex                                  mutex{};
+            std::deque<std::shared_ptr<QueuedJob>>      jobs{};
+        };
+
+        bool claim(QueuedJob& job) noexcept {
+            if (job.claimed.exchange(true, std::memory_order_acq_rel)) return false;
+            job.counter->unclaimed.fetch_sub(1, std::memory_order_relaxed);
+            queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        // Pops from the back, entries claimed through the other queue are dropped on the way.
+        template<typename Queue>
+        std::shared_ptr<QueuedJob> popBack(Queue& jobs) {
+            while (!jobs.empty()) {
+                std::shared_ptr<QueuedJob> job = std::move(jobs.back());
+                jobs.pop_back();
+                if (claim(*job)) return job;
+            }
+            return nullptr;
+        }
+
+        std::shared_ptr<QueuedJob> popOwn(const size_t self) {
+            WorkQueue& queue = *queues[self];
+            std::lock_guard lock(queue.mutex);
+            return popBack(queue.jobs);
+        }
+
+        std::shared_ptr<QueuedJob> steal(const size_t queueIndex) {
+            WorkQueue& queue = *queues[queueIndex];
+            std::lock_guard lock(queue.mutex);
+
+            while (!queue.jobs.empty()) {
+                std::shared_ptr<QueuedJob> job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+                if (claim(*job)) return job;
+            }
+            return nullptr;
+        }
+
+        bool runGroup(JobCounter& counter) {
+            std::shared_ptr<QueuedJob> job{};
+            {
+                std::lock_guard lock(counter.queueMutex);
+                job = popBack(counter.queue);
+            }
+            if (!job) return false;
+
+            run(*job);
+            return true;
+        }
+
+        bool tryRunOne(const size_t self) {
+            std::shared_ptr<QueuedJob> job{};
+            if (self != EXTERNAL_THREAD) job = popOwn(self);
+
+            const size_t queueCount = queues.size();
+            const size_t start = self == EXTERNAL_THREAD ? queueCount - 1 : self + 1;
+            for (size_t i = 0; !job && i < queueCount; ++i) {
+                const size_t victim = (start + i) % queueCount;
+                if (victim != self) job = steal(victim);
+            }
+
+            if (!job) return false;
+
+            run(*job);
+            return true;
+        }
+
+        // The job is released before done(), the stale entry left in the other queue holds
+        // nothing but the node.
+        void run(QueuedJob& queued) {
+            JobCounter& counter = *queued.counter;
+            {
+                const Job job = std::move(queued.job);
+                try {
+                    job();
+                } catch (...) {
+                    counter.fail(std::current_exception());
+                }
+            }
+            counter.done();
+            signalProgress();
+        }
+
+        // The waiting threads sleep on the pool, never on a counter, a counter may be destroyed
+        // as soon as its wait returned.
+        void signalProgress() noexcept {
+            progress.fetch_add(1, std::memory_order_release);
+            progress.notify_all();
+        }
+
+        void workerLoop(const size_t index) {
+            currentPool = this;
+            currentWorker = index;
+
+            while (true) {
+                if (tryRunOne(index)) continue;
+
+                std::unique_lock lock(sleepMutex);
+                wake.wait(lock, [this] { return stopping || queuedJobs.load(std::memory_order_acquire) > 0; });
+                if (stopping) return;
+            }
+        }
+
+        std::vector<std::unique_ptr<WorkQueue>>     queues{};   // one per worker, the last one takes external submits
+        std::vector<std::thread>                    workers{};
+        std::atomic<size_t>                         queuedJobs{0};
+        std::atomic<uint32_t>                       progress{0};
+        std::mutex                                  sleepMutex{};
+        std::condition_variable                     wake{};
+        bool                                        stopping{false};
+
+        static inline thread_local const ThreadPool*    currentPool{nullptr};
+        static inline thread_local size_t               currentWorker{EXTERNAL_THREAD};
+    };
+
+    enum class TaskAffinity : uint8_t {
+        eAny,           // any pool worker
+        eMainThread,    // the thread executing the graph, for window system and present calls
+    };
+
+    using TaskId = uint32_t;
+
+    // Dependency graph built once and executed many times, e.g. once per frame. Every execute
+    // resets the dependency counters, a finished task decrements the counters of its successors
+    // and submits the ones that reached zero as continuations, nothing blocks on a dependency.
+    // A task that throws still completes so the graph drains, the tasks not started yet are
+    // skipped and execute rethrows the first exception.
+    class TaskGraph {
+    public:
+        TaskGraph() = default;
+        ~TaskGraph() = default;
+
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+
+        TaskId add(Job job, const TaskAffinity affinity = TaskAffinity::eAny) {
+            tasks.push_back(Task{std::move(job), {}, 0, affinity});
+            validated = false;
+            return static_cast<TaskId>(tasks.size() - 1);
+        }
+
+        // after only starts once before finished.
+        void precede(const TaskId before, const TaskId after) {
+            if (before >= tasks.size() || after >= tasks.size() || before == after) throw std::invalid_argument("TaskGraph: invalid dependency");
+            tasks[before].successors.push_back(after);
+            ++tasks[after].dependencyCount;
+            validated = false;
+        }
+
+        [[nodiscard]] size_t size() const noexcept { return tasks.size(); }
+
+        void clear() {
+            tasks.clear();
+            validated = false;
+        }
+
+        // Runs every task once and returns when all of them finished. The calling thread runs the
+        // main thread tasks and, while none is ready, the queued pool tasks of this graph, so the
+        // graph makes progress even when every worker is busy with a long unrelated job. It never
+        // picks up jobs of other groups.
+        void execute(ThreadPool& pool) {
+            if (tasks.empty()) return;
+            if (!validated) validate();
+
+            if (remainingCount != tasks.size()) {
+                remaining = std::make_unique<std::atomic<uint32_t>[]>(tasks.size());
+                remainingCount = tasks.size();
+            }
+            for (size_t i = 0; i < tasks.size(); ++i) remaining[i].store(tasks[i].dependencyCount, std::memory_order_relaxed);
+            failed.store(false, std::memory_order_relaxed);
+            failure = nullptr;
+            unfinished.store(static_cast<uint32_t>(tasks.size()), std::memory_order_release);
+
+            for (TaskId id = 0; id < tasks.size(); ++id) {
+                if (tasks[id].dependencyCount == 0) schedule(pool, id);
+            }
+
+            while (true) {
+                std::unique_lock lock(mainMutex);
+                mainWake.wait(lock, [this] {
+                    return !mainReady.empty() || poolJobs.queued() > 0 || unfinished.load(std::memory_order_acquire) == 0;
+                });
+
+                if (!mainReady.empty()) {
+                    const TaskId id = mainReady.back();
+                    mainReady.pop_back();
+                    lock.unlock();
+                    run(pool, id);
+                    continue;
+                }
+                lock.unlock();
+
+                if (unfinished.load(std::memory_order_acquire) == 0) break;
+                // fails when a worker claimed the task first, the predicate then sleeps again
+                pool.tryRun(poolJobs);
+            }
+
+            // the last pool task may still be returning from its job
+            pool.wait(poolJobs);
+            if (failure) std::rethrow_exception(std::exchange(failure, nullptr));
+        }
+
+    private:
+        struct Task {
+            Job                     job{};
+            std::vector<TaskId>     successors{};
+            uint32_t                dependencyCount{0};
+            TaskAffinity            affinity{TaskAffinity::eAny};
+        };
+
+        // Kahn's walk, a cycle would leave its tasks waiting forever.
+        void validate() const {
+            std::vector<uint32_t> pending(tasks.size());
+            std::vector<TaskId> ready{};
+            for (TaskId id = 0; id < tasks.size(); ++id) {
+                pending[id] = tasks[id].dependencyCount;
+                if (pending[id] == 0) ready.push_back(id);
+            }
+
+            size_t visited = 0;
+            while (!ready.empty()) {
+                const TaskId id = ready.back();
+                ready.pop_back();
+                ++visited;
+                for (const TaskId successor : tasks[id].successors) {
+                    if (--pending[successor] == 0) ready.push_back(successor);
+                }
+            }
+            if (visited != tasks.size()) throw std::logic_error("TaskGraph: dependency cycle");
+        }
+
+        void schedule(ThreadPool& pool, const TaskId id) {
+            if (tasks[id].affinity == TaskAffinity::eMainThread) {
+                {
+                    std::lock_guard lock(mainMutex);
+                    mainReady.push_back(id);
+                }
+                mainWake.notify_one();
+                return;
+            }
+
+            // submit counts the task as queued on poolJobs before the executing thread is woken
+            pool.submit([this, &pool, id] { run(pool, id); }, poolJobs);
+            {
+                std::lock_guard lock(mainMutex);
+            }
+            mainWake.notify_one();
+        }
+
+        void run(ThreadPool& pool, const TaskId id) {
+            if (!failed.load(std::memory_order_acquire)) {
+                try {
+                    tasks[id].job();
+                } catch (...) {
+                    if (!failed.exchange(true, std::memory_order_acq_rel)) failure = std::current_exception();
+                }
+            }
+            complete(pool, id);
+        }
+
+        void complete(ThreadPool& pool, const TaskId id) {
+            for (const TaskId successor : tasks[id].successors) {
+                if (remaining[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) schedule(pool, successor);
+            }
+
+            if (unfinished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                {
+                    std::lock_guard lock(mainMutex);
+                }
+                mainWake.notify_one();
+            }
+        }
+
+        std::vector<Task>                           tasks{};
+        std::unique_ptr<std::atomic<uint32_t>[]>    remaining{};    // dependencies left per task in the current execute
+        size_t                                      remainingCount{0};
+        std::atomic<uint32_t>                       unfinished{0};
+        std::atomic<bool>                           failed{false};
+        std::exception_ptr                          failure{};              // first exception of the current execute
+        JobCounter                                  poolJobs{};
+        std::mutex                                  mainMutex{};
+        std::condition_variable                     mainWake{};
+        std::vector<TaskId>                         mainReady{};
+        bool                                        validated{false};
+    };
+}
@@ -16,7 +16,23 @@ module;
 #include <format>
 
 #include <functional>
+#include <deque>
 #include <ranges>
+#include <shared_mutex>
+#include <unordered_map>
+#include <memory>
+#include <memory_resource>
+#include <bit>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <source_location>
+#include <thread>
+#include <tuple>
+#include <concepts>
+#include <cstddef>
+#include <new>
+#include <type_traits>
 
 #include <vulkan/vulkan_raii.hpp>
 
@@ -36,8 +52,20 @@ module;
 
 #endif
 
+#ifndef UFOX_LOG_MIN_LEVEL
+#define UFOX_LOG_MIN_LEVEL 0
+#endif
+
+#ifndef UFOX_LOG_CATEGORY_MASK
+#define UFOX_LOG_CATEGORY_MASK 0xFFFFFFFFu
+#endif
+
 export module ufox_lib;
 
+export import ufox_job_system;
+export import ufox_profiler;
+export import ufox_memory_allocator;
+
 
 
 export namespace ufox {
@@ -97,23 +125,173 @@ export namespace ufox {
             return hash;
         }
 
-        constexpr  size_t GenerateUniqueID(std::string_view sv) {
-            std::vector<float> chars;
-            chars.reserve(sv.size());
-            for (char c : sv) {
-                chars.push_back(static_cast<unsigned char>(c));
-            }
-            return GenerateUniqueID(chars);
+        // 64x64 -> 128 bit multiply folded into (lo, hi), portable so it stays constexpr.
+        constexpr void MultiplyFull64(uint64_t& a, uint64_t& b) noexcept {
+            const uint64_t aLo = a & 0xFFFFFFFFull, aHi = a >> 32;
+            const uint64_t bLo = b & 0xFFFFFFFFull, bHi = b >> 32;
+            const uint64_t loLo = aLo * bLo, hiLo = aHi * bLo, loHi = aLo * bHi, hiHi = aHi * bHi;
+            const uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFFull) + loHi;
+            a = (cross << 32) | (loLo & 0xFFFFFFFFull);
+            b = (hiLo >> 32) + (cross >> 32) + hiHi;
+        }
+
+        constexpr uint64_t HashMix64(uint64_t a, uint64_t b) noexcept {
+            MultiplyFull64(a, b);
+            return a ^ b;
+        }
+
+        // Little endian reads byte by byte, compilers fold them into plain loads.
+        constexpr uint64_t ReadHashBytes(const std::string_view bytes, const size_t offset, const size_t count) noexcept {
+            uint64_t value = 0;
+            for (size_t i = 0; i < count; ++i) value |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[offset + i])) << (8 * i);
+            return value;
         }
 
-        constexpr  size_t GenerateUniqueID(const char* str) {
-            return GenerateUniqueID(std::string_view(str));
+        // wyhash (final v4) over a string. constexpr, so literal IDs are computed at compile time,
+        // and allocation free at runtime. The value is stable across runs and platforms.
+        constexpr uint64_t HashString(const std::string_view text, uint64_t seed = 0) noexcept {
+            constexpr uint64_t SECRET[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+            const size_t length = text.size();
+            seed ^= HashMix64(seed ^ SECRET[0], SECRET[1]);
+            uint64_t a = 0, b = 0;
+
+            if (length <= 16) {
+                if (length >= 4) {
+                    const size_t step = (length >> 3) << 2;
+                    a = (ReadHashBytes(text, 0, 4) << 32) | ReadHashBytes(text, step, 4);
+                    b = (ReadHashBytes(text, length - 4, 4) << 32) | ReadHashBytes(text, length - 4 - step, 4);
+                } else if (length > 0) {
+                    a = (static_cast<uint64_t>(static_cast<uint8_t>(text[0])) << 16) |
+                        (static_cast<uint64_t>(static_cast<uint8_t>(text[length >> 1])) << 8) |
+                        static_cast<uint64_t>(static_cast<uint8_t>(text[length - 1]));
+                }
+            } else {
+                size_t remain = length;
+                size_t offset = 0;
+                if (remain >= 48) {
+                    uint64_t see1 = seed, see2 = seed;
+                    do {
+                        seed = HashMix64(ReadHashBytes(text, offset, 8) ^ SECRET[1], ReadHashBytes(text, offset + 8, 8) ^ seed);
+                        see1 = HashMix64(ReadHashBytes(text, offset + 16, 8) ^ SECRET[2], ReadHashBytes(text, offset + 24, 8) ^ see1);
+                        see2 = HashMix64(ReadHashBytes(text, offset + 32, 8) ^ SECRET[3], ReadHashBytes(text, offset + 40, 8) ^ see2);
+                        offset += 48;
+                        remain -= 48;
+                    } while (remain >= 48);
+                    seed ^= see1 ^ see2;
+                }
+                while (remain > 16) {
+                    seed = HashMix64(ReadHashBytes(text, offset, 8) ^ SECRET[1], ReadHashBytes(text, offset + 8, 8) ^ seed);
+                    offset += 16;
+                    remain -= 16;
+                }
+                a = ReadHashBytes(text, offset + remain - 16, 8);
+                b = ReadHashBytes(text, offset + remain - 8, 8);
+            }
+
+            a ^= SECRET[1];
+            b ^= seed;
+            MultiplyFull64(a, b);
+            return HashMix64(a ^ SECRET[0] ^ length, b ^ SECRET[1]);
         }
 
-        constexpr size_t GenerateUniqueID(const std::string& str) {
-            return GenerateUniqueID(std::string_view(str));
+        static_assert(HashString("") != HashString("a") && HashString("left-mouse-button") != HashString("right-mouse-button"));
+
+        // Compact, process local handle of an interned string. Equal strings always intern to the
+        // same handle, so comparing names and paths is an integer compare.
+        struct NameHandle {
+            static constexpr uint32_t INVALID = std::numeric_limits<uint32_t>::max();
+            uint32_t value{INVALID};
+
+            [[nodiscard]] constexpr bool valid() const noexcept { return value != INVALID; }
+            constexpr bool operator==(const NameHandle&) const noexcept = default;
+        };
+
+        // Thread safe string -> NameHandle registry. Lookups take a shared lock, only new strings
+        // take the exclusive one. Strings whose 64-bit hashes collide are chained and told apart
+        // by their contents, so a collision never aliases two names.
+        class InternTable {
+        public:
+            NameHandle intern(const std::string_view text) { return intern(text, HashString(text)); }
+
+            // hash must be HashString(text), e.g. computed at compile time for a literal.
+            NameHandle intern(const std::string_view text, const uint64_t hash) {
+                {
+                    std::shared_lock lock(mutex);
+                    if (const NameHandle found = findLocked(text, hash); found.valid()) return found;
+                }
+
+                std::unique_lock lock(mutex);
+                if (const NameHandle found = findLocked(text, hash); found.valid()) return found;
+
+                const NameHandle handle{static_cast<uint32_t>(entries.size())};
+                const auto [it, inserted] = heads.try_emplace(hash, handle.value);
+                uint32_t next = NameHandle::INVALID;
+                if (!inserted) {
+                    next = it->second;
+                    it->second = handle.value;
+                    ++collisions;
+                }
+                entries.push_back(Entry{std::string(text), hash, next});
+                return handle;
+            }
+
+            [[nodiscard]] NameHandle find(const std::string_view text) const {
+                std::shared_lock lock(mutex);
+                return findLocked(text, HashString(text));
+            }
+
+            // The view stays valid for the lifetime of the table.
+            [[nodiscard]] std::string_view view(const NameHandle handle) const {
+                std::shared_lock lock(mutex);
+                return handle.value < entries.size() ? std::string_view(entries[handle.value].text) : std::string_view{};
+            }
+
+            [[nodiscard]] uint64_t hash(const NameHandle handle) const {
+                std::shared_lock lock(mutex);
+                return handle.value < entries.size() ? entries[handle.value].hash : 0;
+            }
+
+            [[nodiscard]] size_t size() const {
+                std::shared_lock lock(mutex);
+                return entries.size();
+            }
+
+            [[nodiscard]] size_t collisionCount() const {
+                std::shared_lock lock(mutex);
+                return collisions;
+            }
+
+        private:
+            struct Entry {
+                std::string     text{};
+                uint64_t        hash{0};
+                uint32_t        nextCollision{NameHandle::INVALID};
+            };
+
+            [[nodiscard]] NameHandle findLocked(const std::string_view text, const uint64_t hash) const {
+                const auto it = heads.find(hash);
+                if (it == heads.end()) return {};
+                for (uint32_t i = it->second; i != NameHandle::INVALID; i = entries[i].nextCollision) {
+                    if (entries[i].text == text) return NameHandle{i};
+                }
+                return {};
+            }
+
+            mutable std::shared_mutex                   mutex{};
+            std::deque<Entry>                           entries{};      // deque: interned strings never move
+            std::unordered_map<uint64_t, uint32_t>      heads{};        // hash -> newest entry of its chain
+            size_t                                      collisions{0};
+        };
+
+        inline InternTable& GlobalInternTable() {
+            static InternTable table{};
+            return table;
         }
 
+        inline NameHandle InternName(const std::string_view text) { return GlobalInternTable().intern(text); }
+        inline NameHandle InternName(const std::string_view text, const uint64_t hash) { return GlobalInternTable().intern(text, hash); }
+        inline std::string_view NameOf(const NameHandle handle) { return GlobalInternTable().view(handle); }
+
         template <typename T>
         [[nodiscard]] constexpr std::optional<std::size_t> Index_Of(std::span<T> container, const T& value) noexcept {
             auto it = std::ranges::find(container, value);
@@ -122,6 +300,83 @@ export namespace ufox {
 
             return static_cast<std::size_t>(std::ranges::distance(container.begin(), it));
         }
+
+        // Forwards to the upstream resource and counts what it hands out.
+        class CountingMemoryResource final : public std::pmr::memory_resource {
+        public:
+            explicit CountingMemoryResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) noexcept
+                : upstream(upstream) {}
+
+            [[nodiscard]] size_t allocationCount() const noexcept { return allocations; }
+            [[nodiscard]] size_t allocatedBytes() const noexcept { return bytes; }
+
+            void resetCounters() noexcept {
+                allocations = 0;
+                bytes = 0;
+            }
+
+        private:
+            void* do_allocate(const size_t size, const size_t alignment) override {
+                ++allocations;
+                bytes += size;
+                return upstream->allocate(size, alignment);
+            }
+
+            void do_deallocate(void* p, const size_t size, const size_t alignment) override {
+                upstream->deallocate(p, size, alignment);
+            }
+
+            [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+                return this == &other;
+            }
+
+            std::pmr::memory_resource*  upstream;
+            size_t                      allocations{0};
+            size_t                      bytes{0};
+        };
+
+        // Monotonic arena released once per pass. What spilled to the heap during a pass grows the
+        // backing buffer on reset, so once warmed up a pass fits the buffer and never allocates.
+        class ScratchArena {
+        public:
+            static constexpr size_t DEFAULT_CAPACITY = 16 * 1024;
+
+            explicit ScratchArena(const size_t initialCapacity = DEFAULT_CAPACITY) { grow(initialCapacity); }
+            ~ScratchArena() = default;
+
+            ScratchArena(const ScratchArena&) = delete;
+            ScratchArena& operator=(const ScratchArena&) = delete;
+
+            [[nodiscard]] std::pmr::memory_resource* resource() noexcept { return &*monotonic; }
+            [[nodiscard]] size_t capacity() const noexcept { return bufferCapacity; }
+            [[nodiscard]] size_t pendingHeapAllocations() const noexcept { return upstream.allocationCount(); }
+            [[nodiscard]] size_t lastPassHeapAllocations() const noexcept { return lastPassAllocations; }
+
+            // Ends the pass: everything drawn from resource() is invalidated.
+            void reset() {
+                const size_t spilledBytes = upstream.allocatedBytes();
+                lastPassAllocations = upstream.allocationCount();
+
+                monotonic->release();
+                upstream.resetCounters();
+
+                if (spilledBytes > 0) grow(bufferCapacity + spilledBytes);
+            }
+
+        private:
+            void grow(const size_t newCapacity) {
+                bufferCapacity = std::bit_ceil(std::max<size_t>(newCapacity, 64));
+                monotonic.reset();
+                buffer = std::make_unique<std::byte[]>(bufferCapacity);
+                monotonic.emplace(buffer.get(), bufferCapacity, &upstream);
+            }
+
+            CountingMemoryResource                              upstream{};
+            std::unique_ptr<std::byte[]>                        buffer{};
+            size_t                                              bufferCapacity{0};
+            std::optional<std::pmr::monotonic_buffer_resource>  monotonic{};
+            size_t                                              lastPassAllocations{0};
+        };
     }
 
     namespace mathf {
@@ -346,25 +601,326 @@ export namespace ufox {
     }
 
     namespace debug {
-        enum class LogLevel {
+        enum class LogLevel : uint8_t {
             eInfo,
             eWarning,
             eError
         };
 
-        template<typename... Args>
+        enum class LogCategory : uint8_t {
+            eGeneral,
+            eWindowing,
+            eInput,
+            eLayout,
+            eGpu,
+            eResource
+        };
 
-        void log(LogLevel level, const std::string& format_str, Args&&... args) {
-            std::string level_str;
+        // Compile-time filter: records below UFOX_LOG_MIN_LEVEL (3 disables logging) or outside
+        // UFOX_LOG_CATEGORY_MASK (bit per LogCategory) compile to nothing.
+        constexpr uint8_t LOG_MIN_LEVEL = UFOX_LOG_MIN_LEVEL;
+        constexpr uint32_t LOG_CATEGORY_MASK = UFOX_LOG_CATEGORY_MASK;
+
+        constexpr size_t LOG_RING_CAPACITY = 2048;              // power of two, a full ring drops records
+        constexpr size_t LOG_RECORD_PAYLOAD = 256;
+        constexpr size_t LOG_STRING_CAPACITY = 62;              // string arguments are copied and truncated
+        constexpr size_t LOG_TEXT_CAPACITY = LOG_RECORD_PAYLOAD - sizeof(uint16_t);
+        constexpr uint32_t LOG_RATE_LIMIT_PER_SECOND = 64;      // per call site
+        constexpr size_t LOG_RATE_LIMIT_SLOTS = 512;
+        constexpr std::chrono::milliseconds LOG_IDLE_SLEEP{2};
+
+        template<LogLevel Level, LogCategory Category>
+        constexpr bool IsLogEnabled() noexcept {
+            return static_cast<uint8_t>(Level) >= LOG_MIN_LEVEL && (LOG_CATEGORY_MASK >> static_cast<uint8_t>(Category) & 1u) != 0;
+        }
+
+        constexpr std::string_view ToString(const LogLevel level) noexcept {
             switch (level) {
-                case LogLevel::eInfo:    level_str = "INFO"; break;
-                case LogLevel::eWarning: level_str = "WARNING"; break;
-                case LogLevel::eError:   level_str = "ERROR"; break;
+                case LogLevel::eInfo:    return "INFO";
+                case LogLevel::eWarning: return "WARNING";
+                default:                 return "ERROR";
             }
+        }
 
-            std::string message = std::vformat(format_str, std::make_format_args(args...));
-            std::cout << std::format("[{}] {}\n", level_str, message);
+        constexpr std::string_view ToString(const LogCategory category) noexcept {
+            switch (category) {
+                case LogCategory::eWindowing: return "windowing";
+                case LogCategory::eInput:     return "input";
+                case LogCategory::eLayout:    return "layout";
+                case LogCategory::eGpu:       return "gpu";
+                case LogCategory::eResource:  return "resource";
+                default:                      return "general";
+            }
+        }
+
+        // Fixed-size copy of a string argument, so a record never points at caller memory.
+        template<size_t Capacity>
+        struct InlineLogString {
+            uint16_t    length{0};
+            char        data[Capacity];
+
+            explicit InlineLogString(const std::string_view text) noexcept : length(static_cast<uint16_t>(std::min(text.size(), Capacity))) {
+                std::memcpy(data, text.data(), length);
+            }
+
+            [[nodiscard]] std::string_view view() const noexcept { return {data, length}; }
+        };
+
+        using LogString = InlineLogString<LOG_STRING_CAPACITY>;
+        using LogText = InlineLogString<LOG_TEXT_CAPACITY>;
+
+        // Producer side conversion: strings are copied inline, trivially copyable values are kept
+        // raw, anything else is formatted on the calling thread.
+        template<typename T>
+        auto StoreLogArg(const T& value) {
+            if constexpr (std::is_convertible_v<const T&, std::string_view>) return LogString(std::string_view(value));
+            else if constexpr (std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>) return value;
+            else return LogString(std::format("{}", value));
+        }
+
+        template<typename T>
+        const auto& ViewLogArg(const T& stored) noexcept { return stored; }
+
+        template<size_t Capacity>
+        std::string_view ViewLogArg(const InlineLogString<Capacity>& stored) noexcept { return stored.view(); }
+
+        struct LogRecord;
+        using LogRecordFormatter = void (*)(const LogRecord& record, std::string& out);
+
+        struct LogRecord {
+            LogRecordFormatter          formatter{nullptr};
+            std::string_view            format{};
+            const char*                 file{nullptr};
+            uint32_t                    line{0};
+            uint32_t                    suppressed{0};      // records of the call site dropped by the rate limit before this one
+            LogLevel                    level{LogLevel::eInfo};
+            LogCategory                 category{LogCategory::eGeneral};
+            alignas(16) std::byte       payload[LOG_RECORD_PAYLOAD];
+        };
+
+        template<typename Stored>
+        void FormatLogRecord(const LogRecord& record, std::string& out) {
+            const Stored& stored = *std::launder(reinterpret_cast<const Stored*>(record.payload));
+            std::apply([&](const auto&... args) {
+                auto viewed = std::tuple<decltype(ViewLogArg(args))...>{ViewLogArg(args)...};
+                std::apply([&](auto&... formatArgs) {
+                    std::vformat_to(std::back_inserter(out), record.format, std::make_format_args(formatArgs...));
+                }, viewed);
+            }, stored);
+        }
+
+        inline void FormatLogText(const LogRecord& record, std::string& out) {
+            out += std::launder(reinterpret_cast<const LogText*>(record.payload))->view();
+        }
+
+        // Format string of a compile-time checked log call, captures the call site.
+        template<typename... Args>
+        struct LogFormat {
+            std::format_string<Args...>     format;
+            std::source_location            location;
+
+            template<typename T> requires std::convertible_to<const T&, std::string_view>
+            consteval LogFormat(const T& text, const std::source_location loc = std::source_location::current()) : format(text), location(loc) {}
+        };
+
+        // Bounded MPSC ring (sequence numbered slots): producers claim a slot with one CAS and
+        // store the raw arguments, a background thread formats and writes them. Producers never
+        // block or allocate, a full ring drops the record.
+        class Logger {
+        public:
+            Logger() : slots(std::make_unique<Slot[]>(LOG_RING_CAPACITY)) {
+                for (size_t i = 0; i < LOG_RING_CAPACITY; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+                consumer = std::thread([this] { consumeLoop(); });
+            }
+
+            ~Logger() {
+                stopping.store(true, std::memory_order_release);
+                if (consumer.joinable()) consumer.join();
+            }
+
+            Logger(const Logger&) = delete;
+            Logger& operator=(const Logger&) = delete;
+
+            static Logger& Instance() {
+                static Logger logger{};
+                return logger;
+            }
+
+            template<typename Write>
+            bool push(Write&& write) noexcept {
+                size_t position = enqueuePosition.load(std::memory_order_relaxed);
+                while (true) {
+                    Slot& slot = slots[position & (LOG_RING_CAPACITY - 1)];
+                    const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                    const auto diff = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+                    if (diff == 0) {
+                        if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                            write(slot.record);
+                            slot.sequence.store(position + 1, std::memory_order_release);
+                            return true;
+                        }
+                    } else if (diff < 0) {
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    } else {
+                        position = enqueuePosition.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // Per call site budget of LOG_RATE_LIMIT_PER_SECOND records. Call sites hashing to the
+            // same slot share it. Returns false when the record has to be dropped, otherwise the
+            // number of records dropped since the last one that went through.
+            bool admit(const std::source_location& location, const int64_t second, uint32_t& suppressed) noexcept {
+                const size_t hash = std::hash<const void*>{}(location.file_name()) ^ location.line() * 0x9E3779B97F4A7C15ull;
+                RateLimit& limit = rateLimits[hash % LOG_RATE_LIMIT_SLOTS];
+
+                int64_t window = limit.window.load(std::memory_order_relaxed);
+                if (window != second && limit.window.compare_exchange_strong(window, second, std::memory_order_relaxed)) {
+                    limit.count.store(0, std::memory_order_relaxed);
+                }
+
+                if (limit.count.fetch_add(1, std::memory_order_relaxed) >= LOG_RATE_LIMIT_PER_SECOND) {
+                    limit.suppressed.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+
+                suppressed = limit.suppressed.exchange(0, std::memory_order_relaxed);
+                return true;
+            }
+
+            // Blocks until every record pushed before the call is written.
+            void flush() const {
+                const size_t target = enqueuePosition.load(std::memory_order_acquire);
+                while (dequeuePosition.load(std::memory_order_acquire) < target) std::this_thread::yield();
+            }
+
+            [[nodiscard]] uint64_t droppedCount() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+        private:
+            struct Slot {
+                std::atomic<size_t>     sequence{0};
+                LogRecord               record{};
+            };
+
+            struct RateLimit {
+                std::atomic<int64_t>    window{-1};
+                std::atomic<uint32_t>   count{0};
+                std::atomic<uint32_t>   suppressed{0};
+            };
+
+            bool drain(std::string& batch) {
+                size_t position = dequeuePosition.load(std::memory_order_relaxed);
+                bool any = false;
+
+                while (true) {
+                    Slot& slot = slots[position & (LOG_RING_CAPACITY - 1)];
+                    if (slot.sequence.load(std::memory_order_acquire) != position + 1) break;
+
+                    const LogRecord& record = slot.record;
+                    batch += std::format("[{}] [{}] ", ToString(record.level), ToString(record.category));
+                    try {
+                        record.formatter(record, batch);
+                    } catch (const std::format_error& e) {
+                        batch += std::format("<format error: {}> {}", e.what(), record.format);
+                    }
+                    if (record.level != LogLevel::eInfo && record.line != 0) batch += std::format(" ({}:{})", record.file, record.line);
+                    if (record.suppressed > 0) batch += std::format(" (+{} suppressed)", record.suppressed);
+                    batch += '\n';
+
+                    slot.sequence.store(position + LOG_RING_CAPACITY, std::memory_order_release);
+                    dequeuePosition.store(++position, std::memory_order_release);
+                    any = true;
+                }
+
+                return any;
+            }
+
+            void consumeLoop() {
+                std::string batch{};
+                uint64_t reportedDrops = 0;
+
+                while (true) {
+                    const bool stop = stopping.load(std::memory_order_acquire);
+
+                    batch.clear();
+                    const bool any = drain(batch);
+
+                    if (const uint64_t drops = droppedCount(); drops != reportedDrops) {
+                        batch += std::format("[WARNING] [general] log ring full, {} records dropped\n", drops - reportedDrops);
+                        reportedDrops = drops;
+                    }
+
+                    if (!batch.empty()) {
+                        std::cout << batch;
+                        std::cout.flush();
+                    }
+
+                    if (stop) return;
+                    if (!any) std::this_thread::sleep_for(LOG_IDLE_SLEEP);
+                }
+            }
+
+            std::unique_ptr<Slot[]>             slots{};
+            RateLimit                           rateLimits[LOG_RATE_LIMIT_SLOTS]{};
+            alignas(64) std::atomic<size_t>     enqueuePosition{0};
+            alignas(64) std::atomic<size_t>     dequeuePosition{0};
+            std::atomic<uint64_t>               dropped{0};
+            std::atomic<bool>                   stopping{false};
+            std::thread                         consumer{};
+        };
+
+        inline int64_t CurrentLogSecond() noexcept {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // Hot path logging: filtered at compile time, the arguments are copied raw into the ring
+        // and formatted on the logger thread.
+        template<LogLevel Level, LogCategory Category = LogCategory::eGeneral, typename... Args>
+        void log(const LogFormat<std::type_identity_t<Args>...> format, const Args&... args) {
+            if constexpr (IsLogEnabled<Level, Category>()) {
+                using Stored = std::tuple<decltype(StoreLogArg(args))...>;
+                static_assert(sizeof(Stored) <= LOG_RECORD_PAYLOAD, "log arguments exceed LOG_RECORD_PAYLOAD");
+                static_assert(std::is_trivially_destructible_v<Stored>);
+
+                Logger& logger = Logger::Instance();
+                uint32_t suppressed = 0;
+                if (!logger.admit(format.location, CurrentLogSecond(), suppressed)) return;
+
+                logger.push([&](LogRecord& record) {
+                    record.formatter = &FormatLogRecord<Stored>;
+                    record.format = format.format.get();
+                    record.file = format.location.file_name();
+                    record.line = format.location.line();
+                    record.suppressed = suppressed;
+                    record.level = Level;
+                    record.category = Category;
+                    ::new (static_cast<void*>(record.payload)) Stored{StoreLogArg(args)...};
+                });
+            }
+        }
+
+        // Runtime level and format string: formatted on the calling thread, written by the logger
+        // thread. Kept for cold paths, hot paths use the compile-time overload above.
+        template<typename... Args>
+        void log(LogLevel level, const std::string& format_str, Args&&... args) {
+            if (static_cast<uint8_t>(level) < LOG_MIN_LEVEL) return;
+
+            const std::string message = std::vformat(format_str, std::make_format_args(args...));
+            Logger::Instance().push([&](LogRecord& record) {
+                record.formatter = &FormatLogText;
+                record.format = {};
+                record.file = "";
+                record.line = 0;
+                record.suppressed = 0;
+                record.level = level;
+                record.category = LogCategory::eGeneral;
+                ::new (static_cast<void*>(record.payload)) LogText(message);
+            });
         }
+
+        inline void FlushLog() { Logger::Instance().flush(); }
     }
 
     namespace gpu::vulkan {
@@ -447,6 +1003,7 @@ export namespace ufox {
             std::vector<vk::Image>                      images;
             std::vector<vk::raii::ImageView>            imageViews;
             vk::Extent2D                                extent{0,0};
+            vk::ImageUsageFlags                         usage{};        // requested usage the surface supports
             std::vector<vk::raii::Semaphore>            renderFinishedSemaphores{};
             uint32_t                                    currentImageIndex{0};
 
@@ -523,11 +1080,25 @@ export namespace ufox {
             std::optional<vk::raii::CommandPool>        commandPool{};
             std::optional<vk::raii::Queue>              graphicsQueue{};
             std::optional<vk::raii::Queue>              presentQueue{};
+            std::unique_ptr<memory::DeviceAllocator>    allocator{};    // before device in destruction order
         };
 
+        // The allocation is declared first so it is given back after the buffer is destroyed.
         struct Buffer {
+            memory::MemoryAllocation                    allocation{};
             std::optional<vk::raii::Buffer>             data{};
-            std::optional<vk::raii::DeviceMemory>       memory{};
+        };
+
+        // One persistently mapped buffer for per-frame uniform and staging data.
+        struct FrameArena {
+            Buffer                                      buffer{};
+            memory::FrameRingAllocator                  ring{};
+        };
+
+        struct FrameSlice {
+            vk::Buffer                                  buffer{};
+            vk::DeviceSize                              offset{0};
+            void*                                       mapped{nullptr};
         };
 
         struct RemappableBuffer {
@@ -536,11 +1107,9 @@ export namespace ufox {
         };
 
         struct TextureImage {
-            TextureImage(vk::raii::PhysicalDevice const &  physicalDevice,
-                  vk::raii::Device const &          device,
-                  uint32_t width, uint32_t          height,
-                  vk::Format format, vk::ImageTiling tiling,
-                  vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties, vk::SharingMode shareMode = vk::SharingMode::eExclusive) {
+            TextureImage(const GPUResources& gpu, uint32_t width, uint32_t height, vk::Format format,
+                vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties,
+                vk::SharingMode shareMode = vk::SharingMode::eExclusive) {
 
                 vk::ImageCreateInfo imageInfo{};
                 imageInfo
@@ -554,33 +1123,18 @@ export namespace ufox {
                     .setUsage(usage)
                     .setSharingMode(shareMode);
 
-                data.emplace(device, imageInfo);
-
-
-                vk::MemoryRequirements memoryRequirements = data->getMemoryRequirements();
-
-                vk::MemoryAllocateInfo allocInfo{};
+                data.emplace(*gpu.device, imageInfo);
 
-                allocInfo
+                allocation = gpu.allocator->allocate(data->getMemoryRequirements(), properties, memory::ResourceKind::eImage);
+                if (!allocation) throw std::runtime_error("failed to allocate image memory!");
 
-                    .setAllocationSize(memoryRequirements.size)
-
-                    .setMemoryTypeIndex(FindMemoryType(physicalDevice.getMemoryProperties(), memoryRequirements.memoryTypeBits, properties));
-
-                memory.emplace(device, allocInfo);
-
-                data->bindMemory(*memory, 0);
+                data->bindMemory(allocation.memory(), allocation.offset());
             }
 
-            TextureImage(const GPUResources& gpu, uint32_t width, uint32_t height, vk::Format format,
-                vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties,
-                vk::SharingMode shareMode = vk::SharingMode::eExclusive) :
-                TextureImage(gpu.physicalDevice.value(), gpu.device.value(), width, height, format, tiling, usage, properties, shareMode){}
-
             ~TextureImage() = default;
 
+            memory::MemoryAllocation                    allocation{};
             std::optional<vk::raii::Image>              data{};
-            std::optional<vk::raii::DeviceMemory>       memory{};
             std::optional<vk::raii::ImageView>          view{};
             vk::Format                                  format{ vk::Format::eUndefined};
             vk::Extent2D                                extent{ 0, 0 };
@@ -590,7 +1144,7 @@ export namespace ufox {
             void clear() {
                 view.reset();
                 data.reset();
-                memory.reset();
+                allocation.reset();
             }
         };
     }
@@ -663,7 +1217,7 @@ export namespace ufox {
             struct sdlContext {
                 sdlContext() {
                     if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS)) {
-                        debug::log(debug::LogLevel::eError, "Failed to initialize SDL: {}", SDL_GetError());
+                        debug::log<debug::LogLevel::eError, debug::LogCategory::eWindowing>("Failed to initialize SDL: {}", SDL_GetError());
                         throw std::runtime_error("Failed to initialize SDL");
                     }
                 }
@@ -684,7 +1238,7 @@ export namespace ufox {
             }
 
 
-            debug::log(debug::LogLevel::eInfo, "Created SDL window: {} ({}x{})", windowName, static_cast<int>(extent.width), static_cast<int>(extent.height));
+            debug::log<debug::LogLevel::eInfo, debug::LogCategory::eWindowing>("Created SDL window: {} ({}x{})", windowName, static_cast<int>(extent.width), static_cast<int>(extent.height));
 
             return WindowResource{instance,window};
 
@@ -694,7 +1248,7 @@ export namespace ufox {
                 glfwContext() {
                     glfwInit();
                     glfwSetErrorCallback([](int error, const char* msg) {
-                        debug::log(debug::LogLevel::eError, "GLFW error ({}): {}", error, msg);
+                        debug::log<debug::LogLevel::eError, debug::LogCategory::eWindowing>("GLFW error ({}): {}", error, msg);
                     });
                 }
 
@@ -711,13 +1265,13 @@ export namespace ufox {
 
             if (!window) {
 
-                debug::log(debug::LogLevel::eError, "Failed to create GLFW window: {}", windowName);
+                debug::log<debug::LogLevel::eError, debug::LogCategory::eWindowing>("Failed to create GLFW window: {}", windowName);
 
                 throw std::runtime_error("Failed to create GLFW window");
 
             }
 
-            debug::log(debug::LogLevel::eInfo, "Created GLFW window: {} ({}x{})", windowName, static_cast<int>(extent.width), static_cast<int>(extent.height));
+            debug::log<debug::LogLevel::eInfo, debug::LogCategory::eWindowing>("Created GLFW window: {} ({}x{})", windowName, static_cast<int>(extent.width), static_cast<int>(extent.height));
 
             return WindowResource{instance,window};
 
@@ -788,6 +1342,65 @@ export namespace ufox {
             }
         };
 
+        // Type-erased void(InputResource&) callable kept in inline storage: binding a callback
+        // that fits and dispatching it never touch the heap.
+        class InputDelegate {
+        public:
+            static constexpr size_t STORAGE_SIZE = 48;
+
+            InputDelegate() = default;
+            ~InputDelegate() { reset(); }
+
+            template<typename F> requires (!std::same_as<std::remove_cvref_t<F>, InputDelegate> && std::invocable<std::remove_cvref_t<F>&, InputResource&>)
+            InputDelegate(F&& callable) noexcept {
+                using T = std::remove_cvref_t<F>;
+                static_assert(sizeof(T) <= STORAGE_SIZE && alignof(T) <= alignof(std::max_align_t), "callback captures exceed InputDelegate::STORAGE_SIZE");
+                static_assert(std::is_nothrow_move_constructible_v<T>);
+
+                ::new (static_cast<void*>(storage)) T(std::forward<F>(callable));
+                invokeFn = [](std::byte* target, InputResource& input) { (*std::launder(reinterpret_cast<T*>(target)))(input); };
+                relocateFn = [](std::byte* destination, std::byte* source) noexcept {
+                    T* object = std::launder(reinterpret_cast<T*>(source));
+                    if (destination) ::new (static_cast<void*>(destination)) T(std::move(*object));
+                    object->~T();
+                };
+            }
+
+            InputDelegate(InputDelegate&& other) noexcept { takeFrom(other); }
+
+            InputDelegate& operator=(InputDelegate&& other) noexcept {
+                if (this != &other) {
+                    reset();
+                    takeFrom(other);
+                }
+                return *this;
+            }
+
+            InputDelegate(const InputDelegate&) = delete;
+            InputDelegate& operator=(const InputDelegate&) = delete;
+
+            void reset() noexcept {
+                if (relocateFn) relocateFn(nullptr, storage);
+                invokeFn = nullptr;
+                relocateFn = nullptr;
+            }
+
+            explicit operator bool() const noexcept { return invokeFn != nullptr; }
+            void operator()(InputResource& input) const { invokeFn(storage, input); }
+
+        private:
+            void takeFrom(InputDelegate& other) noexcept {
+                if (!other.relocateFn) return;
+                other.relocateFn(storage, other.storage);
+                invokeFn = std::exchange(other.invokeFn, nullptr);
+                relocateFn = std::exchange(other.relocateFn, nullptr);
+            }
+
+            alignas(std::max_align_t) mutable std::byte    storage[STORAGE_SIZE]{};
+            void (*invokeFn)(std::byte*, InputResource&){nullptr};
+            void (*relocateFn)(std::byte*, std::byte*) noexcept {nullptr};   // moves into the destination when set, destroys the source
+        };
+
         struct EventCallbackPool {
             struct Handler {
                 Handler(const Handler&) = delete;
@@ -805,54 +1418,55 @@ export namespace ufox {
                 [[nodiscard]] bool is_connected() const { return pool != nullptr; }
             };
 
-            using Callback = std::function<void(InputResource&)>;
+            using Callback = InputDelegate;
 
             [[nodiscard]] Handler bind(Callback cb) {
                 std::size_t idx = free_list.empty() ? callbacks.size() : free_list.back();
                 if (free_list.empty()) {
                     callbacks.emplace_back();
-                    active.push_back(false);
                 } else {
                     free_list.pop_back();
                 }
                 callbacks[idx] = std::move(cb);
-                active[idx] = true;
                 return {this, idx};
             }
 
             void unbind(std::size_t idx) {
-                if (idx < active.size() && active[idx]) {
-                    active[idx] = false;
+                if (idx < callbacks.size() && callbacks[idx]) {
+                    callbacks[idx].reset();
                     free_list.push_back(idx);
-                    callbacks[idx] = nullptr;
                 }
             }
 
             void clear() {
-                for (std::size_t i = 0; i < active.size(); ++i) {
+                for (std::size_t i = 0; i < callbacks.size(); ++i) {
                     unbind(i);
                 }
             }
 
             void invoke(InputResource& input) const {
-                for (std::size_t i = 0; i < active.size(); ++i) {
-                    if (active[i] && callbacks[i]) callbacks[i](input);
+                uint64_t invoked = 0;
+                for (const Callback& callback : callbacks) {
+                    if (callback) {
+                        callback(input);
+                        ++invoked;
+                    }
                 }
+                profiler::AddCounter(profiler::Counter::eCallbacksInvoked, invoked);
             }
 
         private:
-            std::vector<Callback> callbacks;
-            std::vector<bool> active;
+            std::vector<Callback> callbacks;        // unbound slots are empty delegates
             std::vector<std::size_t> free_list;
         };
 
         struct Action {
-            explicit Action(const std::string &name_, const std::chrono::milliseconds& timeout_) : id(utilities::GenerateUniqueID(name_)) , name(name_), timeout(timeout_) {
-                debug::log(debug::LogLevel::eInfo, "InputAction CREATED: {} [id: {:#x}]", name, id);
+            explicit Action(const std::string &name_, const std::chrono::milliseconds& timeout_) : id(utilities::InternName(name_)) , name(name_), timeout(timeout_) {
+                debug::log<debug::LogLevel::eInfo, debug::LogCategory::eInput>("InputAction CREATED: {} [id: {}]", name, id.value);
             }
             ~Action() = default;
 
-            const uint32_t                          id;
+            const utilities::NameHandle             id;
             const std::string                       name;
             ActionPhase                             phase = ActionPhase::eSleep;
             float                                   value1 = 0.0f;
@@ -862,14 +1476,14 @@ export namespace ufox {
             bool                                    isEnded{false};
             uint32_t                                triggerCount{0};
 
-            std::chrono::steady_clock::time_point   startTime = std::chrono::steady_clock::now();
+            std::chrono::steady_clock::time_point   startTime{};
             std::chrono::milliseconds               timeout{1000};
 
-            void refresh() noexcept {
+            void refresh(const std::chrono::steady_clock::time_point now) noexcept {
                 if (phase == ActionPhase::eStart && isStarted) {
                     phase = ActionPhase::ePerform;
                 }else if (phase == ActionPhase::eEnd && isEnded) {
-                    phase = std::chrono::steady_clock::now() - startTime > timeout? ActionPhase::eReset : ActionPhase::eRepeat;
+                    phase = now - startTime > timeout? ActionPhase::eReset : ActionPhase::eRepeat;
                 }else if (phase == ActionPhase::eRepeat) {
                     isStarted = false;
                     isPerformed = false;
@@ -885,7 +1499,7 @@ export namespace ufox {
                 }
             }
 
-            void perform() noexcept {
+            void perform(const std::chrono::steady_clock::time_point now) noexcept {
                 if (phase == ActionPhase::eStart) {
                     triggerCount++;
                     isStarted = true;
@@ -894,7 +1508,7 @@ export namespace ufox {
                 }else if (phase == ActionPhase::eEnd) {
                     isEnded = true;
                 }else if (phase == ActionPhase::eWait) {
-                    phase = std::chrono::steady_clock::now() - startTime > timeout? ActionPhase::eReset : ActionPhase::eWait;
+                    phase = now - startTime > timeout? ActionPhase::eReset : ActionPhase::eWait;
                 }
             }
         };
@@ -914,9 +1528,105 @@ export namespace ufox {
             }
         }
 
+        enum class InputEventType : uint8_t {
+            eMouseMotion,
+            eMouseButton,
+            eMouseWheel
+        };
+
+        // One platform event, stamped when it was pushed. Positions are window relative.
+        struct InputEvent {
+            std::chrono::steady_clock::time_point   timestamp{};
+            InputEventType                          type{InputEventType::eMouseMotion};
+            MouseButton                             button{MouseButton::eNone};
+            ActionPhase                             phase{ActionPhase::eSleep};
+            glm::ivec2                              position{0, 0};     // motion target, wheel steps
+            float                                   value1{0.0f};
+            float                                   value2{0.0f};
+        };
+
+        // Lock-free single producer (platform callbacks) single consumer (frame) ring. A full
+        // queue drops the newest event and counts it.
+        class InputEventQueue {
+        public:
+            static constexpr size_t CAPACITY = 1024;     // power of two
+
+            InputEventQueue() : events(std::make_unique<InputEvent[]>(CAPACITY)) {}
+
+            bool push(const InputEvent& event) noexcept {
+                const size_t position = head.load(std::memory_order_relaxed);
+                if (position - tail.load(std::memory_order_acquire) >= CAPACITY) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                }
+                events[position & (CAPACITY - 1)] = event;
+                head.store(position + 1, std::memory_order_release);
+                return true;
+            }
+
+            bool pop(InputEvent& event) noexcept {
+                const size_t position = tail.load(std::memory_order_relaxed);
+                if (position == head.load(std::memory_order_acquire)) return false;
+                event = events[position & (CAPACITY - 1)];
+                tail.store(position + 1, std::memory_order_release);
+                return true;
+            }
+
+            [[nodiscard]] uint64_t droppedCount() const noexcept { return dropped.load(std::memory_order_relaxed); }
+
+        private:
+            std::unique_ptr<InputEvent[]>       events;
+            alignas(64) std::atomic<size_t>     head{0};
+            alignas(64) std::atomic<size_t>     tail{0};
+            std::atomic<uint64_t>               dropped{0};
+        };
+
+        // Time source of the input timestamps and action timeouts. Unset it reads steady_clock, a
+        // replay installs a clock it advances itself so a trace runs the same every time.
+        struct InputClock {
+            using NowFn = std::chrono::steady_clock::time_point (*)(const void* context);
+
+            NowFn           nowFn{nullptr};
+            const void*     context{nullptr};
+
+            [[nodiscard]] std::chrono::steady_clock::time_point now() const noexcept {
+                return nowFn ? nowFn(context) : std::chrono::steady_clock::now();
+            }
+        };
+
+        enum class InputTraceEventType : uint8_t {
+            eMouseMotion,   // the first three match InputEventType
+            eMouseButton,
+            eMouseWheel,
+            eResize,        // window size, applied to the viewport right away
+            eFrame          // the events before it were processed as one frame
+        };
+
+        // One recorded event as stored on disk. Times are relative to the previous event, a
+        // trace replays the same from any start time.
+        struct InputTraceEvent {
+            uint32_t                deltaMicroseconds{0};
+            int32_t                 x{0};           // motion target, wheel steps or window width
+            int32_t                 y{0};
+            float                   value1{0.0f};
+            float                   value2{0.0f};
+            InputTraceEventType     type{InputTraceEventType::eFrame};
+            uint8_t                 button{0};      // MouseButton
+            uint8_t                 phase{0};       // ActionPhase
+            uint8_t                 reserved{0};
+        };
+
+        static_assert(sizeof(InputTraceEvent) == 24 && std::is_trivially_copyable_v<InputTraceEvent>);
+
+        struct InputTrace {
+            std::chrono::steady_clock::time_point   lastTime{};     // of the last recorded event
+            std::vector<InputTraceEvent>            events{};
+        };
+
         struct InputResource {
 
             glm::ivec2 mousePosition{0,0};
+            glm::ivec2 queuedMousePosition{0,0};    // last pushed motion, ahead of mousePosition until the queue drains
             glm::ivec2 mouseDelta{0, 0};
             glm::ivec2 mouseWheel{0,0};
 
@@ -933,11 +1643,17 @@ export namespace ufox {
             EventCallbackPool onRightMouseButtonCallbackPool{};
             EventCallbackPool onMiddleMouseButtonCallbackPool{};
 
+            InputEventQueue events{};
+            std::chrono::steady_clock::time_point lastMotionTime{};
+            uint32_t coalescedMotionCount{0};       // motion events folded into the last dispatch
+            InputClock clock{};
+            InputTrace* recording{nullptr};         // pushed events and frames are appended while set
+
             bool mouseLeftButton{false}, mouseRightButton{false}, mouseMiddleButton{false};
 
             void refresh() noexcept {
                 mouseWheel = {0,0};
-                leftMouseButtonAction.refresh();
+                leftMouseButtonAction.refresh(clock.now());
             }
             void updateMouseDelta(const glm::ivec2& pos) noexcept { mouseDelta = pos - mousePosition; }
             [[nodiscard]] float getMouseDeltaMagnitude() const noexcept { return glm::length(glm::vec2(mouseDelta)); }
@@ -952,7 +1668,7 @@ export namespace ufox {
 
             void onLeftMouseButton() {
 
-                leftMouseButtonAction.perform();
+                leftMouseButtonAction.perform(clock.now());
 
                 onLeftMouseButtonCallbackPool.invoke(*this);
             }
@@ -1007,6 +1723,8 @@ export namespace ufox {
         [[nodiscard]] constexpr bool isPercent() const noexcept { return unit == Unit::Percent; }
         [[nodiscard]] constexpr bool isAuto() const noexcept { return !unit.has_value() && value == 0.0f; }  // auto default
         [[nodiscard]] constexpr bool hasUnit() const noexcept { return unit.has_value(); }
+
+        constexpr bool operator==(const Length&) const noexcept = default;
     };
 
     // Literals (renamed: _fill → _auto)
@@ -1025,10 +1743,183 @@ export namespace ufox {
         int baseHeight{0};
         int greaterMinWidth{0};
         int greaterMinHeight{0};
+        int childBaseWidth{0};      // accumulated base of the children, reused while the panel is clean
+        int childBaseHeight{0};
+
+        constexpr bool operator==(const RectLayout&) const noexcept = default;
+    };
+
+    // Tracks which part of the layout has to be recomputed for a panel.
+    // Invariant: a flag set on a panel is also set on all of its ancestors,
+    // so the passes can stop descending at the first clean panel. eStructure and
+    // eInputs are the exception, they only mark the panel that was edited.
+    enum class LayoutDirtyFlags : uint8_t {
+        eNone       = 0,
+        eMeasure    = 1 << 0,   // base/min lengths must be re-measured
+        eArrange    = 1 << 1,   // children must be re-placed even if the panel rect did not change
+        eStructure  = 1 << 2,   // children were added/removed, the flattened subtree is spliced in again
+        eInputs     = 1 << 3,   // layout inputs of this panel were written, never propagated
+        eAll        = eMeasure | eArrange
     };
 
+    constexpr LayoutDirtyFlags operator|(LayoutDirtyFlags lhs, LayoutDirtyFlags rhs) noexcept {
+        return static_cast<LayoutDirtyFlags>(static_cast<uint8_t>(lhs) | static_cast<uint8_t>(rhs));
+    }
+    constexpr LayoutDirtyFlags operator&(LayoutDirtyFlags lhs, LayoutDirtyFlags rhs) noexcept {
+        return static_cast<LayoutDirtyFlags>(static_cast<uint8_t>(lhs) & static_cast<uint8_t>(rhs));
+    }
+    constexpr LayoutDirtyFlags operator~(LayoutDirtyFlags flags) noexcept {
+        return static_cast<LayoutDirtyFlags>(~static_cast<uint8_t>(flags) & static_cast<uint8_t>(LayoutDirtyFlags::eAll | LayoutDirtyFlags::eStructure | LayoutDirtyFlags::eInputs));
+    }
+    constexpr bool HasAnyFlag(LayoutDirtyFlags flags, LayoutDirtyFlags test) noexcept {
+        return (flags & test) != LayoutDirtyFlags::eNone;
+    }
+    constexpr bool HasAllFlags(LayoutDirtyFlags flags, LayoutDirtyFlags test) noexcept {
+        return (flags & test) == test;
+    }
+
+    constexpr uint32_t INVALID_LAYOUT_INDEX = std::numeric_limits<uint32_t>::max();
+
     struct Viewpanel;
 
+    constexpr int LAYOUT_EXTENT_UNUSED = -1;
+
+    // Extents the last measure of a panel actually read, LAYOUT_EXTENT_UNUSED for the ones it did
+    // not. A new rect only re-measures the panels whose key it changes.
+    struct LayoutMeasureKey {
+        int parentWidth{LAYOUT_EXTENT_UNUSED};     // percent width or min width
+        int parentHeight{LAYOUT_EXTENT_UNUSED};    // percent height or min height
+        int alignRange{LAYOUT_EXTENT_UNUSED};      // percent lengths of the children
+
+        constexpr bool operator==(const LayoutMeasureKey&) const noexcept = default;
+    };
+
+    // Identifies a Discadelta solve: the length distributed along the panel axis and the input
+    // stamp of the panel. The measured child lengths the solve read are kept in its slots.
+    struct LayoutArrangeKey {
+        int         length{LAYOUT_EXTENT_UNUSED};
+        uint64_t    inputStamp{0};
+
+        constexpr bool operator==(const LayoutArrangeKey&) const noexcept = default;
+    };
+
+    // Solved child segment, the offset is relative to the panel offset along its axis. base and
+    // min are the measured child lengths along the axis the solve read.
+    struct LayoutArrangeSlot {
+        int offset{0};
+        int length{0};
+        int base{0};
+        int min{0};
+    };
+
+    // Flattened, pre-ordered mirror of a Viewpanel tree that the layout passes stream through.
+    // Every subtree occupies the contiguous range [i, subtreeEnds[i]) and parents always precede
+    // their children, so measuring is a reverse sweep and arranging a forward sweep.
+    struct ViewpanelLayoutTree {
+        std::vector<Viewpanel*>         panels{};
+        std::vector<uint32_t>           parents{};
+        std::vector<uint32_t>           firstChildren{};
+        std::vector<uint32_t>           nextSiblings{};
+        std::vector<uint32_t>           subtreeEnds{};
+        std::vector<uint32_t>           childCounts{};
+        std::vector<uint8_t>            rows{};
+
+        std::vector<Length>             widths{};
+        std::vector<Length>             heights{};
+        std::vector<Length>             minWidths{};
+        std::vector<Length>             minHeights{};
+        std::vector<Length>             maxWidths{};
+        std::vector<Length>             maxHeights{};
+        std::vector<float>              flexGlows{};
+        std::vector<float>              flexShrinks{};
+        std::vector<int>                placingOrders{};
+
+        std::vector<RectLayout>         layouts{};
+        std::vector<vk::Rect2D>         rects{};
+        std::vector<LayoutDirtyFlags>   dirtyFlags{};
+
+        // Layout caches. Every panel keeps ARRANGE_CACHE_WAYS solves of its children, so the
+        // memory is fixed by the tree shape: arrangeSlots holds ways * childCounts[i] slots from
+        // arrangeSlotStarts[i].
+        static constexpr uint32_t       ARRANGE_CACHE_WAYS = 2;
+        std::vector<uint64_t>           inputStamps{};      // changes with the copied inputs of the panel or of a child
+        uint64_t                        nextInputStamp{0};
+        std::vector<LayoutMeasureKey>   measureKeys{};
+        std::vector<LayoutArrangeKey>   arrangeKeys{};      // ARRANGE_CACHE_WAYS per panel
+        std::vector<uint8_t>            arrangeVictims{};   // way the next miss of a panel overwrites
+        std::vector<uint32_t>           arrangeSlotStarts{};
+        std::vector<LayoutArrangeSlot>  arrangeSlots{};
+
+        std::vector<uint32_t>           measureOrder{};     // dirty panels of the current pass, pre-ordered
+        utilities::ScratchArena         scratch{};          // Discadelta contexts of the arrange pass
+        uint64_t                        arrangeVersion{0};  // bumped by every arrange pass that re-placed panels
+
+        // Opt-in parallel arrange: a panel whose subtree holds at least parallelThreshold panels
+        // fans its child subtrees of parallelGrain panels or more out to the pool.
+        jobs::ThreadPool*               pool{nullptr};
+        uint32_t                        parallelThreshold{1024};
+        uint32_t                        parallelGrain{64};
+        std::vector<std::unique_ptr<utilities::ScratchArena>> workerScratch{};
+
+        [[nodiscard]] bool empty() const noexcept { return panels.empty(); }
+        [[nodiscard]] uint32_t size() const noexcept { return static_cast<uint32_t>(panels.size()); }
+        [[nodiscard]] bool isRow(const uint32_t i) const noexcept { return rows[i] != 0; }
+        [[nodiscard]] bool hasParent(const uint32_t i) const noexcept { return parents[i] != INVALID_LAYOUT_INDEX; }
+        [[nodiscard]] Viewpanel* root() const noexcept { return panels.empty() ? nullptr : panels.front(); }
+
+        void clear() noexcept {
+            panels.clear(); parents.clear(); firstChildren.clear(); nextSiblings.clear();
+            subtreeEnds.clear(); childCounts.clear(); rows.clear();
+            widths.clear(); heights.clear(); minWidths.clear(); minHeights.clear();
+            maxWidths.clear(); maxHeights.clear(); flexGlows.clear(); flexShrinks.clear(); placingOrders.clear();
+            layouts.clear(); rects.clear(); dirtyFlags.clear(); measureOrder.clear();
+            inputStamps.clear(); measureKeys.clear(); arrangeKeys.clear(); arrangeVictims.clear();
+            arrangeSlotStarts.clear(); arrangeSlots.clear();
+        }
+
+        void reserve(const size_t count) {
+            panels.reserve(count); parents.reserve(count); firstChildren.reserve(count); nextSiblings.reserve(count);
+            subtreeEnds.reserve(count); childCounts.reserve(count); rows.reserve(count);
+            widths.reserve(count); heights.reserve(count); minWidths.reserve(count); minHeights.reserve(count);
+            maxWidths.reserve(count); maxHeights.reserve(count); flexGlows.reserve(count); flexShrinks.reserve(count); placingOrders.reserve(count);
+            layouts.reserve(count); rects.reserve(count); dirtyFlags.reserve(count); measureOrder.reserve(count);
+            inputStamps.reserve(count); measureKeys.reserve(count); arrangeKeys.reserve(count * ARRANGE_CACHE_WAYS);
+            arrangeVictims.reserve(count); arrangeSlotStarts.reserve(count);
+        }
+    };
+
+    // Uniform grid over the arranged rects of a ViewpanelLayoutTree. Every cell lists the tree
+    // indices of the pickable panels and resizer zones overlapping it in pre-order, so a pick only
+    // tests the few candidates of one cell and the last match is the deepest panel.
+    struct ViewpanelHitGrid {
+        static constexpr int32_t    DEFAULT_CELL_SIZE = 64;
+        static constexpr uint32_t   MAX_CELL_COUNT = 4096;
+
+        vk::Rect2D                  bounds{{0,0},{0,0}};
+        int32_t                     cellSize{DEFAULT_CELL_SIZE};
+        uint32_t                    columns{0};
+        uint32_t                    rows{0};
+        uint64_t                    arrangeVersion{std::numeric_limits<uint64_t>::max()};   // tree version the cells were built from
+
+        std::vector<uint32_t>       panelCellStarts{};      // columns * rows + 1 offsets into panelCells
+        std::vector<uint32_t>       panelCells{};
+        std::vector<uint32_t>       resizerCellStarts{};    // columns * rows + 1 offsets into resizerCells
+        std::vector<uint32_t>       resizerCells{};
+
+        [[nodiscard]] constexpr bool empty() const noexcept { return columns == 0 || rows == 0; }
+        [[nodiscard]] constexpr uint32_t cellCount() const noexcept { return columns * rows; }
+
+        // Forces a rebuild on the next update, for changes the arrange pass does not see
+        // (picking mode, resizer zones).
+        void invalidate() noexcept { arrangeVersion = std::numeric_limits<uint64_t>::max(); }
+
+        void clear() noexcept {
+            columns = 0; rows = 0;
+            panelCellStarts.clear(); panelCells.clear(); resizerCellStarts.clear(); resizerCells.clear();
+            invalidate();
+        }
+    };
+
     struct ViewpanelResizerContext {
         ViewpanelResizerContext() = default;
         ~ViewpanelResizerContext() = default;
@@ -1076,10 +1967,19 @@ export namespace ufox {
 
         vk::ClearColorValue     clearColor{0.5f, 0.5f, 0.5f, 1.0f};
         vk::ClearColorValue     clearColor2{0.8f, 0.8f, 0.8f, 1.0f};
+        utilities::NameHandle   styleId{};          // gui::StyleResource::id, without one the clear colors are drawn
+
+        bool                    hovered{false};     // toggled by the viewport pick only when it changes
 
         float                   resizerValue{0.0f};
         float                   flexGlow{1.0f};
         float                   flexShrink{1.0f};
+        int                     placingOrder{0};    // placed by ascending order, ties keep child order
+
+        // New panels start fully dirty. Writing the layout inputs above directly after the
+        // first layout requires a markDirty() call, the setters below do it on change only.
+        LayoutDirtyFlags        dirtyFlags{LayoutDirtyFlags::eAll};
+        uint32_t                layoutIndex{INVALID_LAYOUT_INDEX};  // slot in the owning ViewpanelLayoutTree
 
         [[nodiscard]] bool hasParent() const noexcept { return parent != nullptr; }
         [[nodiscard]] bool isChildrenEmpty() const noexcept { return children.empty(); }
@@ -1088,7 +1988,27 @@ export namespace ufox {
         [[nodiscard]] size_t getLastChildIndex() const noexcept { return children.size() - 1; }
         [[nodiscard]] bool isRow() const noexcept { return alignment == PanelAlignment::eRow; }
         [[nodiscard]] bool isColumn() const noexcept { return alignment == PanelAlignment::eColumn; }
+        [[nodiscard]] bool isMeasureDirty() const noexcept { return HasAnyFlag(dirtyFlags, LayoutDirtyFlags::eMeasure); }
+        [[nodiscard]] bool isArrangeDirty() const noexcept { return HasAnyFlag(dirtyFlags, LayoutDirtyFlags::eArrange); }
+
+        // The inputs of this panel changed, its ancestors only have to re-measure and re-arrange.
+        void markDirty(const LayoutDirtyFlags flags = LayoutDirtyFlags::eAll) noexcept {
+            dirtyFlags = dirtyFlags | LayoutDirtyFlags::eInputs;
+            propagateDirty(flags);
+        }
 
+        void clearDirty(const LayoutDirtyFlags flags) noexcept { dirtyFlags = dirtyFlags & ~flags; }
+
+        void setWidth(const Length& value) noexcept { setLayoutInput(width, value); }
+        void setHeight(const Length& value) noexcept { setLayoutInput(height, value); }
+        void setMinWidth(const Length& value) noexcept { setLayoutInput(minWidth, value); }
+        void setMinHeight(const Length& value) noexcept { setLayoutInput(minHeight, value); }
+        void setMaxWidth(const Length& value) noexcept { setLayoutInput(maxWidth, value); }
+        void setMaxHeight(const Length& value) noexcept { setLayoutInput(maxHeight, value); }
+        void setFlexGlow(const float value) noexcept { setLayoutInput(flexGlow, value); }
+        void setFlexShrink(const float value) noexcept { setLayoutInput(flexShrink, value); }
+        void setAlignment(const PanelAlignment value) noexcept { setLayoutInput(alignment, value); }
+        void setPlacingOrder(const int value) noexcept { setLayoutInput(placingOrder, value); }
 
         void add(Viewpanel* child)
         {
@@ -1097,6 +2017,7 @@ export namespace ufox {
                 if (child->parent) child->parent->remove(child);
                 child->parent = this;
                 children.push_back(child);
+                markStructureDirty();
             }
         }
 
@@ -1108,105 +2029,209 @@ export namespace ufox {
             {
                 child->parent = nullptr;
                 children.erase(it);
+                child->markDirty();
+                markStructureDirty();
             }
         }
 
+        // Pre-ordered copy of the subtree. Hot paths iterate ViewpanelLayoutTree::panels instead.
         [[nodiscard]] std::vector<Viewpanel*> getAllPanels() const &
         {
             std::vector<Viewpanel*> result;
-            result.push_back(const_cast<Viewpanel*>(this));
+            std::vector<const Viewpanel*> stack{this};
 
-            std::function<void(const Viewpanel&)> collect = [&](const Viewpanel& panel)
+            while (!stack.empty())
             {
-                for (size_t i = 0; i < panel.childCount(); ++i)
+                const Viewpanel* panel = stack.back();
+                stack.pop_back();
+                result.push_back(const_cast<Viewpanel*>(panel));
+
+                for (auto it = panel->children.rbegin(); it != panel->children.rend(); ++it)
                 {
-                    Viewpanel* child = panel.getChild(i);
-                    result.push_back(child);
-                    collect(*child);
+                    if (*it) stack.push_back(*it);
                 }
-            };
+            }
 
-            collect(*this);
             return result;
         }
 
         void setBackgroundColor(const vk::ClearColorValue& color) {
             clearColor = color;
         }
+
+    private:
+        template<typename T>
+        void setLayoutInput(T& field, const T& value) noexcept {
+            if (field == value) return;
+            field = value;
+            markDirty();
+        }
+
+        void propagateDirty(const LayoutDirtyFlags flags) noexcept {
+            for (Viewpanel* panel = this; panel && !HasAllFlags(panel->dirtyFlags, flags); panel = panel->parent) {
+                panel->dirtyFlags = panel->dirtyFlags | flags;
+            }
+        }
+
+        // Only this panel is re-flattened, its ancestors keep their slots and re-measure.
+        void markStructureDirty() noexcept {
+            dirtyFlags = dirtyFlags | LayoutDirtyFlags::eStructure;
+            propagateDirty(LayoutDirtyFlags::eAll);
+        }
     };
 
+    // Without a window the viewport is headless: layout, hit testing and cursor state work the
+    // same, nothing is forwarded to the window system.
     struct Viewport {
-        explicit Viewport(const windowing::WindowResource& window) : window(window) {}
+        Viewport() = default;
+        explicit Viewport(const windowing::WindowResource& window) : window(&window) {}
         ~Viewport() = default;
 
-        const windowing::WindowResource&                    window;
+        const windowing::WindowResource*                    window = nullptr;
         vk::Extent2D                                        extent{};
         Viewpanel*                                          panel = nullptr;
         Viewpanel*                                          hoveredPanel = nullptr;
         Viewpanel*                                          focusedPanel = nullptr;
         ViewpanelResizerContext                             resizerContext{};
+        ViewpanelLayoutTree                                 layoutTree{};
+        ViewpanelHitGrid                                    hitGrid{};
         std::optional<input::EventCallbackPool::Handler>    mouseMoveEventHandle{};
         std::optional<input::EventCallbackPool::Handler>    leftClickEventHandle{};
     };
 
 
 
-    struct DiscadeltaBaseFiller {
-
-        int                     remainLength{0};
-        int                     accumulateOffset{0};
-        float                   accumulateStepRatio{0.0f};
-        std::vector<int*>       lengths{};
-        std::vector<int>        mins{};
-        std::vector<int>        reduceDistances{};
-        std::vector<float>      stepRatios{};
+    // Per-child inputs and results of one Discadelta solve, indexed in child order. Storage is
+    // drawn from a pass scoped memory resource (see ViewpanelLayoutTree::scratch), the default
+    // resource is only a fallback.
+    struct DiscadeltaContext {
+        int                         inputLength{0};
+        int                         accumulateOffset{0};
+        int                         accumulateBaseLength{0};
+        int                         accumulateSolidify{0};
+        int                         accumulateCapacity{0};
+        float                       accumulateGlowRatio{0.0f};
+        bool                        hasPlacingOrder{false};
+
+        std::pmr::vector<int>       baseLengths{};      // clamped base, compressed in place
+        std::pmr::vector<int>       glowLengths{};
+        std::pmr::vector<int>       offsets{};
+        std::pmr::vector<int>       solidifies{};       // part of the base flexShrink does not compress
+        std::pmr::vector<int>       capacities{};       // compressible part of the base
+        std::pmr::vector<int>       mins{};
+        std::pmr::vector<int>       glowRooms{};        // max - base
+        std::pmr::vector<float>     glowRatios{};
+        std::pmr::vector<int>       placingOrders{};
+        std::pmr::vector<uint32_t>  priorityIndices{};
+        std::pmr::vector<float>     priorityKeys{};
 
-        DiscadeltaBaseFiller() = default;
-        ~DiscadeltaBaseFiller() = default;
+        DiscadeltaContext() = default;
+        ~DiscadeltaContext() = default;
 
-        explicit DiscadeltaBaseFiller(const size_t& steps) {
+        explicit DiscadeltaContext(const int& inputLength_, const int& accumulateOffset_, const size_t& steps, std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : inputLength(inputLength_), accumulateOffset(accumulateOffset_),
+              baseLengths(resource), glowLengths(resource), offsets(resource), solidifies(resource), capacities(resource),
+              mins(resource), glowRooms(resource), glowRatios(resource), placingOrders(resource),
+              priorityIndices(resource), priorityKeys(resource) {
             if (steps > 0) {
-                lengths.reserve(steps);
+                baseLengths.reserve(steps);
+                glowLengths.reserve(steps);
+                offsets.reserve(steps);
+                solidifies.reserve(steps);
+                capacities.reserve(steps);
                 mins.reserve(steps);
-                reduceDistances.reserve(steps);
-                stepRatios.reserve(steps);
+                glowRooms.reserve(steps);
+                glowRatios.reserve(steps);
+                placingOrders.reserve(steps);
+                priorityIndices.reserve(steps);
+                priorityKeys.reserve(steps);
             }
         }
-    };
-
-    struct DiscadeltaGlowFiller {
-        int                     remainLength{0};
-        float                   accumulateStepRatio{0.0f};
-        std::vector<int*>       lengths{};
-        std::vector<int>        maxs{};
-        std::vector<float>      stepRatios{};
-
-        DiscadeltaGlowFiller() = default;
-        ~DiscadeltaGlowFiller() = default;
 
-        explicit DiscadeltaGlowFiller(const size_t& steps) {
-            if (steps > 0) {
-                lengths.reserve(steps);
-                maxs.reserve(steps);
-                stepRatios.reserve(steps);
-            }
-        }
+        [[nodiscard]] size_t size() const noexcept { return baseLengths.size(); }
     };
 
-    struct DiscadeltaContext {
-        int                     accumulateOffset{0};
-        std::vector<int>        baseLengths{};
-        std::vector<int>        glowLengths{};
+    // Many independent Discadelta problems sharing one segment count, solved together by
+    // SolveDiscadeltaBatch. Segment fields are rank-major: value[segment * problemCount + problem],
+    // so one rank of every problem is contiguous and a vector lane maps to one problem.
+    struct DiscadeltaBatch {
+        static constexpr size_t TILE_SIZE = 256;        // problems solved per cache resident tile
+
+        size_t                  problemCount{0};
+        size_t                  segmentCount{0};
+
+        std::vector<float>      inputDistances{};       // [problem]
+        std::vector<float>      bases{};
+        std::vector<float>      compressRatios{};
+        std::vector<float>      expandRatios{};
+        std::vector<float>      mins{};
+        std::vector<float>      maxs{};
+        std::vector<float>      distances{};            // result
+
+        // Tile scratch, [segment * TILE_SIZE + tile problem]. Validated segments in segment order,
+        // then permuted into the priority order of their problem, ranks map back to segment order.
+        std::vector<float>      validatedBases{};
+        std::vector<float>      validatedCapacities{};
+        std::vector<float>      validatedSolidifies{};
+        std::vector<float>      validatedMins{};
+        std::vector<float>      validatedMaxDeltas{};
+        std::vector<float>      validatedExpandRatios{};
+        std::vector<float>      priorityBases{};
+        std::vector<float>      priorityCapacities{};   // compressible part of the base
+        std::vector<float>      prioritySolidifies{};
+        std::vector<float>      priorityMins{};
+        std::vector<float>      priorityMaxDeltas{};    // max - base
+        std::vector<float>      priorityExpandRatios{};
+        std::vector<float>      priorityDistances{};
+        std::vector<float>      priorityKeys{};
+        std::vector<uint32_t>   priorityRanks{};
+
+        // Tile scratch, [tile problem]
+        std::vector<float>      validatedInputs{};
+        std::vector<float>      accumulateBases{};
+        std::vector<float>      accumulateSolidifies{};
+        std::vector<float>      accumulateExpandRatios{};
+        std::vector<uint32_t>   compressMasks{};        // ~0u when the problem compresses
+
+        std::vector<float>      segmentKeys{};          // [segment], long segment lists sort per problem
+        std::vector<uint32_t>   segmentOrder{};
+
+        DiscadeltaBatch() = default;
+        ~DiscadeltaBatch() = default;
+
+        DiscadeltaBatch(const size_t problems, const size_t segments) { resize(problems, segments); }
+
+        // Keeps the capacity, a batch re-solved with the same or smaller shape never allocates.
+        void resize(const size_t problems, const size_t segments) {
+            problemCount = problems;
+            segmentCount = segments;
+            const size_t values = problems * segments;
+            const size_t tileValues = TILE_SIZE * segments;
+
+            inputDistances.resize(problems);
+            for (auto* field : {&bases, &compressRatios, &expandRatios, &mins, &maxs, &distances}) {
+                field->resize(values);
+            }
 
-        DiscadeltaContext() = default;
-        ~DiscadeltaContext() = default;
+            for (auto* field : {&validatedBases, &validatedCapacities, &validatedSolidifies, &validatedMins,
+                                &validatedMaxDeltas, &validatedExpandRatios,
+                                &priorityBases, &priorityCapacities, &prioritySolidifies, &priorityMins,
+                                &priorityMaxDeltas, &priorityExpandRatios, &priorityDistances, &priorityKeys}) {
+                field->resize(tileValues);
+            }
+            priorityRanks.resize(tileValues);
 
-        explicit DiscadeltaContext(const int& accumulateOffset_, const size_t& steps):accumulateOffset(accumulateOffset_) {
-            if (steps > 0) {
-                baseLengths.reserve(steps);
-                glowLengths.reserve(steps);
+            for (auto* field : {&validatedInputs, &accumulateBases, &accumulateSolidifies, &accumulateExpandRatios}) {
+                field->resize(TILE_SIZE);
             }
+            compressMasks.resize(TILE_SIZE);
+
+            segmentKeys.resize(segments);
+            segmentOrder.resize(segments);
         }
+
+        [[nodiscard]] constexpr size_t at(const size_t segment, const size_t problem) const noexcept { return segment * problemCount + problem; }
+        [[nodiscard]] static constexpr size_t tileAt(const size_t segment, const size_t problem) noexcept { return segment * TILE_SIZE + problem; }
     };
 
 
@@ -1260,7 +2285,7 @@ export namespace ufox {
 
         struct MeshResource {
             std::string                             name;
-            size_t                                  id{0};
+            utilities::NameHandle                   id{};
 
             std::vector<Vertex>                     vertices;
             std::vector<uint16_t>                   indices;
@@ -1268,7 +2293,7 @@ export namespace ufox {
             std::optional<gpu::vulkan::Buffer>      vertexBuffer;
             std::optional<gpu::vulkan::Buffer>      indexBuffer;
 
-            explicit MeshResource(const std::string_view name_ = {}): name(name_) , id(utilities::GenerateUniqueID(name_)) {}
+            explicit MeshResource(const std::string_view name_ = {}): name(name_) , id(utilities::InternName(name_)) {}
         };
     }
 
@@ -1281,11 +2306,12 @@ export namespace ufox {
             glm::vec4                                       borderLeftColor = {0.0f, 0.0f, 0.0f, 1.0f};
             glm::vec4                                       borderThickness = {1.0f, 1.0f, 1.0f, 1.0f}; // Top, right, bottom, left
             glm::vec4                                       cornerRadius = {10.0f, 10.0f, 10.0f, 10.0f}; // Top-left, top-right, bottom-left, bottom-right
+            glm::vec4                                       hoverBackgroundColor = {0.8f, 0.8f, 0.8f, 1.0f};
         };
 
         struct StyleResource {
             std::string                                     name;
-            size_t                                          id{0};
+            utilities::NameHandle                           id{};           // InternName(name)
             Style                                           content;
             gpu::vulkan::Buffer                             buffer{};
         };
@@ -1297,7 +2323,7 @@ export namespace ufox {
             glm::vec3                                       rotation = {0.0f, 0.0f, 0.0f};
             glm::vec3                                       scale = {1.0f, 1.0f, 1.0f};
 
-            std::vector<gpu::vulkan::Buffer>                uniformBuffers;
+            gpu::vulkan::FrameArena                         uniformArena{};         // one segment per swapchain image
             std::vector<void*>                              uniformBuffersMapped;
 
             std::vector<vk::raii::DescriptorSet>            descriptorSets;
@@ -1313,6 +2339,84 @@ export namespace ufox {
             }
         };
 
+        // One panel of the GUI pass. Fed as per-instance vertex attributes next to the quad mesh,
+        // the locations follow geometry::Vertex, see res/shaders/gui_rect.slang.
+        struct RectInstance {
+            glm::vec4                                       rect{};                 // x, y, width, height in pixels
+            glm::vec4                                       backgroundColor{};
+            glm::vec4                                       borderTopColor{};
+            glm::vec4                                       borderRightColor{};
+            glm::vec4                                       borderBottomColor{};
+            glm::vec4                                       borderLeftColor{};
+            glm::vec4                                       borderThickness{};      // top, right, bottom, left
+            glm::vec4                                       cornerRadius{};         // top-left, top-right, bottom-left, bottom-right
+
+            static constexpr uint32_t ATTRIBUTE_COUNT = 8;
+
+            static constexpr vk::VertexInputBindingDescription
+            getBindingDescription(uint32_t binding) {
+                vk::VertexInputBindingDescription d{};
+                d.setBinding(binding)
+                 .setStride(sizeof(RectInstance))
+                 .setInputRate(vk::VertexInputRate::eInstance);
+                return d;
+            }
+
+            static constexpr std::array<vk::VertexInputAttributeDescription, ATTRIBUTE_COUNT>
+            getAttributeDescriptions(uint32_t binding, uint32_t firstLocation) {
+                std::array<vk::VertexInputAttributeDescription, ATTRIBUTE_COUNT> a{};
+                for (uint32_t i = 0; i < ATTRIBUTE_COUNT; ++i) {
+                    a[i].setBinding(binding).setLocation(firstLocation + i)
+                        .setFormat(vk::Format::eR32G32B32A32Sfloat)
+                        .setOffset(static_cast<uint32_t>(i * sizeof(glm::vec4)));
+                }
+                return a;
+            }
+        };
+
+        static_assert(sizeof(RectInstance) == RectInstance::ATTRIBUTE_COUNT * sizeof(glm::vec4));
+
+        // Instances [begin, end) that differ from what a GPU copy holds.
+        struct RectInstanceRange {
+            uint32_t                                        begin{0};
+            uint32_t                                        end{0};
+
+            [[nodiscard]] constexpr bool empty() const noexcept { return begin >= end; }
+
+            constexpr void merge(const RectInstanceRange& other) noexcept {
+                if (other.empty()) return;
+                if (empty()) *this = other;
+                else { begin = std::min(begin, other.begin); end = std::max(end, other.end); }
+            }
+        };
+
+        // CPU side of the instanced GUI pass, rebuilt from the layout tree every frame. Every
+        // frame in flight owns a copy of the instances on the GPU, pendingUploads collects what
+        // each copy is missing until that frame records again.
+        struct RectBatch {
+            std::vector<RectInstance>                       instances{};            // grows, never shrinks
+            uint32_t                                        count{0};               // drawn this frame
+            uint32_t                                        changed{0};             // rewritten by the last build
+            std::vector<RectInstanceRange>                  pendingUploads{};       // one per frame in flight
+            std::vector<vk::Rect2D>                         damage{};               // old and new rects of the last build's changes
+        };
+
+        constexpr uint32_t DAMAGE_REGION_LIMIT = 8;     // above it the closest regions are merged
+
+        // Screen regions to repaint in the persistent canvas the frame is drawn into. The canvas
+        // always holds the last frame, fullRepaint marks it as undefined.
+        struct DamageTracker {
+            vk::Extent2D                                    extent{};
+            std::vector<vk::Rect2D>                         frame{};                // damage since the last recorded frame
+            bool                                            fullRepaint{true};
+        };
+
+        struct RectPushConstants {
+            glm::vec2                                       viewportSize{};
+        };
+
+        constexpr uint32_t RECT_BATCH_INITIAL_CAPACITY = 256;
+
         struct GUIResource {
             std::vector<StyleResource>                      styles{};
             std::optional<vk::raii::PipelineCache>          pipelineCache{};
@@ -1323,6 +2427,12 @@ export namespace ufox {
             std::optional<vk::raii::DescriptorPool>         descriptorPool{};
 
             std::optional<GUIElement>                       elements{};
+
+            std::optional<vk::raii::PipelineLayout>         rectPipelineLayout{};
+            std::optional<vk::raii::Pipeline>               rectPipeline{};
+            RectBatch                                       rectBatch{};
+            gpu::vulkan::Buffer                             rectInstanceBuffer{};   // rectInstanceCapacity per frame in flight
+            uint32_t                                        rectInstanceCapacity{0};
         };
     }
 }
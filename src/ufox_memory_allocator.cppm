@@ -0,0 +1,562 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_raii.hpp>
+
+export module ufox_memory_allocator;
+
+export namespace ufox::gpu::memory {
+    constexpr vk::DeviceSize DEFAULT_BLOCK_SIZE = 64ull << 20;
+    constexpr vk::DeviceSize SMALL_HEAP_LIMIT = 1ull << 30;         // heaps up to this size get heapSize / 8 blocks
+    constexpr uint32_t TLSF_SECOND_LEVEL_BITS = 4;
+    constexpr uint32_t TLSF_SECOND_LEVEL_COUNT = 1u << TLSF_SECOND_LEVEL_BITS;
+    constexpr uint32_t TLSF_FIRST_LEVEL_COUNT = 48;
+    constexpr uint32_t INVALID_INDEX = ~0u;
+    constexpr vk::DeviceSize FRAME_SEGMENT_ALIGNMENT = 256;        // largest minUniformBufferOffsetAlignment in the wild
+
+    constexpr vk::DeviceSize AlignUp(const vk::DeviceSize value, const vk::DeviceSize alignment) noexcept {
+        return alignment <= 1 ? value : (value + alignment - 1) / alignment * alignment;
+    }
+
+    struct TlsfAllocation {
+        vk::DeviceSize  offset{0};
+        uint32_t        node{INVALID_INDEX};    // passed back to free()
+    };
+
+    // Two-level segregated fit over the offsets [0, capacity). Free regions are binned by size
+    // class, allocation and free are O(1) and neighbouring free regions are always coalesced.
+    class TlsfAllocator {
+    public:
+        explicit TlsfAllocator(const vk::DeviceSize capacity_ = 0) : capacity(capacity_) {
+            if (capacity > 0) insertFree(makeNode(0, capacity, INVALID_INDEX, INVALID_INDEX));
+        }
+
+        [[nodiscard]] std::optional<TlsfAllocation> allocate(vk::DeviceSize size, const vk::DeviceSize alignment) {
+            size = std::max<vk::DeviceSize>(size, 1);
+            const uint32_t found = findFree(size + (alignment > 1 ? alignment - 1 : 0));
+            if (found == INVALID_INDEX) return std::nullopt;
+            removeFree(found);
+
+            // front padding and tail go back to the free lists, their physical neighbours are in use
+            const vk::DeviceSize aligned = AlignUp(nodes[found].offset, alignment);
+            if (const vk::DeviceSize padding = aligned - nodes[found].offset; padding > 0) {
+                const uint32_t front = makeNode(nodes[found].offset, padding, nodes[found].prevPhysical, found);
+                if (nodes[front].prevPhysical != INVALID_INDEX) nodes[nodes[front].prevPhysical].nextPhysical = front;
+                nodes[found].prevPhysical = front;
+                nodes[found].offset = aligned;
+                nodes[found].size -= padding;
+                insertFree(front);
+            }
+            if (const vk::DeviceSize remainder = nodes[found].size - size; remainder > 0) {
+                const uint32_t tail = makeNode(nodes[found].offset + size, remainder, found, nodes[found].nextPhysical);
+                if (nodes[tail].nextPhysical != INVALID_INDEX) nodes[nodes[tail].nextPhysical].prevPhysical = tail;
+                nodes[found].nextPhysical = tail;
+                nodes[found].size = size;
+                insertFree(tail);
+            }
+
+            usedBytes += size;
+            ++allocationCount;
+            return TlsfAllocation{nodes[found].offset, found};
+        }
+
+        void free(uint32_t node) {
+            usedBytes -= nodes[node].size;
+            --allocationCount;
+
+            if (const uint32_t previous = nodes[node].prevPhysical; previous != INVALID_INDEX && nodes[previous].free) {
+                removeFree(previous);
+                nodes[previous].size += nodes[node].size;
+                unlinkPhysical(node);
+                releaseNode(node);
+                node = previous;
+            }
+            if (const uint32_t next = nodes[node].nextPhysical; next != INVALID_INDEX && nodes[next].free) {
+                removeFree(next);
+                nodes[node].size += nodes[next].size;
+                unlinkPhysical(next);
+                releaseNode(next);
+            }
+            insertFree(node);
+        }
+
+        [[nodiscard]] vk::DeviceSize size() const noexcept { return capacity; }
+        [[nodiscard]] vk::DeviceSize used() const noexcept { return usedBytes; }
+        [[nodiscard]] uint32_t allocations() const noexcept { return allocationCount; }
+        [[nodiscard]] bool empty() const noexcept { return allocationCount == 0; }
+        [[nodiscard]] uint32_t freeRegions() const noexcept { return freeRegionCount; }
+
+        [[nodiscard]] vk::DeviceSize largestFreeRegion() const noexcept {
+            if (firstLevelBitmap == 0) return 0;
+            const uint32_t first = static_cast<uint32_t>(std::bit_width(firstLevelBitmap)) - 1;
+            const uint32_t second = static_cast<uint32_t>(std::bit_width(secondLevelBitmaps[first])) - 1;
+            vk::DeviceSize largest = 0;
+            for (uint32_t node = heads[first][second]; node != INVALID_INDEX; node = nodes[node].nextFree) {
+                largest = std::max(largest, nodes[node].size);
+            }
+            return largest;
+        }
+
+    private:
+        struct Node {
+            vk::DeviceSize  offset{0};
+            vk::DeviceSize  size{0};
+            uint32_t        prevPhysical{INVALID_INDEX};
+            uint32_t        nextPhysical{INVALID_INDEX};
+            uint32_t        prevFree{INVALID_INDEX};
+            uint32_t        nextFree{INVALID_INDEX};
+            bool            free{false};
+        };
+
+        // Sizes below TLSF_SECOND_LEVEL_COUNT get a list each, above that every power of two is
+        // split into TLSF_SECOND_LEVEL_COUNT linear classes.
+        static void Mapping(const vk::DeviceSize size, uint32_t& first, uint32_t& second) noexcept {
+            if (size < TLSF_SECOND_LEVEL_COUNT) {
+                first = 0;
+                second = static_cast<uint32_t>(size);
+                return;
+            }
+            const auto log2 = static_cast<uint32_t>(std::bit_width(size)) - 1;
+            first = log2 - TLSF_SECOND_LEVEL_BITS + 1;
+            second = static_cast<uint32_t>(size >> (log2 - TLSF_SECOND_LEVEL_BITS)) - TLSF_SECOND_LEVEL_COUNT;
+        }
+
+        // Rounded up to the next size class, any region of the list found for it fits. Only when
+        // there is none the class of the size itself is searched, its regions may be too small.
+        [[nodiscard]] uint32_t findFree(const vk::DeviceSize size) const noexcept {
+            vk::DeviceSize rounded = size;
+            if (size >= TLSF_SECOND_LEVEL_COUNT) {
+                const auto log2 = static_cast<uint32_t>(std::bit_width(size)) - 1;
+                rounded += (vk::DeviceSize{1} << (log2 - TLSF_SECOND_LEVEL_BITS)) - 1;
+            }
+
+            uint32_t first = 0, second = 0;
+            Mapping(rounded, first, second);
+            if (first < TLSF_FIRST_LEVEL_COUNT) {
+                uint32_t secondMap = secondLevelBitmaps[first] & (~0u << second);
+                if (secondMap == 0) {
+                    const uint64_t firstMap = firstLevelBitmap & (~0ull << (first + 1));
+                    first = firstMap == 0 ? TLSF_FIRST_LEVEL_COUNT : static_cast<uint32_t>(std::countr_zero(firstMap));
+                    if (first < TLSF_FIRST_LEVEL_COUNT) secondMap = secondLevelBitmaps[first];
+                }
+                if (secondMap != 0) return heads[first][static_cast<uint32_t>(std::countr_zero(secondMap))];
+            }
+
+            Mapping(size, first, second);
+            if (first >= TLSF_FIRST_LEVEL_COUNT) return INVALID_INDEX;
+            for (uint32_t node = heads[first][second]; node != INVALID_INDEX; node = nodes[node].nextFree) {
+                if (nodes[node].size >= size) return node;
+            }
+            return INVALID_INDEX;
+        }
+
+        void insertFree(const uint32_t node) noexcept {
+            uint32_t first = 0, second = 0;
+            Mapping(nodes[node].size, first, second);
+            nodes[node].free = true;
+            nodes[node].prevFree = INVALID_INDEX;
+            nodes[node].nextFree = heads[first][second];
+            if (heads[first][second] != INVALID_INDEX) nodes[heads[first][second]].prevFree = node;
+            heads[first][second] = node;
+            firstLevelBitmap |= 1ull << first;
+            secondLevelBitmaps[first] |= 1u << second;
+            ++freeRegionCount;
+        }
+
+        void removeFree(const uint32_t node) noexcept {
+            uint32_t first = 0, second = 0;
+            Mapping(nodes[node].size, first, second);
+            const Node& entry = nodes[node];
+            if (entry.prevFree != INVALID_INDEX) nodes[entry.prevFree].nextFree = entry.nextFree;
+            else heads[first][second] = entry.nextFree;
+            if (entry.nextFree != INVALID_INDEX) nodes[entry.nextFree].prevFree = entry.prevFree;
+
+            if (heads[first][second] == INVALID_INDEX) {
+                secondLevelBitmaps[first] &= ~(1u << second);
+                if (secondLevelBitmaps[first] == 0) firstLevelBitmap &= ~(1ull << first);
+            }
+            nodes[node].free = false;
+            --freeRegionCount;
+        }
+
+        void unlinkPhysical(const uint32_t node) noexcept {
+            const Node& entry = nodes[node];
+            if (entry.prevPhysical != INVALID_INDEX) nodes[entry.prevPhysical].nextPhysical = entry.nextPhysical;
+            if (entry.nextPhysical != INVALID_INDEX) nodes[entry.nextPhysical].prevPhysical = entry.prevPhysical;
+        }
+
+        uint32_t makeNode(const vk::DeviceSize offset, const vk::DeviceSize size, const uint32_t prevPhysical, const uint32_t nextPhysical) {
+            uint32_t node = INVALID_INDEX;
+            if (!unusedNodes.empty()) {
+                node = unusedNodes.back();
+                unusedNodes.pop_back();
+            } else {
+                node = static_cast<uint32_t>(nodes.size());
+                nodes.emplace_back();
+            }
+            nodes[node] = Node{offset, size, prevPhysical, nextPhysical, INVALID_INDEX, INVALID_INDEX, false};
+            return node;
+        }
+
+        void releaseNode(const uint32_t node) { unusedNodes.push_back(node); }
+
+        vk::DeviceSize                                                                  capacity{0};
+        vk::DeviceSize                                                                  usedBytes{0};
+        uint32_t                                                                        allocationCount{0};
+        uint32_t                                                                        freeRegionCount{0};
+        std::vector<Node>                                                               nodes{};
+        std::vector<uint32_t>                                                           unusedNodes{};
+        uint64_t                                                                        firstLevelBitmap{0};
+        std::array<uint32_t, TLSF_FIRST_LEVEL_COUNT>                                    secondLevelBitmaps{};
+        std::array<std::array<uint32_t, TLSF_SECOND_LEVEL_COUNT>, TLSF_FIRST_LEVEL_COUNT>  heads = [] {
+            std::array<std::array<uint32_t, TLSF_SECOND_LEVEL_COUNT>, TLSF_FIRST_LEVEL_COUNT> lists{};
+            for (auto& list : lists) list.fill(INVALID_INDEX);
+            return lists;
+        }();
+    };
+
+    // Bump allocator over [0, capacity), only reset as a whole. Backs the per-frame arenas.
+    class LinearAllocator {
+    public:
+        explicit LinearAllocator(const vk::DeviceSize capacity_ = 0) : capacity(capacity_) {}
+
+        [[nodiscard]] std::optional<vk::DeviceSize> allocate(const vk::DeviceSize size, const vk::DeviceSize alignment) noexcept {
+            const vk::DeviceSize aligned = AlignUp(head, alignment);
+            if (aligned > capacity || size > capacity - aligned) return std::nullopt;
+            head = aligned + size;
+            return aligned;
+        }
+
+        void reset() noexcept { head = 0; }
+
+        [[nodiscard]] vk::DeviceSize used() const noexcept { return head; }
+        [[nodiscard]] vk::DeviceSize size() const noexcept { return capacity; }
+
+    private:
+        vk::DeviceSize  capacity{0};
+        vk::DeviceSize  head{0};
+    };
+
+    // Transient per-frame data, one linear segment per frame in flight. beginFrame rewinds the
+    // segment of a frame once its fence has been waited on, offsets span the whole ring.
+    class FrameRingAllocator {
+    public:
+        FrameRingAllocator() = default;
+        FrameRingAllocator(const vk::DeviceSize segmentSize_, const uint32_t frameCount)
+            : segmentSize(AlignUp(segmentSize_, FRAME_SEGMENT_ALIGNMENT)), segments(frameCount, LinearAllocator(segmentSize)) {}
+
+        void beginFrame(const uint32_t frameIndex) noexcept {
+            current = frameIndex % static_cast<uint32_t>(segments.size());
+            segments[current].reset();
+        }
+
+        [[nodiscard]] std::optional<vk::DeviceSize> allocate(const vk::DeviceSize size, const vk::DeviceSize alignment) noexcept {
+            const std::optional<vk::DeviceSize> local = segments[current].allocate(size, alignment);
+            if (!local) return std::nullopt;
+            return current * segmentSize + *local;
+        }
+
+        [[nodiscard]] vk::DeviceSize used() const noexcept { return segments.empty() ? 0 : segments[current].used(); }
+        [[nodiscard]] vk::DeviceSize size() const noexcept { return segmentSize * segments.size(); }
+        [[nodiscard]] uint32_t frameCount() const noexcept { return static_cast<uint32_t>(segments.size()); }
+
+    private:
+        vk::DeviceSize                  segmentSize{0};
+        std::vector<LinearAllocator>    segments{};
+        uint32_t                        current{0};
+    };
+
+    struct MemoryBlockHandle {
+        vk::DeviceMemory    memory{};
+        void*               mapped{nullptr};    // whole block, set for host-visible memory types
+    };
+
+    // Where the device memory comes from. Everything above it only manages offsets, so the
+    // allocator runs against a fake backend on CPU as well.
+    class MemoryBackend {
+    public:
+        virtual ~MemoryBackend() = default;
+        virtual std::optional<MemoryBlockHandle> allocateBlock(uint32_t memoryTypeIndex, vk::DeviceSize size, bool map) = 0;
+        virtual void freeBlock(const MemoryBlockHandle& block) = 0;
+    };
+
+    class VulkanMemoryBackend final : public MemoryBackend {
+    public:
+        explicit VulkanMemoryBackend(const vk::raii::Device& device_) : device(device_) {}
+
+        std::optional<MemoryBlockHandle> allocateBlock(const uint32_t memoryTypeIndex, const vk::DeviceSize size, const bool map) override {
+            try {
+                vk::raii::DeviceMemory memory(device, vk::MemoryAllocateInfo{size, memoryTypeIndex});
+                MemoryBlockHandle block{};
+                if (map) block.mapped = memory.mapMemory(0, VK_WHOLE_SIZE);
+                block.memory = memory.release();
+                return block;
+            } catch (const vk::OutOfDeviceMemoryError&) {
+                return std::nullopt;
+            } catch (const vk::OutOfHostMemoryError&) {
+                return std::nullopt;
+            }
+        }
+
+        void freeBlock(const MemoryBlockHandle& block) override {
+            vk::raii::DeviceMemory memory(device, block.memory);
+            if (block.mapped) memory.unmapMemory();
+        }
+
+    private:
+        const vk::raii::Device&     device;
+    };
+
+    // Buffers and images come from separate blocks, bufferImageGranularity never applies.
+    enum class ResourceKind : uint8_t {
+        eBuffer,
+        eImage
+    };
+
+    struct MemoryStats {
+        uint32_t            blockCount{0};          // device allocations owned by the pools
+        uint32_t            dedicatedCount{0};      // device allocations of one resource each
+        uint32_t            allocationCount{0};
+        vk::DeviceSize      blockBytes{0};
+        vk::DeviceSize      usedBytes{0};           // in blocks
+        vk::DeviceSize      dedicatedBytes{0};
+        uint32_t            freeRegionCount{0};
+        vk::DeviceSize      largestFreeRegion{0};
+
+        // 0 when the free space of the blocks is one region, towards 1 the more it is scattered.
+        [[nodiscard]] double fragmentation() const noexcept {
+            const vk::DeviceSize freeBytes = blockBytes - usedBytes;
+            return freeBytes == 0 ? 0.0 : 1.0 - static_cast<double>(largestFreeRegion) / static_cast<double>(freeBytes);
+        }
+    };
+
+    class DeviceAllocator;
+
+    // Owning handle of a sub-allocation, given back to its allocator when destroyed.
+    class MemoryAllocation {
+    public:
+        MemoryAllocation() = default;
+        ~MemoryAllocation() { reset(); }
+
+        MemoryAllocation(const MemoryAllocation&) = delete;
+        MemoryAllocation& operator=(const MemoryAllocation&) = delete;
+
+        MemoryAllocation(MemoryAllocation&& other) noexcept { *this = std::move(other); }
+
+        MemoryAllocation& operator=(MemoryAllocation&& other) noexcept {
+            if (this != &other) {
+                reset();
+                allocator = std::exchange(other.allocator, nullptr);
+                memoryHandle = other.memoryHandle;
+                allocationOffset = other.allocationOffset;
+                allocationSize = other.allocationSize;
+                mappedBlock = other.mappedBlock;
+                pool = other.pool;
+                block = other.block;
+                node = other.node;
+            }
+            return *this;
+        }
+
+        void reset();
+
+        explicit operator bool() const noexcept { return allocator != nullptr; }
+
+        [[nodiscard]] vk::DeviceMemory memory() const noexcept { return memoryHandle; }
+        [[nodiscard]] vk::DeviceSize offset() const noexcept { return allocationOffset; }
+        [[nodiscard]] vk::DeviceSize size() const noexcept { return allocationSize; }
+
+        // Persistently mapped, null unless the memory type is host-visible.
+        [[nodiscard]] void* mapped() const noexcept {
+            return mappedBlock ? static_cast<std::byte*>(mappedBlock) + allocationOffset : nullptr;
+        }
+
+    private:
+        friend class DeviceAllocator;
+
+        DeviceAllocator*    allocator{nullptr};
+        vk::DeviceMemory    memoryHandle{};
+        vk::DeviceSize      allocationOffset{0};
+        vk::DeviceSize      allocationSize{0};
+        void*               mappedBlock{nullptr};
+        uint32_t            pool{INVALID_INDEX};
+        uint32_t            block{INVALID_INDEX};
+        uint32_t            node{INVALID_INDEX};     // INVALID_INDEX for a dedicated allocation
+    };
+
+    // Sub-allocates buffers and images from large blocks, one TLSF per block and one pool of
+    // blocks per memory type and resource kind. Resources larger than half a block get a
+    // dedicated allocation. One empty block per pool is kept around for reuse.
+    class DeviceAllocator {
+    public:
+        DeviceAllocator(std::unique_ptr<MemoryBackend> backend_, const vk::PhysicalDeviceMemoryProperties& properties_,
+            const vk::DeviceSize preferredBlockSize = DEFAULT_BLOCK_SIZE)
+            : backend(std::move(backend_)), properties(properties_) {
+            for (uint32_t type = 0; type < properties.memoryTypeCount; ++type) {
+                const vk::DeviceSize heapSize = properties.memoryHeaps[properties.memoryTypes[type].heapIndex].size;
+                const vk::DeviceSize blockSize = heapSize <= SMALL_HEAP_LIMIT ? std::min(preferredBlockSize, heapSize / 8) : preferredBlockSize;
+                for (const ResourceKind kind : {ResourceKind::eBuffer, ResourceKind::eImage}) {
+                    Pool& target = pools[poolIndex(type, kind)];
+                    target.memoryType = type;
+                    target.blockSize = blockSize;
+                }
+            }
+        }
+
+        ~DeviceAllocator() {
+            for (Pool& target : pools) {
+                for (std::optional<Block>& entry : target.blocks) {
+                    if (entry) backend->freeBlock(entry->handle);
+                }
+            }
+        }
+
+        DeviceAllocator(const DeviceAllocator&) = delete;
+        DeviceAllocator& operator=(const DeviceAllocator&) = delete;
+
+        [[nodiscard]] uint32_t findMemoryType(uint32_t typeBits, const vk::MemoryPropertyFlags required) const noexcept {
+            for (uint32_t type = 0; type < properties.memoryTypeCount; ++type, typeBits >>= 1) {
+                if ((typeBits & 1) && (properties.memoryTypes[type].propertyFlags & required) == required) return type;
+            }
+            return INVALID_INDEX;
+        }
+
+        // Empty when no memory type fits or the device is out of memory.
+        [[nodiscard]] MemoryAllocation allocate(const vk::MemoryRequirements& requirements, const vk::MemoryPropertyFlags required, const ResourceKind kind) {
+            MemoryAllocation allocation{};
+            const uint32_t type = findMemoryType(requirements.memoryTypeBits, required);
+            if (type == INVALID_INDEX) return allocation;
+
+            const bool map = static_cast<bool>(properties.memoryTypes[type].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible);
+            const uint32_t index = poolIndex(type, kind);
+            Pool& target = pools[index];
+
+            std::lock_guard lock(mutex);
+            if (requirements.size > target.blockSize / 2) {
+                const std::optional<MemoryBlockHandle> dedicated = backend->allocateBlock(type, requirements.size, map);
+                if (!dedicated) return allocation;
+                ++dedicatedCount;
+                dedicatedBytes += requirements.size;
+                fill(allocation, *dedicated, index, INVALID_INDEX, INVALID_INDEX, 0, requirements.size);
+                return allocation;
+            }
+
+            for (uint32_t blockIndex = 0; blockIndex < target.blocks.size(); ++blockIndex) {
+                std::optional<Block>& entry = target.blocks[blockIndex];
+                if (!entry) continue;
+                if (const std::optional<TlsfAllocation> range = entry->tlsf.allocate(requirements.size, requirements.alignment)) {
+                    fill(allocation, entry->handle, index, blockIndex, range->node, range->offset, requirements.size);
+                    return allocation;
+                }
+            }
+
+            const std::optional<MemoryBlockHandle> handle = backend->allocateBlock(type, target.blockSize, map);
+            if (!handle) return allocation;
+
+            auto slot = std::ranges::find_if(target.blocks, [](const std::optional<Block>& entry) { return !entry.has_value(); });
+            if (slot == target.blocks.end()) slot = target.blocks.insert(target.blocks.end(), std::nullopt);
+            slot->emplace(Block{*handle, TlsfAllocator(target.blockSize)});
+
+            const auto blockIndex = static_cast<uint32_t>(slot - target.blocks.begin());
+            const TlsfAllocation range = *(*slot)->tlsf.allocate(requirements.size, requirements.alignment);
+            fill(allocation, *handle, index, blockIndex, range.node, range.offset, requirements.size);
+            return allocation;
+        }
+
+        [[nodiscard]] MemoryStats stats() const {
+            std::lock_guard lock(mutex);
+            MemoryStats result{};
+            result.dedicatedCount = dedicatedCount;
+            result.dedicatedBytes = dedicatedBytes;
+            result.allocationCount = dedicatedCount;
+            for (const Pool& target : pools) {
+                for (const std::optional<Block>& entry : target.blocks) {
+                    if (!entry) continue;
+                    ++result.blockCount;
+                    result.blockBytes += entry->tlsf.size();
+                    result.usedBytes += entry->tlsf.used();
+                    result.allocationCount += entry->tlsf.allocations();
+                    result.freeRegionCount += entry->tlsf.freeRegions();
+                    result.largestFreeRegion = std::max(result.largestFreeRegion, entry->tlsf.largestFreeRegion());
+                }
+            }
+            return result;
+        }
+
+    private:
+        friend class MemoryAllocation;
+
+        struct Block {
+            MemoryBlockHandle   handle{};
+            TlsfAllocator       tlsf{};
+        };
+
+        struct Pool {
+            uint32_t                            memoryType{0};
+            vk::DeviceSize                      blockSize{DEFAULT_BLOCK_SIZE};
+            std::vector<std::optional<Block>>   blocks{};   // slots are reused, indices stay stable
+        };
+
+        static constexpr uint32_t poolIndex(const uint32_t type, const ResourceKind kind) noexcept {
+            return type * 2 + static_cast<uint32_t>(kind);
+        }
+
+        void fill(MemoryAllocation& allocation, const MemoryBlockHandle& handle, const uint32_t pool, const uint32_t block,
+            const uint32_t node, const vk::DeviceSize offset, const vk::DeviceSize size) noexcept {
+            allocation.allocator = this;
+            allocation.memoryHandle = handle.memory;
+            allocation.mappedBlock = handle.mapped;
+            allocation.pool = pool;
+            allocation.block = block;
+            allocation.node = node;
+            allocation.allocationOffset = offset;
+            allocation.allocationSize = size;
+        }
+
+        void free(const MemoryAllocation& allocation) {
+            std::lock_guard lock(mutex);
+            if (allocation.node == INVALID_INDEX) {
+                backend->freeBlock(MemoryBlockHandle{allocation.memoryHandle, allocation.mappedBlock});
+                --dedicatedCount;
+                dedicatedBytes -= allocation.allocationSize;
+                return;
+            }
+
+            Pool& target = pools[allocation.pool];
+            std::optional<Block>& entry = target.blocks[allocation.block];
+            entry->tlsf.free(allocation.node);
+            if (!entry->tlsf.empty()) return;
+
+            const bool spare = std::ranges::any_of(target.blocks, [&entry](const std::optional<Block>& other) {
+                return other && &other != &entry && other->tlsf.empty();
+            });
+            if (spare) {
+                backend->freeBlock(entry->handle);
+                entry.reset();
+            }
+        }
+
+        std::unique_ptr<MemoryBackend>                          backend;
+        vk::PhysicalDeviceMemoryProperties                      properties{};
+        std::array<Pool, VK_MAX_MEMORY_TYPES * 2>               pools{};
+        uint32_t                                                dedicatedCount{0};
+        vk::DeviceSize                                          dedicatedBytes{0};
+        mutable std::mutex                                      mutex{};
+    };
+
+    inline void MemoryAllocation::reset() {
+        if (allocator) allocator->free(*this);
+        allocator = nullptr;
+        mappedBlock = nullptr;
+        memoryHandle = vk::DeviceMemory{};
+    }
+}
@@ -0,0 +1,397 @@
+module;
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+export module ufox_metadata_store;
+
+import ufox_lib;
+
+export namespace ufox {
+    // Read-only mapping of a whole file. Empty files are not mapped, data() is null for them.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::filesystem::path& path) {
+            close();
+#ifdef _WIN32
+            file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return false;
+
+            LARGE_INTEGER fileSize{};
+            if (!GetFileSizeEx(file, &fileSize)) {
+                close();
+                return false;
+            }
+            mappedSize = static_cast<size_t>(fileSize.QuadPart);
+            if (mappedSize == 0) return true;
+
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) {
+                close();
+                return false;
+            }
+            mapped = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+            descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0) return false;
+
+            struct stat status{};
+            if (fstat(descriptor, &status) != 0) {
+                close();
+                return false;
+            }
+            mappedSize = static_cast<size_t>(status.st_size);
+            if (mappedSize == 0) return true;
+
+            void* address = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            mapped = address == MAP_FAILED ? nullptr : static_cast<const std::byte*>(address);
+#endif
+            if (!mapped) {
+                close();
+                return false;
+            }
+            return true;
+        }
+
+        void close() noexcept {
+#ifdef _WIN32
+            if (mapped) UnmapViewOfFile(mapped);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+            mapping = nullptr;
+            file = INVALID_HANDLE_VALUE;
+#else
+            if (mapped) munmap(const_cast<std::byte*>(mapped), mappedSize);
+            if (descriptor >= 0) ::close(descriptor);
+            descriptor = -1;
+#endif
+            mapped = nullptr;
+            mappedSize = 0;
+        }
+
+        [[nodiscard]] const std::byte* data() const noexcept { return mapped; }
+        [[nodiscard]] size_t size() const noexcept { return mapped ? mappedSize : 0; }
+
+    private:
+#ifdef _WIN32
+        HANDLE              file{INVALID_HANDLE_VALUE};
+        HANDLE              mapping{nullptr};
+#else
+        int                 descriptor{-1};
+#endif
+        const std::byte*    mapped{nullptr};
+        size_t              mappedSize{0};
+    };
+
+    constexpr char METADATA_STORE_MAGIC[8] = {'U', 'F', 'O', 'X', 'M', 'E', 'T', 'A'};
+    constexpr uint32_t METADATA_STORE_VERSION = 2;
+    constexpr uint32_t METADATA_RECORD_ERASED = 0xFFFFFFFFu;   // type of a tombstone record
+    constexpr size_t METADATA_RECORD_ALIGNMENT = 8;
+
+    struct MetadataStoreHeader {
+        char        magic[8]{};
+        uint32_t    version{0};
+        uint32_t    reserved{0};
+    };
+
+    // Every record starts 8-byte aligned, its payload is padded up to the next record. The
+    // checksum covers the other header fields and the payload.
+    struct MetadataRecordHeader {
+        uint64_t    id{0};
+        uint32_t    type{0};
+        uint32_t    payloadSize{0};
+        uint64_t    checksum{0};
+    };
+
+    static_assert(sizeof(MetadataStoreHeader) == 16 && sizeof(MetadataRecordHeader) == 24);
+
+    struct MetadataView {
+        uint64_t                        id{0};
+        uint32_t                        type{0};
+        std::span<const std::byte>      payload{};
+    };
+
+    constexpr size_t AlignMetadataRecord(const size_t size) noexcept {
+        return (size + METADATA_RECORD_ALIGNMENT - 1) & ~(METADATA_RECORD_ALIGNMENT - 1);
+    }
+
+    inline uint64_t GetMetadataRecordChecksum(const MetadataRecordHeader& header, const std::span<const std::byte> payload) noexcept {
+        const uint64_t seed = utilities::HashMix64(header.id, static_cast<uint64_t>(header.type) << 32 | header.payloadSize);
+        return utilities::HashString(std::string_view(reinterpret_cast<const char*>(payload.data()), payload.size()), seed);
+    }
+
+    // Single file, append-only store of binary metadata records keyed by resource ID. The file is
+    // memory-mapped and indexed once on open, find() hands out views into the mapping. An update
+    // appends a newer record for the same ID and the newest one wins, erase appends a tombstone;
+    // compact() rewrites the live records only. Replay stops at the first record whose checksum
+    // does not match, everything from there on is treated as a torn tail.
+    //
+    // Puts and erases are staged in memory until flush(). Views stay valid until the next put,
+    // erase, flush or compact. find() is safe from many threads while none of those run.
+    class MetadataStore {
+    public:
+        MetadataStore() = default;
+        ~MetadataStore() = default;
+
+        MetadataStore(const MetadataStore&) = delete;
+        MetadataStore& operator=(const MetadataStore&) = delete;
+
+        // Opens or creates the store. A store of another version, or one that is not a store, is
+        // discarded and recreated empty.
+        bool open(const std::filesystem::path& path_) {
+            path = path_;
+            index.clear();
+            pending.clear();
+            deadBytes = 0;
+
+            std::error_code error{};
+            if (!std::filesystem::exists(path, error) && !writeEmptyStore()) return false;
+            if (!mapFile()) return false;
+
+            if (!hasValidHeader()) {
+                debug::log<debug::LogLevel::eWarning, debug::LogCategory::eResource>("Recreating metadata store {}", path.string());
+                file.close();
+                if (!writeEmptyStore() || !mapFile()) return false;
+            }
+
+            indexRecords(sizeof(MetadataStoreHeader), file.size());
+            return true;
+        }
+
+        [[nodiscard]] std::optional<MetadataView> find(const uint64_t id) const {
+            const auto it = index.find(id);
+            if (it == index.end()) return std::nullopt;
+            return viewAt(it->second);
+        }
+
+        void put(const uint64_t id, const uint32_t type, const std::span<const std::byte> payload) {
+            if (const auto it = index.find(id); it != index.end()) deadBytes += recordSizeAt(it->second);
+            index.insert_or_assign(id, logicalEnd());
+            appendPending(MetadataRecordHeader{id, type, static_cast<uint32_t>(payload.size())}, payload);
+        }
+
+        bool erase(const uint64_t id) {
+            const auto it = index.find(id);
+            if (it == index.end()) return false;
+
+            deadBytes += recordSizeAt(it->second) + sizeof(MetadataRecordHeader);
+            index.erase(it);
+            appendPending(MetadataRecordHeader{id, METADATA_RECORD_ERASED, 0}, {});
+            return true;
+        }
+
+        // Appends the staged records to the file and remaps it. Record offsets are logical file
+        // offsets already, so the index stays as it is.
+        bool flush() {
+            if (pending.empty()) return true;
+
+            const size_t validEnd = truncatedEnd;
+            file.close();
+            {
+                std::fstream out(path, std::ios::in | std::ios::out | std::ios::binary);
+                if (!out.is_open()) {
+                    debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to append to metadata store {}", path.string());
+                    mapFile();
+                    return false;
+                }
+                out.seekp(static_cast<std::streamoff>(validEnd));
+                out.write(reinterpret_cast<const char*>(pending.data()), static_cast<std::streamsize>(pending.size()));
+                if (!out) {
+                    out.close();
+                    mapFile();
+                    return false;
+                }
+            }
+
+            // a torn tail left by an interrupted flush was overwritten, drop what is left of it
+            std::error_code error{};
+            std::filesystem::resize_file(path, validEnd + pending.size(), error);
+            truncatedEnd = validEnd + pending.size();
+            pending.clear();
+            return mapFile();
+        }
+
+        // Rewrites the live records into a new file that replaces the store.
+        bool compact() {
+            std::vector<std::byte> live{};
+            live.reserve(liveBytes() + sizeof(MetadataStoreHeader));
+            appendBytes(live, makeHeader());
+
+            std::unordered_map<uint64_t, size_t> compactedIndex{};
+            compactedIndex.reserve(index.size());
+            for (const auto& [id, offset] : index) {
+                const MetadataView view = viewAt(offset);
+                compactedIndex.emplace(id, live.size());
+                appendRecord(live, MetadataRecordHeader{id, view.type, static_cast<uint32_t>(view.payload.size())}, view.payload);
+            }
+
+            std::filesystem::path temporary = path;
+            temporary += ".tmp";
+            if (!writeFile(temporary, live)) return false;
+
+            file.close();
+            std::error_code error{};
+            std::filesystem::rename(temporary, path, error);
+            if (error) {
+                debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to replace metadata store {}: {}", path.string(), error.message());
+                std::filesystem::remove(temporary, error);
+                mapFile();
+                return false;
+            }
+
+            index = std::move(compactedIndex);
+            truncatedEnd = live.size();
+            pending.clear();
+            deadBytes = 0;
+            return mapFile();
+        }
+
+        // Visits the newest record of every ID, in no particular order.
+        template<typename Visitor>
+        void forEach(Visitor&& visitor) const {
+            for (const auto& [id, offset] : index) visitor(viewAt(offset));
+        }
+
+        [[nodiscard]] size_t size() const noexcept { return index.size(); }
+        [[nodiscard]] size_t deadSize() const noexcept { return deadBytes; }
+        [[nodiscard]] size_t liveBytes() const noexcept { return logicalEnd() - sizeof(MetadataStoreHeader) - deadBytes; }
+
+    private:
+        static MetadataStoreHeader makeHeader() noexcept {
+            MetadataStoreHeader header{};
+            std::memcpy(header.magic, METADATA_STORE_MAGIC, sizeof(header.magic));
+            header.version = METADATA_STORE_VERSION;
+            return header;
+        }
+
+        template<typename T>
+        static void appendBytes(std::vector<std::byte>& bytes, const T& value) {
+            const auto* begin = reinterpret_cast<const std::byte*>(&value);
+            bytes.insert(bytes.end(), begin, begin + sizeof(T));
+        }
+
+        static void appendRecord(std::vector<std::byte>& bytes, MetadataRecordHeader header, const std::span<const std::byte> payload) {
+            header.checksum = GetMetadataRecordChecksum(header, payload);
+            appendBytes(bytes, header);
+            bytes.insert(bytes.end(), payload.begin(), payload.end());
+            bytes.resize(AlignMetadataRecord(bytes.size()), std::byte{0});
+        }
+
+        static bool writeFile(const std::filesystem::path& target, const std::vector<std::byte>& bytes) {
+            std::ofstream out(target, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to write metadata store {}", target.string());
+                return false;
+            }
+            out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            return static_cast<bool>(out);
+        }
+
+        bool writeEmptyStore() const {
+            std::vector<std::byte> bytes{};
+            appendBytes(bytes, makeHeader());
+            return writeFile(path, bytes);
+        }
+
+        bool mapFile() {
+            if (file.open(path)) return true;
+            debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to map metadata store {}", path.string());
+            return false;
+        }
+
+        [[nodiscard]] bool hasValidHeader() const {
+            if (file.size() < sizeof(MetadataStoreHeader)) return false;
+            MetadataStoreHeader header{};
+            std::memcpy(&header, file.data(), sizeof(header));
+            return std::memcmp(header.magic, METADATA_STORE_MAGIC, sizeof(header.magic)) == 0 && header.version == METADATA_STORE_VERSION;
+        }
+
+        // A record running past the end, or one failing its checksum, is the torn tail of an
+        // interrupted flush, the next flush overwrites it.
+        void indexRecords(size_t offset, const size_t end) {
+            truncatedEnd = end;
+            while (offset + sizeof(MetadataRecordHeader) <= end) {
+                MetadataRecordHeader header{};
+                std::memcpy(&header, file.data() + offset, sizeof(header));
+                const bool erased = header.type == METADATA_RECORD_ERASED;
+                const size_t recordSize = AlignMetadataRecord(sizeof(MetadataRecordHeader) + (erased ? 0 : header.payloadSize));
+                if (offset + recordSize > end) break;
+
+                const std::span payload(file.data() + offset + sizeof(MetadataRecordHeader), erased ? 0 : header.payloadSize);
+                if (header.checksum != GetMetadataRecordChecksum(header, payload)) break;
+
+                if (const auto it = index.find(header.id); it != index.end()) deadBytes += recordSizeAt(it->second);
+                if (erased) {
+                    index.erase(header.id);
+                    deadBytes += recordSize;
+                } else {
+                    index.insert_or_assign(header.id, offset);
+                }
+                offset += recordSize;
+            }
+
+            if (offset != end) {
+                debug::log<debug::LogLevel::eWarning, debug::LogCategory::eResource>("Ignoring {} torn or corrupt bytes at the end of metadata store {}", end - offset, path.string());
+                truncatedEnd = offset;
+            }
+        }
+
+        [[nodiscard]] size_t logicalEnd() const noexcept { return truncatedEnd + pending.size(); }
+
+        [[nodiscard]] const std::byte* recordAt(const size_t offset) const noexcept {
+            return offset < truncatedEnd ? file.data() + offset : pending.data() + (offset - truncatedEnd);
+        }
+
+        [[nodiscard]] MetadataView viewAt(const size_t offset) const noexcept {
+            const std::byte* record = recordAt(offset);
+            MetadataRecordHeader header{};
+            std::memcpy(&header, record, sizeof(header));
+            return MetadataView{header.id, header.type, std::span(record + sizeof(MetadataRecordHeader), header.payloadSize)};
+        }
+
+        [[nodiscard]] size_t recordSizeAt(const size_t offset) const noexcept {
+            MetadataRecordHeader header{};
+            std::memcpy(&header, recordAt(offset), sizeof(header));
+            return AlignMetadataRecord(sizeof(MetadataRecordHeader) + header.payloadSize);
+        }
+
+        void appendPending(const MetadataRecordHeader& header, const std::span<const std::byte> payload) {
+            appendRecord(pending, header, payload);
+        }
+
+        std::filesystem::path                       path{};
+        MappedFile                                  file{};
+        size_t                                      truncatedEnd{0};    // end of the valid records of the mapping
+        std::vector<std::byte>                      pending{};          // staged records, logically at truncatedEnd
+        std::unordered_map<uint64_t, size_t>        index{};            // ID -> logical offset of its newest record
+        size_t                                      deadBytes{0};       // superseded and erased records
+    };
+}
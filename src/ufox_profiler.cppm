@@ -0,0 +1,327 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef UFOX_PROFILER
+#define UFOX_PROFILER 0
+#endif
+
+export module ufox_profiler;
+
+export namespace ufox::profiler {
+    // Compiled out unless UFOX_PROFILER is set: zones and counters become empty inline calls.
+    constexpr bool PROFILER_ENABLED = UFOX_PROFILER != 0;
+
+    constexpr size_t ZONE_BUFFER_CAPACITY = 1 << 14;    // per thread, zones closed while it is full are dropped
+    constexpr size_t STATS_WINDOW = 256;                // frames kept by the rolling stats
+
+    enum class Counter : uint8_t {
+        ePanelsMeasured,
+        ePanelsArranged,
+        eArrangeCacheHits,
+        eCallbacksInvoked,
+        eHeapAllocations,
+        eCount
+    };
+
+    constexpr size_t COUNTER_COUNT = static_cast<size_t>(Counter::eCount);
+
+    constexpr std::string_view ToString(const Counter counter) noexcept {
+        switch (counter) {
+            case Counter::ePanelsMeasured:   return "panels_measured";
+            case Counter::ePanelsArranged:   return "panels_arranged";
+            case Counter::eArrangeCacheHits: return "arrange_cache_hits";
+            case Counter::eCallbacksInvoked: return "callbacks_invoked";
+            default:                         return "heap_allocations";
+        }
+    }
+
+    // Bumped by the counting operator new of the executable (ufox_profiler_alloc.cpp). Kept
+    // outside the Profiler so counting never has to construct it.
+    constinit inline std::atomic<uint64_t> heapAllocationCount{0};
+
+    inline void RecordAllocation() noexcept {
+        heapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    struct ZoneEvent {
+        const char*     name{nullptr};      // string literal, zones with the same text are merged
+        int64_t         begin{0};           // ns since the profiler started
+        int64_t         end{0};
+    };
+
+    // Window of the last STATS_WINDOW frame samples.
+    class RollingStats {
+    public:
+        void push(const double value) noexcept {
+            samples[next] = value;
+            next = (next + 1) % STATS_WINDOW;
+            count = std::min(count + 1, STATS_WINDOW);
+            last = value;
+        }
+
+        [[nodiscard]] size_t size() const noexcept { return count; }
+        [[nodiscard]] double latest() const noexcept { return last; }
+
+        [[nodiscard]] double min() const noexcept {
+            return count == 0 ? 0.0 : *std::min_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(count));
+        }
+
+        [[nodiscard]] double avg() const noexcept {
+            double total = 0.0;
+            for (size_t i = 0; i < count; ++i) total += samples[i];
+            return count == 0 ? 0.0 : total / static_cast<double>(count);
+        }
+
+        [[nodiscard]] double p99() const noexcept {
+            if (count == 0) return 0.0;
+            std::array<double, STATS_WINDOW> sorted = samples;
+            const size_t rank = (count * 99) / 100;
+            std::nth_element(sorted.begin(), sorted.begin() + static_cast<std::ptrdiff_t>(rank), sorted.begin() + static_cast<std::ptrdiff_t>(count));
+            return sorted[rank];
+        }
+
+    private:
+        std::array<double, STATS_WINDOW>    samples{};
+        size_t                              next{0};
+        size_t                              count{0};
+        double                              last{0.0};
+    };
+
+    struct ZoneStats {
+        std::string_view    name{};
+        RollingStats        milliseconds{};     // summed over the frame
+        RollingStats        calls{};
+        int64_t             frameNanoseconds{0};
+        uint32_t            frameCalls{0};
+    };
+
+    // Closed zones of one thread. Single writer (the owning thread), single reader (the thread
+    // calling EndFrame), so neither side takes a lock.
+    struct ThreadZoneBuffer {
+        uint32_t                        threadId{0};
+        std::unique_ptr<ZoneEvent[]>    events{std::make_unique<ZoneEvent[]>(ZONE_BUFFER_CAPACITY)};
+        std::atomic<size_t>             head{0};
+        std::atomic<size_t>             tail{0};
+        std::atomic<uint64_t>           dropped{0};
+
+        void push(const ZoneEvent& event) noexcept {
+            const size_t position = head.load(std::memory_order_relaxed);
+            if (position - tail.load(std::memory_order_acquire) >= ZONE_BUFFER_CAPACITY) {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            events[position % ZONE_BUFFER_CAPACITY] = event;
+            head.store(position + 1, std::memory_order_release);
+        }
+    };
+
+    class Profiler {
+    public:
+        Profiler() : epoch(std::chrono::steady_clock::now()) {}
+        ~Profiler() = default;
+
+        Profiler(const Profiler&) = delete;
+        Profiler& operator=(const Profiler&) = delete;
+
+        static Profiler& Instance() {
+            static Profiler profiler{};
+            return profiler;
+        }
+
+        [[nodiscard]] int64_t now() const noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+        }
+
+        ThreadZoneBuffer& threadBuffer() {
+            static thread_local ThreadZoneBuffer* buffer = nullptr;
+            if (!buffer) {
+                std::lock_guard lock(registryMutex);
+                buffers.push_back(std::make_unique<ThreadZoneBuffer>());
+                buffer = buffers.back().get();
+                buffer->threadId = static_cast<uint32_t>(buffers.size());
+            }
+            return *buffer;
+        }
+
+        void addCounter(const Counter counter, const uint64_t value) noexcept {
+            counters[static_cast<size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+        }
+
+        // Captures every zone and counter of the next frameCount frames, written as a Chrome
+        // trace (chrome://tracing, ui.perfetto.dev) to path once the last one ends.
+        void beginCapture(const uint32_t frameCount, std::string path) {
+            captureFramesLeft = frameCount;
+            capturePath = std::move(path);
+            traceZones.clear();
+            traceCounters.clear();
+        }
+
+        [[nodiscard]] bool isCapturing() const noexcept { return captureFramesLeft > 0; }
+
+        // Folds the zones closed since the last call into the per-frame stats. Call once per
+        // frame from the frame thread.
+        void endFrame() {
+            const int64_t frameEnd = now();
+            frameMilliseconds.push(static_cast<double>(frameEnd - frameBegin) * 1e-6);
+
+            {
+                std::lock_guard lock(registryMutex);
+                for (const auto& buffer : buffers) drainBuffer(*buffer);
+            }
+
+            for (ZoneStats& zone : zones) {
+                zone.milliseconds.push(static_cast<double>(zone.frameNanoseconds) * 1e-6);
+                zone.calls.push(zone.frameCalls);
+                zone.frameNanoseconds = 0;
+                zone.frameCalls = 0;
+            }
+
+            const uint64_t allocations = heapAllocationCount.load(std::memory_order_relaxed);
+            addCounter(Counter::eHeapAllocations, allocations - lastAllocationCount);
+            lastAllocationCount = allocations;
+
+            for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+                const uint64_t value = counters[i].exchange(0, std::memory_order_relaxed);
+                counterStats[i].push(static_cast<double>(value));
+                if (isCapturing()) traceCounters.push_back(CounterSample{frameEnd, static_cast<Counter>(i), value});
+            }
+
+            if (isCapturing() && --captureFramesLeft == 0) writeChromeTrace(capturePath);
+            frameBegin = frameEnd;
+        }
+
+        [[nodiscard]] const RollingStats& frameStats() const noexcept { return frameMilliseconds; }
+        [[nodiscard]] const RollingStats& counterStat(const Counter counter) const noexcept { return counterStats[static_cast<size_t>(counter)]; }
+        [[nodiscard]] const std::vector<ZoneStats>& zoneStats() const noexcept { return zones; }
+
+        bool writeChromeTrace(const std::string& path) const {
+            std::ofstream out(path);
+            if (!out) return false;
+
+            out << R"({"displayTimeUnit": "ms", "traceEvents": [)" << '\n';
+            bool first = true;
+            const auto separator = [&out, &first] {
+                if (!first) out << ",\n";
+                first = false;
+            };
+
+            for (const TraceZone& zone : traceZones) {
+                separator();
+                out << std::format(R"({{"name": "{}", "cat": "ufox", "ph": "X", "ts": {:.3f}, "dur": {:.3f}, "pid": 1, "tid": {}}})",
+                    zone.event.name, static_cast<double>(zone.event.begin) * 1e-3,
+                    static_cast<double>(zone.event.end - zone.event.begin) * 1e-3, zone.threadId);
+            }
+
+            for (const CounterSample& sample : traceCounters) {
+                separator();
+                out << std::format(R"({{"name": "{}", "ph": "C", "ts": {:.3f}, "pid": 1, "args": {{"value": {}}}}})",
+                    ToString(sample.counter), static_cast<double>(sample.timestamp) * 1e-3, sample.value);
+            }
+
+            out << "\n]}\n";
+            return static_cast<bool>(out);
+        }
+
+    private:
+        struct TraceZone {
+            ZoneEvent   event{};
+            uint32_t    threadId{0};
+        };
+
+        struct CounterSample {
+            int64_t     timestamp{0};
+            Counter     counter{Counter::ePanelsMeasured};
+            uint64_t    value{0};
+        };
+
+        // Keyed by the text: equal literals in different translation units need not share an address.
+        ZoneStats& findZone(const std::string_view name) {
+            for (ZoneStats& zone : zones) {
+                if (zone.name == name) return zone;
+            }
+            zones.push_back(ZoneStats{name});
+            return zones.back();
+        }
+
+        void drainBuffer(ThreadZoneBuffer& buffer) {
+            const size_t head = buffer.head.load(std::memory_order_acquire);
+            size_t tail = buffer.tail.load(std::memory_order_relaxed);
+
+            for (; tail != head; ++tail) {
+                const ZoneEvent& event = buffer.events[tail % ZONE_BUFFER_CAPACITY];
+                ZoneStats& zone = findZone(event.name);
+                zone.frameNanoseconds += event.end - event.begin;
+                zone.frameCalls++;
+                if (isCapturing()) traceZones.push_back(TraceZone{event, buffer.threadId});
+            }
+
+            buffer.tail.store(tail, std::memory_order_release);
+        }
+
+        std::chrono::steady_clock::time_point               epoch;
+        int64_t                                             frameBegin{0};
+        RollingStats                                        frameMilliseconds{};
+        std::vector<ZoneStats>                              zones{};
+
+        std::array<std::atomic<uint64_t>, COUNTER_COUNT>    counters{};
+        std::array<RollingStats, COUNTER_COUNT>             counterStats{};
+        uint64_t                                            lastAllocationCount{0};
+
+        std::mutex                                          registryMutex{};
+        std::vector<std::unique_ptr<ThreadZoneBuffer>>      buffers{};
+
+        uint32_t                                            captureFramesLeft{0};
+        std::string                                         capturePath{};
+        std::vector<TraceZone>                              traceZones{};
+        std::vector<CounterSample>                          traceCounters{};
+    };
+
+    // RAII zone: records [construction, destruction) under a string literal name.
+    class ScopedZone {
+    public:
+        explicit ScopedZone(const char* name) noexcept {
+            if constexpr (PROFILER_ENABLED) {
+                zone.name = name;
+                zone.begin = Profiler::Instance().now();
+            }
+        }
+
+        ~ScopedZone() {
+            if constexpr (PROFILER_ENABLED) {
+                Profiler& profiler = Profiler::Instance();
+                zone.end = profiler.now();
+                profiler.threadBuffer().push(zone);
+            }
+        }
+
+        ScopedZone(const ScopedZone&) = delete;
+        ScopedZone& operator=(const ScopedZone&) = delete;
+
+    private:
+        ZoneEvent   zone{};     // never touched when compiled out, the optimizer drops it
+    };
+
+    inline void AddCounter(const Counter counter, const uint64_t value = 1) noexcept {
+        if constexpr (PROFILER_ENABLED) Profiler::Instance().addCounter(counter, value);
+    }
+
+    inline void EndFrame() {
+        if constexpr (PROFILER_ENABLED) Profiler::Instance().endFrame();
+    }
+
+    inline void BeginCapture(const uint32_t frameCount, std::string path) {
+        if constexpr (PROFILER_ENABLED) Profiler::Instance().beginCapture(frameCount, std::move(path));
+    }
+}
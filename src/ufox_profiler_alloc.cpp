@@ -0,0 +1,16 @@
+// Counting global operator new for profiled builds, feeds profiler::Counter::eHeapAllocations.
+// Only linked when UFOX_ENABLE_PROFILER is on.
+
+#include <cstdlib>
+#include <new>
+
+import ufox_profiler;
+
+void* operator new(const std::size_t size) {
+    ufox::profiler::RecordAllocation();
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
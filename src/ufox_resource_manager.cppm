@@ -1,8 +1,20 @@
 module;
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
+#include <format>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <unordered_map>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <memory>
 #include <vector>
 #include <stdexcept>
@@ -13,8 +25,10 @@ module;
 
 export module ufox_resource_manager;
 
-import ufox_lib;  // For GPUResources, Buffer, GenerateUniqueID
+import ufox_lib;  // For GPUResources, Buffer, HashString
 import ufox_graphic_device;  // For utility functions like CopyBufferToImage, SetImageLayout
+import ufox_metadata_store;
+import ufox_texture_processing;
 
 export namespace ufox {
 
@@ -29,18 +43,16 @@ export namespace ufox {
     struct Resource {
         virtual ~Resource() = default;
 
-        bool                isPrivate{false};
-        std::string         name;
-        size_t              id{0};
-        std::string         filePath;
-        ResourceType        type{ResourceType::eUnidentify};
+        bool                    isPrivate{false};
+        std::string             name;
+        uint64_t                id{0};          // HashString(filePath), stable across runs, stored in the metadata
+        utilities::NameHandle   handle{};       // interned filePath, compared at runtime
+        std::string             filePath;
+        ResourceType            type{ResourceType::eUnidentify};
 
         void generateID() {
-            std::vector<float> hashFields;
-            for (const char c : filePath) {
-                hashFields.push_back(c);
-            }
-            id = utilities::GenerateUniqueID(hashFields);
+            id = utilities::HashString(filePath);
+            handle = utilities::InternName(filePath, id);
         }
     };
 
@@ -68,6 +80,70 @@ export namespace ufox {
         vk::ImageViewType::e2D
     };
 
+    // Formats whose texels are sRGB encoded, their textures are filtered in linear space.
+    constexpr bool IsSrgbFormat(const vk::Format format) noexcept {
+        switch (format) {
+            case vk::Format::eR8Srgb:
+            case vk::Format::eR8G8Srgb:
+            case vk::Format::eR8G8B8Srgb:
+            case vk::Format::eB8G8R8Srgb:
+            case vk::Format::eR8G8B8A8Srgb:
+            case vk::Format::eB8G8R8A8Srgb:
+            case vk::Format::eA8B8G8R8SrgbPack32:
+            case vk::Format::eBc1RgbSrgbBlock:
+            case vk::Format::eBc1RgbaSrgbBlock:
+            case vk::Format::eBc2SrgbBlock:
+            case vk::Format::eBc3SrgbBlock:
+            case vk::Format::eBc7SrgbBlock:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    // What decides whether an asset changed since its last import. Size and write time are a
+    // stat away, the content hash is only computed when one of them moved.
+    struct AssetFingerprint {
+        uint64_t    size{0};
+        int64_t     writeTime{0};
+        uint64_t    contentHash{0};
+    };
+
+    // Metadata store payload of a texture, followed by pathLength bytes of its file path. Enums and
+    // flags are stored as their Vulkan values.
+    struct TextureMetadataRecord {
+        AssetFingerprint    fingerprint{};
+        uint32_t            format{0};
+        uint32_t            width{0};
+        uint32_t            height{0};
+        uint32_t            depth{0};
+        uint32_t            usage{0};
+        uint32_t            sampleCount{0};
+        uint32_t            properties{0};
+        uint32_t            imageType{0};
+        uint32_t            tiling{0};
+        uint32_t            shareMode{0};
+        uint32_t            mipLevels{0};
+        uint32_t            arrayLayers{0};
+        uint32_t            aspectMask{0};
+        uint32_t            baseMipLevel{0};
+        uint32_t            levelCount{0};
+        uint32_t            baseArrayLayer{0};
+        uint32_t            layerCount{0};
+        uint32_t            imageViewType{0};
+        uint32_t            isPrivate{0};
+        uint32_t            pathLength{0};
+    };
+
+    static_assert(std::is_trivially_copyable_v<TextureMetadataRecord>);
+
+    inline std::optional<TextureMetadataRecord> ReadTextureMetadataRecord(const std::span<const std::byte> payload) {
+        TextureMetadataRecord record{};
+        if (payload.size() < sizeof(record)) return std::nullopt;
+        std::memcpy(&record, payload.data(), sizeof(record));
+        if (payload.size() - sizeof(record) < record.pathLength) return std::nullopt;
+        return record;
+    }
 
     struct TextureImage : Resource {
         TextureImage() = default;
@@ -80,9 +156,6 @@ export namespace ufox {
             generateID();
 
             debug::log(debug::LogLevel::eInfo, "Creating TextureImage {} from file {}", name, filePath);
-
-            metadata = serializeMetadata();
-            saveMetadataToFile();
         }
         TextureImage(const std::string &filePath_,
             const vk::Extent3D extent_, const vk::Format format_,
@@ -115,49 +188,108 @@ export namespace ufox {
             configuration.arrayLayers = arrayLayers_;
             configuration.subresourceRange = subresourceRange_;
             configuration.imageViewType = viewType_;
-
-            metadata = serializeMetadata();
-            saveMetadataToFile();
         }
 
-        [[nodiscard]] vk::ImageCreateInfo GetImageCreateInfo() const {
+        [[nodiscard]] vk::ImageCreateInfo GetImageCreateInfo() const { return GetImageCreateInfo(configuration); }
+
+        // Create info of an image described by description instead of the configuration.
+        [[nodiscard]] static vk::ImageCreateInfo GetImageCreateInfo(const TextureImageConfiguration& description) {
             vk::ImageCreateInfo info{};
-            info.setImageType(configuration.type);
-            info.setFormat(configuration.format);
-            info.setExtent(configuration.extent);
-            info.setMipLevels(configuration.mipLevels);
-            info.setArrayLayers(configuration.arrayLayers);
-            info.setSamples(configuration.sampleCount);
-            info.setTiling(configuration.tiling);
-            info.setUsage(configuration.usage);
-            info.setSharingMode(configuration.shareMode);
+            info.setImageType(description.type);
+            info.setFormat(description.format);
+            info.setExtent(description.extent);
+            info.setMipLevels(description.mipLevels);
+            info.setArrayLayers(description.arrayLayers);
+            info.setSamples(description.sampleCount);
+            info.setTiling(description.tiling);
+            info.setUsage(description.usage);
+            info.setSharingMode(description.shareMode);
             return info;
         }
 
-        [[nodiscard]] vk::ImageViewCreateInfo GetImageViewCreateInfo() const {
+        [[nodiscard]] vk::ImageViewCreateInfo GetImageViewCreateInfo() const { return GetImageViewCreateInfo(configuration); }
+
+        [[nodiscard]] vk::ImageViewCreateInfo GetImageViewCreateInfo(const TextureImageConfiguration& description) const {
             vk::ImageViewCreateInfo info{};
             info.setImage(*data);
-            info.setViewType(configuration.imageViewType);
-            info.setFormat(configuration.format);
-            info.setSubresourceRange(configuration.subresourceRange);
+            info.setViewType(description.imageViewType);
+            info.setFormat(description.format);
+            info.setSubresourceRange(description.subresourceRange);
             return info;
         }
 
 
+        gpu::memory::MemoryAllocation               allocation{};
         std::optional<vk::raii::Image>              data{};
-        std::optional<vk::raii::DeviceMemory>       memory{};
         std::optional<vk::raii::ImageView>          view{};
         TextureImageConfiguration                   configuration{};
-        std::string                                 metadata{};
 
 
         void clear() {
             view.reset();
             data.reset();
-            memory.reset();
+            allocation.reset();
+        }
+
+        [[nodiscard]] std::vector<std::byte> encodeMetadata(const AssetFingerprint& fingerprint) const {
+            const TextureMetadataRecord record{
+                fingerprint,
+                static_cast<uint32_t>(configuration.format),
+                configuration.extent.width, configuration.extent.height, configuration.extent.depth,
+                static_cast<uint32_t>(configuration.usage),
+                static_cast<uint32_t>(configuration.sampleCount),
+                static_cast<uint32_t>(configuration.properties),
+                static_cast<uint32_t>(configuration.type),
+                static_cast<uint32_t>(configuration.tiling),
+                static_cast<uint32_t>(configuration.shareMode),
+                configuration.mipLevels, configuration.arrayLayers,
+                static_cast<uint32_t>(configuration.subresourceRange.aspectMask),
+                configuration.subresourceRange.baseMipLevel, configuration.subresourceRange.levelCount,
+                configuration.subresourceRange.baseArrayLayer, configuration.subresourceRange.layerCount,
+                static_cast<uint32_t>(configuration.imageViewType),
+                isPrivate ? 1u : 0u,
+                static_cast<uint32_t>(filePath.size())
+            };
+
+            std::vector<std::byte> payload(sizeof(record) + filePath.size());
+            std::memcpy(payload.data(), &record, sizeof(record));
+            std::memcpy(payload.data() + sizeof(record), filePath.data(), filePath.size());
+            return payload;
+        }
+
+        // Rebuilds a texture from an encodeMetadata() payload, nullptr when it is malformed.
+        [[nodiscard]] static std::unique_ptr<TextureImage> FromMetadata(const std::span<const std::byte> payload) {
+            const std::optional<TextureMetadataRecord> record = ReadTextureMetadataRecord(payload);
+            if (!record) return nullptr;
+
+            auto texture = std::make_unique<TextureImage>();
+            texture->type = ResourceType::eTexture;
+            texture->filePath.assign(reinterpret_cast<const char*>(payload.data() + sizeof(TextureMetadataRecord)), record->pathLength);
+            texture->name = std::filesystem::path(texture->filePath).stem().string();
+            texture->generateID();
+            texture->isPrivate = record->isPrivate != 0;
+
+            TextureImageConfiguration& configuration = texture->configuration;
+            configuration.format = static_cast<vk::Format>(record->format);
+            configuration.extent = vk::Extent3D{record->width, record->height, record->depth};
+            configuration.usage = static_cast<vk::ImageUsageFlags>(record->usage);
+            configuration.sampleCount = static_cast<vk::SampleCountFlagBits>(record->sampleCount);
+            configuration.properties = static_cast<vk::MemoryPropertyFlags>(record->properties);
+            configuration.type = static_cast<vk::ImageType>(record->imageType);
+            configuration.tiling = static_cast<vk::ImageTiling>(record->tiling);
+            configuration.shareMode = static_cast<vk::SharingMode>(record->shareMode);
+            configuration.mipLevels = record->mipLevels;
+            configuration.arrayLayers = record->arrayLayers;
+            configuration.subresourceRange = vk::ImageSubresourceRange{
+                static_cast<vk::ImageAspectFlags>(record->aspectMask),
+                record->baseMipLevel, record->levelCount, record->baseArrayLayer, record->layerCount};
+            configuration.imageViewType = static_cast<vk::ImageViewType>(record->imageViewType);
+            return texture;
         }
 
-        [[nodiscard]] std::string serializeMetadata() const {
+        // JSON form of the metadata, only used to export and import the metadata store for editing
+        // and diffing.
+        [[nodiscard]] nlohmann::json serializeMetadata() const {
             nlohmann::json json;
             json["type"] = type;
             json["name"] = name;
@@ -188,34 +320,107 @@ export namespace ufox {
                 }},
                 {"imageViewType", static_cast<int>(configuration.imageViewType)}
             };
-            return json.dump(2); // Pretty print with 2-space indentation
+            return json;
         }
 
-        void saveMetadataToFile() const {
-            try {
-                std::filesystem::path texturePath(filePath);
-                std::filesystem::path metadataDir = texturePath.parent_path(); // Get directory of texture file
-                std::filesystem::create_directories(metadataDir); // Ensure directory exists
-                std::filesystem::path filePath = metadataDir / (name + ".png.meta"); // Use .png.meta extension
-                std::ofstream file(filePath, std::ios::out | std::ios::binary);
-                if (!file.is_open()) {
-                    debug::log(debug::LogLevel::eError, "Failed to open metadata file for writing: {}", filePath.string());
-                    return;
-                }
-                file << metadata;
-                file.close();
-                debug::log(debug::LogLevel::eInfo, "Saved metadata for TextureImage {} to {}", name, filePath.string());
-            } catch (const std::filesystem::filesystem_error& e) {
-                debug::log(debug::LogLevel::eError, "Failed to save metadata for TextureImage {}: {}", name, e.what());
-            } catch (const std::exception& e) {
-                debug::log(debug::LogLevel::eError, "Unexpected error saving metadata for TextureImage {}: {}", name, e.what());
-            }
+        // Rebuilds a texture from serializeMetadata() output.
+        [[nodiscard]] static std::unique_ptr<TextureImage> FromMetadata(const nlohmann::json& json) {
+            const nlohmann::json& config = json.at("configuration");
+            const nlohmann::json& extent = config.at("extent");
+            const nlohmann::json& range = config.at("subresourceRange");
+
+            auto texture = std::make_unique<TextureImage>();
+            texture->type = json.at("type").get<ResourceType>();
+            texture->name = json.at("name").get<std::string>();
+            texture->filePath = json.at("filePath").get<std::string>();
+            texture->generateID();
+            texture->isPrivate = json.at("isPrivate").get<bool>();
+
+            TextureImageConfiguration& configuration = texture->configuration;
+            configuration.format = static_cast<vk::Format>(config.at("format").get<int>());
+            configuration.extent = vk::Extent3D{extent.at("width").get<uint32_t>(), extent.at("height").get<uint32_t>(), extent.at("depth").get<uint32_t>()};
+            configuration.usage = static_cast<vk::ImageUsageFlags>(config.at("usage").get<uint32_t>());
+            configuration.sampleCount = static_cast<vk::SampleCountFlagBits>(config.at("sampleCount").get<int>());
+            configuration.properties = static_cast<vk::MemoryPropertyFlags>(config.at("properties").get<uint32_t>());
+            configuration.type = static_cast<vk::ImageType>(config.at("type").get<int>());
+            configuration.tiling = static_cast<vk::ImageTiling>(config.at("tiling").get<int>());
+            configuration.shareMode = static_cast<vk::SharingMode>(config.at("shareMode").get<int>());
+            configuration.mipLevels = config.at("mipLevels").get<uint32_t>();
+            configuration.arrayLayers = config.at("arrayLayers").get<uint32_t>();
+            configuration.subresourceRange = vk::ImageSubresourceRange{
+                static_cast<vk::ImageAspectFlags>(range.at("aspectMask").get<uint32_t>()),
+                range.at("baseMipLevel").get<uint32_t>(), range.at("levelCount").get<uint32_t>(),
+                range.at("baseArrayLayer").get<uint32_t>(), range.at("layerCount").get<uint32_t>()};
+            configuration.imageViewType = static_cast<vk::ImageViewType>(config.at("imageViewType").get<int>());
+
+            return texture;
         }
     };
 
 
 
 
+    struct ImportStats {
+        size_t      scanned{0};
+        size_t      skipped{0};     // unchanged since the last launch
+        size_t      imported{0};
+        size_t      failed{0};
+        double      milliseconds{0.0};
+    };
+
+    constexpr std::string_view METADATA_STORE_FILE = ".ufox_metadata.bin";
+    constexpr size_t IMPORT_BATCH_SIZE = 32;            // files fingerprinted and imported per job
+    constexpr size_t ASSET_HASH_CHUNK_SIZE = 64 * 1024;
+    constexpr vk::DeviceSize TEXTURE_STAGING_SIZE = 16ull << 20;   // larger cache entries get a dedicated staging buffer
+    constexpr vk::DeviceSize TEXTURE_STAGING_ALIGNMENT = 16;        // covers the texel block of every cached format
+
+    // FNV-1a over the whole file, streamed in fixed chunks.
+    inline std::optional<uint64_t> HashFileContents(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        if (!file.is_open()) return std::nullopt;
+
+        uint64_t hash = 0xcbf29ce484222325ull;
+        std::array<char, ASSET_HASH_CHUNK_SIZE> chunk{};
+        while (file) {
+            file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            const auto count = static_cast<size_t>(file.gcount());
+            for (size_t i = 0; i < count; ++i) {
+                hash ^= static_cast<uint8_t>(chunk[i]);
+                hash *= 0x100000001b3ull;
+            }
+        }
+        return file.bad() ? std::nullopt : std::optional{hash};
+    }
+
+    inline std::optional<AssetFingerprint> StatAsset(const std::filesystem::path& path) {
+        std::error_code error{};
+        const uintmax_t size = std::filesystem::file_size(path, error);
+        if (error) return std::nullopt;
+        const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+        if (error) return std::nullopt;
+
+        return AssetFingerprint{static_cast<uint64_t>(size), static_cast<int64_t>(writeTime.time_since_epoch().count()), 0};
+    }
+
+    // Lowercase, dot prefixed, computed once per scan instead of once per file.
+    inline std::vector<std::string> NormalizeExtensions(const std::vector<std::string>& extensions) {
+        std::vector<std::string> normalized{};
+        normalized.reserve(extensions.size());
+        for (const auto& extension : extensions) {
+            if (extension.empty()) continue;
+            std::string target = extension[0] == '.' ? extension : std::format(".{}", extension);
+            std::ranges::transform(target, target.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            normalized.push_back(std::move(target));
+        }
+        return normalized;
+    }
+
+    inline bool MatchesExtension(const std::filesystem::path& path, const std::vector<std::string>& normalized) {
+        std::string ext = path.extension().string();
+        std::ranges::transform(ext, ext.begin(), [](const unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return std::ranges::find(normalized, ext) != normalized.end();
+    }
+
     // Enum class for image file types (flags)
     enum class ImageFileType {
         None = 0,
@@ -257,6 +462,7 @@ export namespace ufox {
             if (!rootPath.empty() && rootPath.back() != '/' && rootPath.back() != '\\') {
                 rootPath += '/';
             }
+            metadataStoreOpen = false;
         }
 
 #pragma region Texture Resource
@@ -264,30 +470,14 @@ export namespace ufox {
         // Scan for image files within rootPath and its subdirectories based on extensions
         std::vector<std::string> ScanForImageFiles(const std::vector<std::string>& extensions) const {
             std::vector<std::string> imageFiles;
-            if (rootPath.empty() || extensions.empty()) {
+            const std::vector<std::string> normalized = NormalizeExtensions(extensions);
+            if (rootPath.empty() || normalized.empty()) {
                 return imageFiles; // Return empty list if rootPath or extensions not set
             }
             try {
                 for (const auto& entry : std::filesystem::recursive_directory_iterator(rootPath)) {
-                    if (entry.is_regular_file()) {
-                        std::string ext = entry.path().extension().string();
-                        // Convert extension to lowercase for case-insensitive comparison
-                        std::ranges::transform(ext, ext.begin(),
-                                               [](const unsigned char c) { return std::tolower(c); });
-                        // Check if extension matches any in the provided list
-                        for (const auto& targetExt : extensions) {
-                            std::string target = targetExt;
-                            // Ensure target extension starts with '.' and is lowercase
-                            if (!target.empty() && target[0] != '.') {
-                                target = std::format(".{}", target);
-                            }
-                            std::ranges::transform(target, target.begin(),
-                                                   [](const unsigned char c) { return std::tolower(c); });
-                            if (ext == target) {
-                                imageFiles.push_back(entry.path().string());
-                                break; // Found a match, no need to check other extensions
-                            }
-                        }
+                    if (entry.is_regular_file() && MatchesExtension(entry.path(), normalized)) {
+                        imageFiles.push_back(entry.path().string());
                     }
                 }
             } catch (const std::filesystem::filesystem_error& e) {
@@ -296,56 +486,336 @@ export namespace ufox {
             return imageFiles;
         }
 
-        // void CreateTextureImage() {
-        //     // Load KTX2 texture instead of using stb_image
-        //     ktxTexture* kTexture;
-        //     KTX_error_code result = ktxTexture_CreateFromNamedFile(
-        //         "res/textures/rgb.png",
-        //         KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT,
-        //         &kTexture);
-        //
-        //     if (result != KTX_SUCCESS) {
-        //         throw std::runtime_error("failed to load ktx texture image!");
-        //     }
-        //
-        //     // Get texture dimensions and data
-        //     uint32_t texWidth = kTexture->baseWidth;
-        //     uint32_t texHeight = kTexture->baseHeight;
-        //     ktx_size_t imageSize = ktxTexture_GetImageSize(kTexture, 0);
-        //     ktx_uint8_t* ktxTextureData = ktxTexture_GetData(kTexture);
-        //
-        //     // Create staging buffer
-        //     gpu::vulkan::Buffer stagingBuffer(gpu, imageSize, vk::BufferUsageFlagBits::eTransferSrc);
-        //
-        //     // Copy texture data to staging buffer
-        //     auto pData = static_cast<uint8_t *>( stagingBuffer.memory->mapMemory( 0, imageSize ) );
-        //     memcpy( pData, ktxTextureData, imageSize );
-        //     stagingBuffer.memory->unmapMemory();
-        //
-        //     // Determine the Vulkan format from KTX format
-        //     vk::Format textureFormat = vk::Format::eR8G8B8A8Srgb; // Default format, should be determined from KTX metadata
-        //
-        //     // Create the texture image
-        //     textureImage.emplace(gpu, vk::Extent3D{texWidth,texHeight,1}, textureFormat, vk::ImageTiling::eOptimal,
-        //         vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled, vk::MemoryPropertyFlagBits::eDeviceLocal);
-        //
-        //     // Copy data from staging buffer to texture image
-        //     gpu::vulkan::SetImageLayout(commandBuffer, *textureImage, textureFormat, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-        //     gpu::vulkan::CopyBufferToImage(gpu,stagingBuffer, *textureImage, {texWidth, texHeight, 1});
-        //     gpu::vulkan::SetImageLayout(commandBuffer, *textureImage, textureFormat, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
-        //
-        //
-        //
-        //     // Cleanup KTX resources
-        //     ktxTexture_Destroy(kTexture);
-        // }
+        // Same result as ScanForImageFiles, every directory is listed by its own job. Sorted so
+        // the order does not depend on the schedule.
+        std::vector<std::string> ScanForImageFiles(const std::vector<std::string>& extensions, jobs::ThreadPool& pool) const {
+            std::vector<std::string> imageFiles;
+            const std::vector<std::string> normalized = NormalizeExtensions(extensions);
+            if (rootPath.empty() || normalized.empty()) return imageFiles;
+
+            std::mutex filesMutex{};
+            jobs::JobCounter counter{};
+
+            std::function<void(std::filesystem::path)> scanDirectory = [&](const std::filesystem::path& directory) {
+                std::vector<std::string> found{};
+                std::error_code error{};
+                for (std::filesystem::directory_iterator it(directory, error), end; !error && it != end; it.increment(error)) {
+                    const std::filesystem::directory_entry& entry = *it;
+                    std::error_code typeError{};
+                    if (entry.is_directory(typeError)) {
+                        pool.submit([&scanDirectory, path = entry.path()] { scanDirectory(path); }, counter);
+                    } else if (entry.is_regular_file(typeError) && MatchesExtension(entry.path(), normalized)) {
+                        found.push_back(entry.path().string());
+                    }
+                }
+                if (error) {
+                    debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to scan directory {}: {}", directory.string(), error.message());
+                }
+                if (found.empty()) return;
+
+                std::lock_guard lock(filesMutex);
+                imageFiles.insert(imageFiles.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+            };
+
+            pool.submit([&scanDirectory, root = std::filesystem::path(rootPath)] { scanDirectory(root); }, counter);
+            pool.wait(counter);
+
+            std::ranges::sort(imageFiles);
+            return imageFiles;
+        }
+
+        // Scans, fingerprints and imports the textures under rootPath on the pool. Assets whose
+        // fingerprint matches the metadata store are restored from their record, the others are
+        // imported. The jobs only read the store, the records are written back on this thread.
+        ImportStats ImportTextures(const std::vector<std::string>& extensions, jobs::ThreadPool& pool) {
+            const auto start = std::chrono::steady_clock::now();
+            ImportStats stats{};
+            if (rootPath.empty() || !OpenMetadataStore()) return stats;
+
+            const std::vector<std::string> files = ScanForImageFiles(extensions, pool);
+            stats.scanned = files.size();
+
+            struct ImportResult {
+                std::unique_ptr<TextureImage>       texture{};
+                std::optional<AssetFingerprint>     fingerprint{};  // set when the stored record changed
+                bool                                imported{false};
+            };
+            std::vector<ImportResult> results(files.size());
+
+            const auto importFile = [this, &files, &results](const size_t index) {
+                const std::string& file = files[index];
+                ImportResult& result = results[index];
+
+                std::optional<AssetFingerprint> fingerprint = StatAsset(file);
+                if (!fingerprint) return;
+
+                const std::optional<MetadataView> stored = metadataStore.find(utilities::HashString(file));
+                const std::optional<TextureMetadataRecord> previous = stored ? ReadTextureMetadataRecord(stored->payload) : std::nullopt;
+                if (previous && previous->fingerprint.size == fingerprint->size && previous->fingerprint.writeTime == fingerprint->writeTime) {
+                    result.texture = TextureImage::FromMetadata(stored->payload);
+                    return;
+                }
+
+                const std::optional<uint64_t> contentHash = HashFileContents(file);
+                if (!contentHash) return;
+                fingerprint->contentHash = *contentHash;
+
+                // touched but identical content, only the fingerprint is refreshed
+                if (previous && previous->fingerprint.contentHash == *contentHash) {
+                    result.texture = TextureImage::FromMetadata(stored->payload);
+                    result.fingerprint = fingerprint;
+                    return;
+                }
+
+                result.texture = std::make_unique<TextureImage>(file);
+                result.fingerprint = fingerprint;
+                result.imported = true;
+            };
+
+            jobs::JobCounter counter{};
+            for (size_t begin = 0; begin < files.size(); begin += IMPORT_BATCH_SIZE) {
+                const size_t end = std::min(files.size(), begin + IMPORT_BATCH_SIZE);
+                pool.submit([&importFile, &files, begin, end] {
+                    for (size_t i = begin; i < end; ++i) {
+                        try {
+                            importFile(i);
+                        } catch (const std::exception& e) {
+                            debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to import {}: {}", files[i], e.what());
+                        }
+                    }
+                }, counter);
+            }
+            pool.wait(counter);
+
+            std::vector<uint64_t> seen{};
+            seen.reserve(results.size());
+            for (ImportResult& result : results) {
+                if (!result.texture) {
+                    ++stats.failed;
+                    continue;
+                }
+
+                if (result.imported) ++stats.imported;
+                else ++stats.skipped;
+                if (result.fingerprint) {
+                    metadataStore.put(result.texture->id, static_cast<uint32_t>(ResourceType::eTexture), result.texture->encodeMetadata(*result.fingerprint));
+                }
+
+                seen.push_back(result.texture->id);
+                const utilities::NameHandle handle = result.texture->handle;
+                textures.insert_or_assign(handle.value, std::move(result.texture));
+            }
+
+            // records of textures that were not seen by the scan
+            std::ranges::sort(seen);
+            std::vector<uint64_t> stale{};
+            metadataStore.forEach([&seen, &stale](const MetadataView& view) {
+                if (view.type == static_cast<uint32_t>(ResourceType::eTexture) && !std::ranges::binary_search(seen, view.id)) stale.push_back(view.id);
+            });
+            for (const uint64_t id : stale) metadataStore.erase(id);
+
+            SaveMetadataStore();
+
+            stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            debug::log<debug::LogLevel::eInfo, debug::LogCategory::eResource>("Imported textures: {} scanned, {} skipped, {} imported, {} failed in {:.2f} ms",
+                stats.scanned, stats.skipped, stats.imported, stats.failed, stats.milliseconds);
+            return stats;
+        }
+
+        // Writes every record of the metadata store as pretty-printed JSON, sorted by file path so
+        // two exports diff cleanly.
+        bool ExportMetadataJson(const std::filesystem::path& path) {
+            if (!OpenMetadataStore()) return false;
+
+            std::vector<nlohmann::json> resources{};
+            resources.reserve(metadataStore.size());
+            metadataStore.forEach([&resources](const MetadataView& view) {
+                if (view.type != static_cast<uint32_t>(ResourceType::eTexture)) return;
+                const std::unique_ptr<TextureImage> texture = TextureImage::FromMetadata(view.payload);
+                if (!texture) return;
+
+                const AssetFingerprint& fingerprint = ReadTextureMetadataRecord(view.payload)->fingerprint;
+                nlohmann::json json = texture->serializeMetadata();
+                json["fingerprint"] = {
+                    {"size", fingerprint.size},
+                    {"writeTime", fingerprint.writeTime},
+                    {"contentHash", fingerprint.contentHash}
+                };
+                resources.push_back(std::move(json));
+            });
+            std::ranges::sort(resources, {}, [](const nlohmann::json& json) { return json.at("filePath").get<std::string>(); });
+
+            std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to open metadata export {}", path.string());
+                return false;
+            }
+            file << nlohmann::json{{"version", METADATA_STORE_VERSION}, {"resources", std::move(resources)}}.dump(2);
+            return static_cast<bool>(file);
+        }
+
+        // Reads an ExportMetadataJson() file back into the metadata store. Records keep the
+        // exported fingerprint, so edits survive the next import as long as the asset is unchanged.
+        bool ImportMetadataJson(const std::filesystem::path& path) {
+            if (!OpenMetadataStore()) return false;
+
+            std::ifstream file(path, std::ios::in | std::ios::binary);
+            if (!file.is_open()) {
+                debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to open metadata import {}", path.string());
+                return false;
+            }
+
+            try {
+                const nlohmann::json json = nlohmann::json::parse(file);
+                for (const nlohmann::json& resource : json.at("resources")) {
+                    if (resource.at("type").get<ResourceType>() != ResourceType::eTexture) continue;
+
+                    const std::unique_ptr<TextureImage> texture = TextureImage::FromMetadata(resource);
+                    const nlohmann::json& fingerprint = resource.at("fingerprint");
+                    metadataStore.put(texture->id, static_cast<uint32_t>(ResourceType::eTexture), texture->encodeMetadata(AssetFingerprint{
+                        fingerprint.at("size").get<uint64_t>(), fingerprint.at("writeTime").get<int64_t>(), fingerprint.at("contentHash").get<uint64_t>()}));
+                }
+            } catch (const std::exception& e) {
+                debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to import metadata from {}: {}", path.string(), e.what());
+                return false;
+            }
+            return SaveMetadataStore();
+        }
+
+        // Decodes, mips and caches every known texture as KTX2 under rootPath on the pool. The
+        // srgb of settings is ignored, every texture is filtered as its configured format says.
+        imaging::TextureProcessStats PreprocessTextures(jobs::ThreadPool& pool, const imaging::TextureProcessSettings& settings = {}) {
+            processSettings = settings;
+            if (rootPath.empty()) return {};
+
+            std::vector<imaging::TextureSource> sources{};
+            sources.reserve(textures.size());
+            for (const auto& [handle, texture] : textures) sources.push_back({texture->filePath, GetProcessSettings(*texture)});
+            std::ranges::sort(sources, {}, &imaging::TextureSource::path);
+
+            return imaging::ProcessTextures(sources, std::filesystem::path(rootPath) / imaging::TEXTURE_CACHE_DIRECTORY, pool);
+        }
+
+        // Uploads every texture that has no image yet, returns how many were uploaded. Submits to
+        // the graphics queue, so it runs on the thread that presents.
+        size_t UploadTextures() {
+            size_t uploaded = 0;
+            for (const auto& [handle, texture] : textures) {
+                if (!texture->data && UploadTexture(*texture)) ++uploaded;
+            }
+            return uploaded;
+        }
+
+        // Creates the image of a preprocessed texture with its whole mip chain. The cached KTX2
+        // data is copied into staging as is, nothing is decoded. The image takes the format, extent
+        // and mip count of the cache entry, the persisted configuration stays as it is.
+        bool UploadTexture(TextureImage& texture) {
+            const std::optional<std::filesystem::path> cachePath = imaging::TextureCachePath(
+                std::filesystem::path(rootPath) / imaging::TEXTURE_CACHE_DIRECTORY, texture.filePath, GetProcessSettings(texture));
+            if (!cachePath) return false;
+
+            ktxTexture2* cached = nullptr;
+            if (ktxTexture2_CreateFromNamedFile(cachePath->string().c_str(), KTX_TEXTURE_CREATE_LOAD_IMAGE_DATA_BIT, &cached) != KTX_SUCCESS) {
+                debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("No cached texture for {}, run PreprocessTextures first", texture.filePath);
+                return false;
+            }
+
+            const ktx_size_t dataSize = ktxTexture_GetDataSize(ktxTexture(cached));
+            std::optional<gpu::vulkan::Buffer> dedicatedStaging{};
+            const gpu::vulkan::FrameSlice staging = AllocateStaging(dataSize, dedicatedStaging);
+            std::memcpy(staging.mapped, ktxTexture_GetData(ktxTexture(cached)), dataSize);
+
+            TextureImageConfiguration upload = texture.configuration;
+            upload.format = static_cast<vk::Format>(cached->vkFormat);
+            upload.extent = vk::Extent3D{cached->baseWidth, cached->baseHeight, 1};
+            upload.mipLevels = cached->numLevels;
+            upload.arrayLayers = 1;
+            upload.subresourceRange = vk::ImageSubresourceRange{vk::ImageAspectFlagBits::eColor, 0, cached->numLevels, 0, 1};
+
+            std::vector<vk::BufferImageCopy> regions(cached->numLevels);
+            for (uint32_t level = 0; level < cached->numLevels; ++level) {
+                ktx_size_t offset = 0;
+                ktxTexture_GetImageOffset(ktxTexture(cached), level, 0, 0, &offset);
+                regions[level]
+                    .setBufferOffset(staging.offset + offset)
+                    .setImageSubresource({vk::ImageAspectFlagBits::eColor, level, 0, 1})
+                    .setImageExtent({std::max(1u, cached->baseWidth >> level), std::max(1u, cached->baseHeight >> level), 1});
+            }
+            ktxTexture_Destroy(ktxTexture(cached));
+
+            texture.clear();
+            texture.data.emplace(*gpu.device, TextureImage::GetImageCreateInfo(upload));
+            texture.allocation = gpu.allocator->allocate(texture.data->getMemoryRequirements(), upload.properties, gpu::memory::ResourceKind::eImage);
+            if (!texture.allocation) {
+                debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Out of device memory for {}", texture.filePath);
+                texture.clear();
+                return false;
+            }
+            texture.data->bindMemory(texture.allocation.memory(), texture.allocation.offset());
+
+            const vk::raii::CommandBuffer cmd = gpu::vulkan::BeginSingleTimeCommands(*gpu.device, *commandPool);
+            gpu::vulkan::TransitionImageLayout(cmd, *texture.data, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, upload.subresourceRange);
+            cmd.copyBufferToImage(staging.buffer, *texture.data, vk::ImageLayout::eTransferDstOptimal, regions);
+            gpu::vulkan::TransitionImageLayout(cmd, *texture.data, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, upload.subresourceRange);
+            gpu::vulkan::EndSingleTimeCommands(cmd, *gpu.graphicsQueue);
+
+            texture.view.emplace(*gpu.device, texture.GetImageViewCreateInfo(upload));
+            return true;
+        }
+
+        [[nodiscard]] TextureImage* FindTexture(const utilities::NameHandle handle) const {
+            const auto it = textures.find(handle.value);
+            return it == textures.end() ? nullptr : it->second.get();
+        }
+
+        [[nodiscard]] TextureImage* FindTexture(const std::string_view filePath) const {
+            return FindTexture(utilities::GlobalInternTable().find(filePath));
+        }
+
 #pragma endregion
 
     private:
         const gpu::vulkan::GPUResources& gpu;
         std::optional<vk::raii::CommandPool> commandPool{};
         std::optional<vk::raii::CommandBuffer> commandBuffer{};
+        std::optional<gpu::vulkan::FrameArena> stagingArena{};     // one segment, every upload waits for the queue
         std::string rootPath;  // Root path for resources
-        std::unordered_map<std::string, std::unique_ptr<TextureImage>> textures;
+        std::unordered_map<uint32_t, std::unique_ptr<TextureImage>> textures;  // by NameHandle of the file path
+        MetadataStore metadataStore{};
+        bool metadataStoreOpen{false};
+        imaging::TextureProcessSettings processSettings{};
+
+        // Staging for one upload. The copy of the previous upload has completed, EndSingleTimeCommands
+        // waits for the queue, so the segment is rewound every time. Data that does not fit gets
+        // a buffer of its own in dedicated, kept alive by the caller until the copy is done.
+        gpu::vulkan::FrameSlice AllocateStaging(const vk::DeviceSize size, std::optional<gpu::vulkan::Buffer>& dedicated) {
+            if (!stagingArena) stagingArena.emplace(gpu::vulkan::MakeFrameArena(gpu, TEXTURE_STAGING_SIZE, 1, vk::BufferUsageFlagBits::eTransferSrc));
+
+            stagingArena->ring.beginFrame(0);
+            if (const std::optional<gpu::vulkan::FrameSlice> slice = gpu::vulkan::AllocateFrameData(*stagingArena, size, TEXTURE_STAGING_ALIGNMENT)) return *slice;
+
+            dedicated.emplace(gpu::vulkan::MakeBuffer(gpu, size, vk::BufferUsageFlagBits::eTransferSrc,
+                vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent));
+            return gpu::vulkan::FrameSlice{*dedicated->data, 0, dedicated->allocation.mapped()};
+        }
+
+        [[nodiscard]] imaging::TextureProcessSettings GetProcessSettings(const TextureImage& texture) const {
+            imaging::TextureProcessSettings settings = processSettings;
+            settings.srgb = IsSrgbFormat(texture.configuration.format);
+            return settings;
+        }
+
+        bool OpenMetadataStore() {
+            if (!metadataStoreOpen && !rootPath.empty()) {
+                metadataStoreOpen = metadataStore.open(std::filesystem::path(rootPath) / METADATA_STORE_FILE);
+            }
+            return metadataStoreOpen;
+        }
+
+        // Appends the staged records, rewrites the file once superseded records outweigh live ones.
+        bool SaveMetadataStore() {
+            if (!metadataStore.flush()) return false;
+            return metadataStore.deadSize() <= metadataStore.liveBytes() || metadataStore.compact();
+        }
     };
 }  // namespace ufox::resources
\ No newline at end of file
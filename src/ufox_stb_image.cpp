@@ -0,0 +1,6 @@
+// The one translation unit that compiles stb_image, only the decoders the texture
+// preprocessing stage reads.
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#include <stb_image.h>
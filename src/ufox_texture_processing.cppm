@@ -0,0 +1,456 @@
+module;
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <numbers>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+#include <ktx.h>
+#include <stb_image.h>
+#include <vulkan/vulkan_core.h>
+
+export module ufox_texture_processing;
+
+import ufox_lib;
+
+export namespace ufox::imaging {
+    enum class MipFilter : uint8_t {
+        eBox,
+        eKaiser
+    };
+
+    struct TextureProcessSettings {
+        MipFilter   filter{MipFilter::eKaiser};
+        bool        srgb{true};             // color data, filtered in linear space and stored as sRGB
+        uint32_t    maxMipLevels{0};        // 0 keeps the full chain down to 1x1
+    };
+
+    // A file to process with the settings of its texture, srgb follows the format it is sampled as.
+    struct TextureSource {
+        std::string                 path{};
+        TextureProcessSettings      settings{};
+    };
+
+    struct TextureProcessStats {
+        size_t      processed{0};
+        size_t      cached{0};              // cache entry already up to date
+        size_t      failed{0};
+        double      milliseconds{0.0};
+    };
+
+    constexpr std::string_view TEXTURE_CACHE_DIRECTORY = ".ufox_texture_cache";
+    constexpr std::string_view TEXTURE_CACHE_EXTENSION = ".ktx2";
+    constexpr float KAISER_FILTER_RADIUS = 3.0f;        // in target pixels
+    constexpr float KAISER_FILTER_ALPHA = 4.0f;
+    constexpr uint32_t MIP_FILTER_ROWS_PER_JOB = 64;    // levels with fewer rows are filtered by the calling job
+
+    // One RGBA8 level of a mip chain.
+    struct MipLevel {
+        uint32_t                width{0};
+        uint32_t                height{0};
+        std::vector<uint8_t>    pixels{};
+    };
+
+    struct MipChain {
+        std::vector<MipLevel>   levels{};
+        bool                    srgb{true};
+    };
+
+    constexpr uint32_t MipLevelCount(const uint32_t width, const uint32_t height) noexcept {
+        return static_cast<uint32_t>(std::bit_width(std::max(width, height)));
+    }
+
+    // Source pixels and weights of every target pixel of a 1D resample, tapCount per target
+    // pixel, padded with zero weights. Indices are clamped to the edge.
+    struct FilterTaps {
+        uint32_t                tapCount{0};
+        std::vector<uint32_t>   indices{};
+        std::vector<float>      weights{};
+    };
+
+    inline double BesselI0(const double x) noexcept {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 32 && term > sum * 1e-12; ++k) {
+            const double half = x / (2.0 * k);
+            term *= half * half;
+            sum += term;
+        }
+        return sum;
+    }
+
+    // t in target pixels from the target pixel center.
+    inline float FilterWeight(const MipFilter filter, const float t) noexcept {
+        const float distance = std::abs(t);
+        if (filter == MipFilter::eBox) return distance < 0.5f ? 1.0f : distance == 0.5f ? 0.5f : 0.0f;
+
+        if (distance >= KAISER_FILTER_RADIUS) return 0.0f;
+        const double x = std::numbers::pi * distance;
+        const double sinc = distance < 1e-6f ? 1.0 : std::sin(x) / x;
+        const double window = distance / KAISER_FILTER_RADIUS;
+        return static_cast<float>(sinc * BesselI0(KAISER_FILTER_ALPHA * std::sqrt(1.0 - window * window)) / BesselI0(KAISER_FILTER_ALPHA));
+    }
+
+    inline FilterTaps MakeFilterTaps(const uint32_t sourceSize, const uint32_t targetSize, const MipFilter filter) {
+        const float scale = static_cast<float>(sourceSize) / static_cast<float>(targetSize);
+        const float support = (filter == MipFilter::eBox ? 0.5f : KAISER_FILTER_RADIUS) * scale;
+
+        FilterTaps taps{};
+        taps.tapCount = static_cast<uint32_t>(std::ceil(support * 2.0f)) + 1;
+        taps.indices.assign(static_cast<size_t>(targetSize) * taps.tapCount, 0);
+        taps.weights.assign(static_cast<size_t>(targetSize) * taps.tapCount, 0.0f);
+
+        for (uint32_t target = 0; target < targetSize; ++target) {
+            const float center = (static_cast<float>(target) + 0.5f) * scale;
+            const auto first = static_cast<int64_t>(std::ceil(center - support - 0.5f));
+            const size_t base = static_cast<size_t>(target) * taps.tapCount;
+
+            float total = 0.0f;
+            for (uint32_t k = 0; k < taps.tapCount; ++k) {
+                const int64_t source = first + k;
+                const float weight = FilterWeight(filter, (static_cast<float>(source) + 0.5f - center) / scale);
+                taps.indices[base + k] = static_cast<uint32_t>(std::clamp<int64_t>(source, 0, sourceSize - 1));
+                taps.weights[base + k] = weight;
+                total += weight;
+            }
+
+            if (total == 0.0f) {
+                taps.indices[base] = std::min(static_cast<uint32_t>(center), sourceSize - 1);
+                taps.weights[base] = total = 1.0f;
+            }
+            for (uint32_t k = 0; k < taps.tapCount; ++k) taps.weights[base + k] /= total;
+        }
+        return taps;
+    }
+
+    inline float SrgbToLinear(const float value) noexcept {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    inline float LinearToSrgb(const float value) noexcept {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
+    inline const std::array<float, 256>& SrgbDecodeTable() {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> values{};
+            for (size_t i = 0; i < values.size(); ++i) values[i] = SrgbToLinear(static_cast<float>(i) / 255.0f);
+            return values;
+        }();
+        return table;
+    }
+
+    inline const std::array<uint8_t, 4096>& SrgbEncodeTable() {
+        static const std::array<uint8_t, 4096> table = [] {
+            std::array<uint8_t, 4096> values{};
+            for (size_t i = 0; i < values.size(); ++i) {
+                values[i] = static_cast<uint8_t>(std::lround(LinearToSrgb(static_cast<float>(i) / 4095.0f) * 255.0f));
+            }
+            return values;
+        }();
+        return table;
+    }
+
+    // RGBA8 to linear, alpha premultiplied so transparent texels do not bleed into the mips.
+    inline void DecodeLinearPixels(const uint8_t* pixels, const size_t count, const bool srgb, float* linear) {
+        const std::array<float, 256>& decode = SrgbDecodeTable();
+        for (size_t i = 0; i < count; ++i) {
+            const uint8_t* texel = pixels + i * 4;
+            const float alpha = static_cast<float>(texel[3]) / 255.0f;
+            for (size_t c = 0; c < 3; ++c) {
+                linear[i * 4 + c] = (srgb ? decode[texel[c]] : static_cast<float>(texel[c]) / 255.0f) * alpha;
+            }
+            linear[i * 4 + 3] = alpha;
+        }
+    }
+
+    inline void EncodeLinearPixels(const float* linear, const size_t count, const bool srgb, uint8_t* pixels) {
+        const std::array<uint8_t, 4096>& encode = SrgbEncodeTable();
+        for (size_t i = 0; i < count; ++i) {
+            const float* texel = linear + i * 4;
+            const float alpha = std::clamp(texel[3], 0.0f, 1.0f);
+            for (size_t c = 0; c < 3; ++c) {
+                const float value = alpha > 0.0f ? std::clamp(texel[c] / alpha, 0.0f, 1.0f) : 0.0f;
+                pixels[i * 4 + c] = srgb ? encode[static_cast<size_t>(value * 4095.0f + 0.5f)] : static_cast<uint8_t>(value * 255.0f + 0.5f);
+            }
+            pixels[i * 4 + 3] = static_cast<uint8_t>(alpha * 255.0f + 0.5f);
+        }
+    }
+
+    // Both passes keep one RGBA texel per 4 floats. Rows resample along x, columns resample along
+    // y over whole rows at once.
+#if defined(__SSE2__) || defined(_M_X64)
+    inline constexpr auto MIP_FILTER_KERNEL = "sse2";
+
+    inline void FilterRows(const float* source, const uint32_t sourceWidth, const uint32_t rowBegin, const uint32_t rowEnd,
+        const FilterTaps& taps, const uint32_t targetWidth, float* target) noexcept {
+        for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+            const float* sourceRow = source + static_cast<size_t>(y) * sourceWidth * 4;
+            float* targetRow = target + static_cast<size_t>(y) * targetWidth * 4;
+            for (uint32_t x = 0; x < targetWidth; ++x) {
+                const size_t base = static_cast<size_t>(x) * taps.tapCount;
+                __m128 sum = _mm_setzero_ps();
+                for (uint32_t k = 0; k < taps.tapCount; ++k) {
+                    sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(taps.weights[base + k]), _mm_loadu_ps(sourceRow + static_cast<size_t>(taps.indices[base + k]) * 4)));
+                }
+                _mm_storeu_ps(targetRow + static_cast<size_t>(x) * 4, sum);
+            }
+        }
+    }
+
+    inline void FilterColumns(const float* source, const uint32_t width, const uint32_t rowBegin, const uint32_t rowEnd,
+        const FilterTaps& taps, float* target) noexcept {
+        const size_t rowFloats = static_cast<size_t>(width) * 4;
+        for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+            float* targetRow = target + y * rowFloats;
+            const size_t base = static_cast<size_t>(y) * taps.tapCount;
+            for (size_t i = 0; i < rowFloats; i += 4) _mm_storeu_ps(targetRow + i, _mm_setzero_ps());
+
+            for (uint32_t k = 0; k < taps.tapCount; ++k) {
+                const float weight = taps.weights[base + k];
+                if (weight == 0.0f) continue;
+                const __m128 factor = _mm_set1_ps(weight);
+                const float* sourceRow = source + taps.indices[base + k] * rowFloats;
+                for (size_t i = 0; i < rowFloats; i += 4) {
+                    _mm_storeu_ps(targetRow + i, _mm_add_ps(_mm_loadu_ps(targetRow + i), _mm_mul_ps(factor, _mm_loadu_ps(sourceRow + i))));
+                }
+            }
+        }
+    }
+#else
+    inline constexpr auto MIP_FILTER_KERNEL = "scalar";
+
+    inline void FilterRows(const float* source, const uint32_t sourceWidth, const uint32_t rowBegin, const uint32_t rowEnd,
+        const FilterTaps& taps, const uint32_t targetWidth, float* target) noexcept {
+        for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+            const float* sourceRow = source + static_cast<size_t>(y) * sourceWidth * 4;
+            float* targetRow = target + static_cast<size_t>(y) * targetWidth * 4;
+            for (uint32_t x = 0; x < targetWidth; ++x) {
+                const size_t base = static_cast<size_t>(x) * taps.tapCount;
+                float sum[4]{};
+                for (uint32_t k = 0; k < taps.tapCount; ++k) {
+                    const float* texel = sourceRow + static_cast<size_t>(taps.indices[base + k]) * 4;
+                    for (size_t c = 0; c < 4; ++c) sum[c] += taps.weights[base + k] * texel[c];
+                }
+                std::copy_n(sum, 4, targetRow + static_cast<size_t>(x) * 4);
+            }
+        }
+    }
+
+    inline void FilterColumns(const float* source, const uint32_t width, const uint32_t rowBegin, const uint32_t rowEnd,
+        const FilterTaps& taps, float* target) noexcept {
+        const size_t rowFloats = static_cast<size_t>(width) * 4;
+        for (uint32_t y = rowBegin; y < rowEnd; ++y) {
+            float* targetRow = target + y * rowFloats;
+            const size_t base = static_cast<size_t>(y) * taps.tapCount;
+            std::fill_n(targetRow, rowFloats, 0.0f);
+
+            for (uint32_t k = 0; k < taps.tapCount; ++k) {
+                const float weight = taps.weights[base + k];
+                if (weight == 0.0f) continue;
+                const float* sourceRow = source + taps.indices[base + k] * rowFloats;
+                for (size_t i = 0; i < rowFloats; ++i) targetRow[i] += weight * sourceRow[i];
+            }
+        }
+    }
+#endif
+
+    // Runs rowJob over [0, rows) in bands of MIP_FILTER_ROWS_PER_JOB. The waiting job helps, so
+    // this nests inside a pool job.
+    template<typename RowJob>
+    void ForEachRowBand(jobs::ThreadPool* pool, const uint32_t rows, const RowJob& rowJob) {
+        if (!pool || rows <= MIP_FILTER_ROWS_PER_JOB) {
+            rowJob(0u, rows);
+            return;
+        }
+
+        jobs::JobCounter counter{};
+        for (uint32_t begin = 0; begin < rows; begin += MIP_FILTER_ROWS_PER_JOB) {
+            const uint32_t end = std::min(rows, begin + MIP_FILTER_ROWS_PER_JOB);
+            pool->submit([&rowJob, begin, end] { rowJob(begin, end); }, counter);
+        }
+        pool->wait(counter);
+    }
+
+    // Every level is resampled from the previous one in linear space, level 0 keeps the source
+    // bytes as they are.
+    inline MipChain GenerateMipChain(MipLevel base, const TextureProcessSettings& settings, jobs::ThreadPool* pool = nullptr) {
+        MipChain chain{};
+        chain.srgb = settings.srgb;
+
+        uint32_t levelCount = MipLevelCount(base.width, base.height);
+        if (settings.maxMipLevels > 0) levelCount = std::min(levelCount, settings.maxMipLevels);
+        chain.levels.reserve(levelCount);
+
+        std::vector<float> current(static_cast<size_t>(base.width) * base.height * 4);
+        DecodeLinearPixels(base.pixels.data(), static_cast<size_t>(base.width) * base.height, settings.srgb, current.data());
+        chain.levels.push_back(std::move(base));
+
+        std::vector<float> rows{}, next{};
+        for (uint32_t level = 1; level < levelCount; ++level) {
+            const MipLevel& previous = chain.levels.back();
+            const uint32_t width = std::max(1u, previous.width / 2);
+            const uint32_t height = std::max(1u, previous.height / 2);
+
+            const FilterTaps rowTaps = MakeFilterTaps(previous.width, width, settings.filter);
+            const FilterTaps columnTaps = MakeFilterTaps(previous.height, height, settings.filter);
+            rows.resize(static_cast<size_t>(width) * previous.height * 4);
+            next.resize(static_cast<size_t>(width) * height * 4);
+
+            ForEachRowBand(pool, previous.height, [&](const uint32_t begin, const uint32_t end) {
+                FilterRows(current.data(), previous.width, begin, end, rowTaps, width, rows.data());
+            });
+            ForEachRowBand(pool, height, [&](const uint32_t begin, const uint32_t end) {
+                FilterColumns(rows.data(), width, begin, end, columnTaps, next.data());
+            });
+
+            MipLevel mip{width, height, std::vector<uint8_t>(static_cast<size_t>(width) * height * 4)};
+            EncodeLinearPixels(next.data(), static_cast<size_t>(width) * height, settings.srgb, mip.pixels.data());
+            chain.levels.push_back(std::move(mip));
+            std::swap(current, next);
+        }
+        return chain;
+    }
+
+    // PNG or JPEG, expanded to RGBA8.
+    inline std::optional<MipLevel> DecodeImageFile(const std::filesystem::path& path) {
+        int width = 0, height = 0, channels = 0;
+        stbi_uc* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+        if (!pixels) {
+            debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to decode {}: {}", path.string(), stbi_failure_reason());
+            return std::nullopt;
+        }
+
+        MipLevel level{static_cast<uint32_t>(width), static_cast<uint32_t>(height), {}};
+        level.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+        stbi_image_free(pixels);
+        return level;
+    }
+
+    // Written to a temporary file first, readers never see a partial cache entry.
+    inline bool WriteKtx2(const std::filesystem::path& path, const MipChain& chain) {
+        if (chain.levels.empty()) return false;
+
+        ktxTextureCreateInfo createInfo{};
+        createInfo.vkFormat = chain.srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+        createInfo.baseWidth = chain.levels.front().width;
+        createInfo.baseHeight = chain.levels.front().height;
+        createInfo.baseDepth = 1;
+        createInfo.numDimensions = 2;
+        createInfo.numLevels = static_cast<ktx_uint32_t>(chain.levels.size());
+        createInfo.numLayers = 1;
+        createInfo.numFaces = 1;
+        createInfo.isArray = KTX_FALSE;
+        createInfo.generateMipmaps = KTX_FALSE;
+
+        ktxTexture2* texture = nullptr;
+        if (ktxTexture2_Create(&createInfo, KTX_TEXTURE_CREATE_ALLOC_STORAGE, &texture) != KTX_SUCCESS) return false;
+
+        KTX_error_code result = KTX_SUCCESS;
+        for (ktx_uint32_t level = 0; level < createInfo.numLevels && result == KTX_SUCCESS; ++level) {
+            const std::vector<uint8_t>& pixels = chain.levels[level].pixels;
+            result = ktxTexture_SetImageFromMemory(ktxTexture(texture), level, 0, 0, pixels.data(), pixels.size());
+        }
+
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        if (result == KTX_SUCCESS) result = ktxTexture_WriteToNamedFile(ktxTexture(texture), temporary.string().c_str());
+        ktxTexture_Destroy(ktxTexture(texture));
+
+        if (result != KTX_SUCCESS) {
+            debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to write {}: {}", path.string(), ktxErrorString(result));
+            return false;
+        }
+
+        std::error_code error{};
+        std::filesystem::rename(temporary, path, error);
+        return !error;
+    }
+
+    // Cache entries are named after the source path, its size and write time and the settings,
+    // so an edited source or changed settings simply miss the cache.
+    inline std::optional<std::filesystem::path> TextureCachePath(const std::filesystem::path& cacheDirectory, const std::string& sourcePath, const TextureProcessSettings& settings) {
+        std::error_code error{};
+        const uintmax_t size = std::filesystem::file_size(sourcePath, error);
+        if (error) return std::nullopt;
+        const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(sourcePath, error);
+        if (error) return std::nullopt;
+
+        uint64_t key = utilities::HashString(sourcePath);
+        key = utilities::HashMix64(key ^ static_cast<uint64_t>(size), static_cast<uint64_t>(writeTime.time_since_epoch().count()));
+        key = utilities::HashMix64(key, static_cast<uint64_t>(settings.filter) | static_cast<uint64_t>(settings.srgb) << 8 | static_cast<uint64_t>(settings.maxMipLevels) << 16);
+        return cacheDirectory / std::format("{:016x}{}", key, TEXTURE_CACHE_EXTENSION);
+    }
+
+    // Decodes, mips and caches every file as KTX2, one job per file plus row bands for the large
+    // levels. Cache entries no file maps to anymore are removed, as are the temporary files of an
+    // interrupted WriteKtx2.
+    inline TextureProcessStats ProcessTextures(const std::vector<TextureSource>& sources, const std::filesystem::path& cacheDirectory, jobs::ThreadPool& pool) {
+        const auto start = std::chrono::steady_clock::now();
+        TextureProcessStats stats{};
+
+        std::error_code error{};
+        std::filesystem::create_directories(cacheDirectory, error);
+        if (error) {
+            debug::log<debug::LogLevel::eError, debug::LogCategory::eResource>("Failed to create texture cache {}: {}", cacheDirectory.string(), error.message());
+            stats.failed = sources.size();
+            return stats;
+        }
+
+        enum class Outcome : uint8_t { eFailed, eCached, eProcessed };
+        std::vector<Outcome> outcomes(sources.size(), Outcome::eFailed);
+        std::vector<std::filesystem::path> cachePaths(sources.size());
+
+        jobs::JobCounter counter{};
+        for (size_t i = 0; i < sources.size(); ++i) {
+            pool.submit([&, i] {
+                const TextureSource& source = sources[i];
+                const std::optional<std::filesystem::path> cachePath = TextureCachePath(cacheDirectory, source.path, source.settings);
+                if (!cachePath) return;
+                cachePaths[i] = *cachePath;
+
+                std::error_code existsError{};
+                if (std::filesystem::exists(*cachePath, existsError)) {
+                    outcomes[i] = Outcome::eCached;
+                    return;
+                }
+
+                std::optional<MipLevel> base = DecodeImageFile(source.path);
+                if (base && WriteKtx2(*cachePath, GenerateMipChain(std::move(*base), source.settings, &pool))) outcomes[i] = Outcome::eProcessed;
+            }, counter);
+        }
+        pool.wait(counter);
+
+        for (const Outcome outcome : outcomes) {
+            if (outcome == Outcome::eProcessed) ++stats.processed;
+            else if (outcome == Outcome::eCached) ++stats.cached;
+            else ++stats.failed;
+        }
+
+        std::ranges::sort(cachePaths);
+        for (std::filesystem::directory_iterator it(cacheDirectory, error), end; !error && it != end; it.increment(error)) {
+            const std::filesystem::path& entry = it->path();
+            const bool stale = entry.extension() == TEXTURE_CACHE_EXTENSION && !std::ranges::binary_search(cachePaths, entry);
+            const bool partial = entry.extension() == ".tmp" && entry.stem().extension() == TEXTURE_CACHE_EXTENSION;
+            if (stale || partial) {
+                std::error_code removeError{};
+                std::filesystem::remove(entry, removeError);
+            }
+        }
+
+        stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        debug::log<debug::LogLevel::eInfo, debug::LogCategory::eResource>("Processed textures ({} mips): {} processed, {} cached, {} failed in {:.2f} ms",
+            MIP_FILTER_KERNEL, stats.processed, stats.cached, stats.failed, stats.milliseconds);
+        return stats;
+    }
+}